@@ -8,6 +8,9 @@
 #include <map>
 #include "object.hpp"
 #include "joint.hpp"
+#include "ringBuffer.hpp"
+
+#define BONE_PALETTE_BINDING 4 // storage buffer binding of the bone matrices in the skinning shaders
 
 struct PositionKey
 {
@@ -63,12 +66,14 @@ class Animator
 		void updateAnimation(float delta);
 		void playAnimation(std::shared_ptr<Animation> & animation);
 		void stopAnimation();
+		void sampleAnimation(std::shared_ptr<Animation> & animation, float ticks);
 		void calculateJointTransform(std::shared_ptr<Joint> joint, glm::mat4 parentTransform);
-		std::array<glm::mat4, 50> & getFinalJointTransform();
+		void setJointCount(int count);
+		std::vector<glm::mat4> & getFinalJointTransform();
 		std::shared_ptr<Animation> & getCurrentAnimation();
 
 	private:
-		std::array<glm::mat4, 50> finalJointTransform;
+		std::vector<glm::mat4> finalJointTransform; // indexed by joint id, sized to the skeleton
 		std::shared_ptr<Animation> currentAnimation;
 		float currentTime;
 };
@@ -80,7 +85,9 @@ class AnimatedObject : public Object
 		virtual ~AnimatedObject();
 		std::vector<std::shared_ptr<Animation>> & getAnimations();
 		std::unique_ptr<Animator> & getAnimator();
-		virtual void draw(Shader& shader, std::array<glm::mat4, 50> & finalJointTransform, struct IBL_DATA * iblData = nullptr, DRAWING_MODE mode = DRAWING_MODE::SOLID);
+		virtual void draw(Shader& shader, std::vector<glm::mat4> & finalJointTransform, struct IBL_DATA * iblData = nullptr, DRAWING_MODE mode = DRAWING_MODE::SOLID);
+		void skin(Shader & cs, std::vector<glm::mat4> & finalJointTransform);
+		void bindBonePalette(std::vector<glm::mat4> & finalJointTransform);
 
 	private:
 		virtual void load(const std::string & path);
@@ -95,6 +102,11 @@ class AnimatedObject : public Object
 		std::map<std::string, glm::mat4> finalJointTransform; // [joint_name] => [matrix4x4]
 		std::vector<std::shared_ptr<Animation>> animations;
 		std::unique_ptr<Animator> animator;
+		bool skinned; // meshes read their skinned vertex buffers, skin() runs every frame
+		int jointCount; // joint ids go from 1 to jointCount
+		GLint paletteAlignment;
+		long paletteOffset; // bone matrices of this frame in the ring buffer, -1 when it was full
+		unsigned long paletteFrame;
 };
 
 #endif
@@ -41,6 +41,7 @@ class Camera
 		glm::vec3 getUp();
 		glm::vec3 getOrientation();
 		void setProjection(glm::ivec2 scrDim, float near, float far);
+		void setJitter(glm::vec2 offset);
 		CAM_TYPE getType();
         void rotateAroundAxis(glm::vec3 axis, float delta);
 
@@ -74,6 +75,7 @@ class Camera
 		glm::mat4 prev_view;
 		glm::mat4 view;
 		glm::mat4 projection;
+		glm::vec2 jitter; // clip space sub pixel offset baked in the projection (TAA)
 		float nearPlane;
 		float farPlane;
 
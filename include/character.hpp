@@ -34,6 +34,7 @@ class Character
 		glm::mat4 getModel();
 		void setModel(glm::mat4 & m);
 		void draw(Shader& shader, struct IBL_DATA * iblData = nullptr, DRAWING_MODE mode = DRAWING_MODE::SOLID);
+		void skin(Shader & cs);
 		std::unique_ptr<AnimatedObject> & get();
 		std::shared_ptr<Camera> & getCamera();
 		glm::vec3 getPosition();
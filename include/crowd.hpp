@@ -0,0 +1,63 @@
+#ifndef CROWD_HPP
+#define CROWD_HPP
+
+#include <GL/glew.h>
+#include <string>
+#include <vector>
+#include <memory>
+#include <cmath>
+#include <iostream>
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_access.hpp>
+#include "animatedObject.hpp"
+#include "shader_light.hpp"
+
+#define CROWD_INSTANCE_BINDING 5 // storage buffer binding of the per instance clip data
+#define CROWD_TEXTURE_UNIT 18
+
+struct CrowdClip
+{
+	std::string name;
+	int firstFrame; // row of the baked texture
+	int frameCount;
+	float padding; // growth of the bind pose sphere over the clip, object space
+};
+
+// many instances of one skinned model, each mesh is a single instanced draw :
+// clips are baked once into a texture of joint matrices the vertex shader samples
+// with the clip, time offset and playback rate of its instance, no CPU animation per frame
+class Crowd
+{
+	public:
+
+		Crowd(const std::string & path, int aBakeRate = 30);
+		~Crowd();
+		int addInstance(glm::mat4 model, const std::string & clip, float timeOffset = 0.0f, float rate = 1.0f);
+		void setInstanceClip(int instance, const std::string & clip, float rate = 1.0f);
+		void clearInstances();
+		void update(float delta);
+		void draw(Shader & shader, struct IBL_DATA * iblData = nullptr, DRAWING_MODE mode = DRAWING_MODE::SOLID);
+		int getInstanceCount();
+		struct BoundingSphere getBoundingSphere();
+		std::vector<CrowdClip> & getClips();
+		std::unique_ptr<AnimatedObject> & get();
+
+	private:
+
+		void bake();
+		void upload();
+		int getClip(const std::string & name);
+
+		std::unique_ptr<AnimatedObject> object;
+		std::vector<CrowdClip> clips;
+		std::vector<glm::mat4> models;
+		std::vector<glm::vec4> instances; // first frame, frame count, time offset, playback rate
+		GLuint animationTexture;
+		GLuint instanceBuffer;
+		int bakeRate; // baked frames per second
+		float padding; // world space growth of the bounding sphere under the playing clips
+		float time;
+		bool dirty; // instances changed since the last upload
+};
+
+#endif
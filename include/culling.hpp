@@ -0,0 +1,25 @@
+#ifndef CULLING_HPP
+#define CULLING_HPP
+
+#include <array>
+#include <cmath>
+#include <glm/glm.hpp>
+
+struct BoundingSphere
+{
+	glm::vec3 center;
+	float radius;
+};
+
+// planes are stored as (normal, distance), normals pointing inside
+struct Frustum
+{
+	std::array<glm::vec4, 6> planes;
+};
+
+Frustum frustumFromMatrix(const glm::mat4 & viewProj);
+bool sphereInFrustum(const BoundingSphere & sphere, const Frustum & frustum);
+bool sphereInSphere(const BoundingSphere & sphere, const BoundingSphere & range);
+bool sphereInCone(const BoundingSphere & sphere, glm::vec3 apex, glm::vec3 direction, float halfAngle, float range);
+
+#endif
@@ -0,0 +1,46 @@
+#ifndef DYNAMIC_RESOLUTION_HPP
+#define DYNAMIC_RESOLUTION_HPP
+
+#include <GL/glew.h>
+#include <array>
+#include <algorithm>
+#include <cmath>
+
+#define DYNAMIC_RESOLUTION_FRAMES 3 // timer queries in flight, results read without stalling
+#define DYNAMIC_RESOLUTION_HEADROOM 0.9f // fraction of the target frame time aimed at
+
+// render scale driven by the GPU time of past frames, scene passes render
+// in the lower left part of the full size targets and are upscaled at compositing
+class DynamicResolution
+{
+	public:
+
+		DynamicResolution(float aTargetFrameTime = 16.6f, float aMinScale = 0.5f, float aMaxScale = 1.0f);
+		~DynamicResolution();
+		void beginFrame();
+		void endFrame();
+		void setEnabled(bool e);
+		bool isEnabled();
+		void setTargetFrameTime(float ms);
+		float getTargetFrameTime();
+		void setScaleRange(float aMinScale, float aMaxScale);
+		float getScale();
+		float getGPUTime(); // milliseconds, last resolved frame
+
+	private:
+
+		void adjust(float time, float queryScale);
+
+		std::array<GLuint, DYNAMIC_RESOLUTION_FRAMES> queries;
+		std::array<bool, DYNAMIC_RESOLUTION_FRAMES> pending;
+		std::array<float, DYNAMIC_RESOLUTION_FRAMES> queryScale; // scale the frame was rendered at
+		int current;
+		bool enabled;
+		float targetFrameTime;
+		float minScale;
+		float maxScale;
+		float scale;
+		float gpuTime;
+};
+
+#endif
@@ -14,6 +14,14 @@ struct EDITOR_UI_SETTINGS
     int motion_blur{0};
     int show_physics{0};
     int shader_type{ 1 }; // 0 = blinn, 1 = pbr, 2 = toon
+    int dynamic_resolution{0};
+    float target_frame_time{16.6f}; // milliseconds
+    float exposure{1.0f};
+    bool vignette{true};
+    bool color_grading{false};
+    float saturation{1.0f};
+    float contrast{1.0f};
+    int anti_aliasing{0}; // 0 = MSAA, 1 = FXAA, 2 = TAA, 3 = off
 };
 
 #endif
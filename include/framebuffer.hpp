@@ -11,6 +11,7 @@ enum class ATTACHMENT_TYPE
 {
 	TEXTURE,
 	TEXTURE_CUBE_MAP,
+	TEXTURE_CUBE_MAP_ARRAY,
 	RENDER_BUFFER
 };
 
@@ -40,12 +41,15 @@ class Framebuffer
 		void updateAttachment(ATTACHMENT_TYPE type, ATTACHMENT_TARGET target, int width, int height);
 		std::vector<Attachment> & getAttachments();
 		void bind();
+		void bindLayer(int layer, int index = 0);
 		void unbind();
 		void blitFramebuffer(Framebuffer & writeFBO, int width, int height);
 		void blitFramebuffer(std::unique_ptr<Framebuffer> & writeFBO, int width, int height);
 		GLuint getId();
 		int getColorAttachmentCount();
 		void addSingleColorTextureAttachment(GLint format, GLenum minMagFilter, int width, int height);
+		void addSizedColorTextureAttachment(GLint internalFormat, GLenum format, GLenum type, GLenum minMagFilter, int width, int height);
+		void addDepthTextureCubemapArrayAttachment(int width, int height, int layers);
 
 	private:
 
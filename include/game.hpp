@@ -57,6 +57,9 @@ class Game
 		std::shared_ptr<Character> character;
 		std::unique_ptr<NetworkClient> m_client;
 		std::unique_ptr<NetworkServer> m_server;
+		std::vector<glm::mat4> stdLightSpaceMatrices; // directional lights first, spot lights last
+		std::vector<int> omniShadowLayers; // cube map array layer per point light, -1 without shadow
+		std::vector<int> shadowSizes; // atlas sizes requested last frame, directional then spot
     
     private:
 
@@ -69,16 +72,22 @@ class Game
 
 		void directionalShadowPass(int index, float delta, DRAWING_MODE mode = DRAWING_MODE::SOLID);
 		void omnidirectionalShadowPass(int index, float delta, DRAWING_MODE mode = DRAWING_MODE::SOLID);
-		void bloomPass(int width, int height, std::unique_ptr<Framebuffer> & in, int attachmentIndex, GLuint out);
+		void cachedShadowMap(int index, std::unique_ptr<Framebuffer> & fbo, std::unique_ptr<Framebuffer> & cacheFBO, ShadowCache & cache, std::size_t lightKey, glm::ivec3 region, int layer, const std::vector<std::pair<glm::mat4, ShadowCasters>> & faces, DRAWING_MODE mode = DRAWING_MODE::SOLID);
+		int shadowMapSize(SHADOW_QUALITY quality, const BoundingSphere & volume, Camera & cam, int previous = 0);
+		void setShadowUniforms(Shader & s, int index, int textureUnit);
+		void clusterLights(int index);
+		void bloomPass(int width, int height, int renderWidth, int renderHeight, const std::string & input, int attachmentIndex, const std::string & output);
 		void GBufferPass(int index, int width, int height, float delta);
         void ssaoPass(int index, int width, int height, float delta);
 		void colorMultisamplePass(int index, int width, int height, float delta, DRAWING_MODE mode = DRAWING_MODE::SOLID, bool debug = false);
+		void deferredLightingPass(int index, int width, int height);
+		void orderIndependentPass(int index, Shader & s, DRAWING_MODE mode = DRAWING_MODE::SOLID);
 		void toonOutline(int width, int height);
 		void volumetricsPass(int index, int width, int height, float delta, double elapsedTime);
 		void motionBlurPass(int index, int width, int height);
-		void compositingPass();
-		inline void sceneCompositing();
-		inline void uiCompositing();
+		void fxaaPass(int width, int height);
+		void taaPass(int index, int width, int height);
+		void compositingPass(const std::string & scene);
 };
 
 #endif
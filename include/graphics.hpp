@@ -5,6 +5,7 @@
 #include <utility>
 #include <array>
 #include <random>
+#include <unordered_map>
 #include <glm/glm.hpp>
 #include <glm/gtc/matrix_transform.hpp>
 #include <glm/gtc/type_ptr.hpp>
@@ -14,6 +15,10 @@
 #include "renderTexture.hpp"
 #include "shader_light.hpp"
 #include "helpers.hpp"
+#include "shadowAtlas.hpp"
+#include "lightClusters.hpp"
+#include "dynamicResolution.hpp"
+#include "renderGraph.hpp"
 
 enum class TONE_MAPPING
 {
@@ -22,11 +27,43 @@ enum class TONE_MAPPING
 	OFF = 2
 };
 
+enum class ANTI_ALIASING
+{
+	MSAA = 0, // 4 samples per pixel in the color pass
+	FXAA = 1, // single sample, edges filtered after the color pass
+	TAA = 2, // single sample, jittered and accumulated over frames
+	OFF = 3
+};
+
+#define SHADOW_ATLAS_SIZE 4096
+#define SHADOW_SIZE_HYSTERESIS 0.25f // coverage margin before a spot map changes resolution
+#define SSAO_DOWNSAMPLE 2 // ambient occlusion computed at 1/2 resolution
+#define SSAO_MAX_KERNEL_SIZE 128
+#define BLOOM_LEVELS 6 // 1/2 to 1/64 resolution, one 64x64 tile per downsample workgroup
+#define VOLUMETRICS_STEPS 8 // raymarch steps per frame, accumulated over frames
+#define TAA_JITTER_SAMPLES 8 // halton (2, 3) sub pixel offsets
+
+// post processing uber shader variants, one define per bit
+#define POST_BLOOM 1
+#define POST_VOLUMETRICS 2
+#define POST_MOTION_BLUR 4
+#define POST_SHARPEN 8
+#define POST_VIGNETTE 16
+#define POST_COLOR_GRADING 32
+
+struct ShadowCache
+{
+	bool valid;
+	std::size_t key; // light transform + static casters content version
+	bool dynamicDrawn; // dynamic casters were drawn over the cached layer last frame
+};
+
 class Graphics
 {
 	public:
 
 		Graphics(int width, int height);
+		~Graphics();
 		void setColorShader(SHADER_TYPE type)
 		{
 			m_colorShaderType = type;
@@ -45,14 +82,12 @@ class Graphics
 		}
 		void setNearPlane(float nearPlane);
 		void setFarPlane(float farPlane);
+		float getNearPlane();
+		float getFarPlane();
 		void setShadows(bool s);
 		bool shadowsOn();
 		void setBloomEffect(bool b);
 		bool bloomOn();
-		float getBloomSigma();
-		int getBloomSize();
-		void setBloomSigma(float sigma);
-		void setBloomSize(int size);
 		void setSSAOEffect(bool ao);
 		bool ssaoOn();
         int getAOSampleCount();
@@ -61,12 +96,19 @@ class Graphics
         void setAORadius(float radius);
 		void setVolumetricLighting(bool v);
 		bool volumetricLightingOn();
+		void setOIT(bool o);
+		bool oitOn();
+		void setDeferred(bool d);
+		bool deferredOn();
+		void setAntiAliasing(ANTI_ALIASING aa);
+		ANTI_ALIASING getAntiAliasing();
+		glm::vec2 getTAAJitter(int renderWidth, int renderHeight);
 		void set_scene_tone_mapping(TONE_MAPPING tone);
 		void set_ui_tone_mapping(TONE_MAPPING tone);
 		TONE_MAPPING get_scene_tone_mapping();
 		TONE_MAPPING get_ui_tone_mapping();
-		void setStdShadowQuality(SHADOW_QUALITY quality, int index);
-		void setOmniShadowQuality(SHADOW_QUALITY quality, int index);
+		void updateShadowAtlas(const std::vector<int> & sizes);
+		void updateOmniShadowArray(int lightCount, SHADOW_QUALITY quality);
 		glm::mat4 getOrthoProjection(float orthoDimension);
 		glm::mat4 & getOmniPerspProjection();
 		glm::mat4 getSpotPerspProjection(float outerCutOff, float shadowQuality);
@@ -76,47 +118,75 @@ class Graphics
 		Shader & getGBufferShader();
 		Shader & getAOShader();
 		Shader & getAOBlurShader();
-		Shader & getGaussianBlurShader();
-		Shader & getTentBlurShader();
-		Shader & getUpSamplingShader();
-		Shader & getDownSamplingShader();
+		Shader & getAODownSamplingShader();
 		Shader & getVolumetricLightingShader();
         Shader & getVolumetricDownSamplingShader();
+        Shader & getVolumetricTemporalShader();
+        Shader & getVolumetricUpSamplingShader();
         Shader & getBilateralBlurShader();
-		Shader & getFinalShader();
+		Shader & getOITCompositingShader();
+		Shader & getFXAAShader();
+		Shader & getTAAShader();
+		Shader & getImpostorShader(bool gBuffer = false);
+		Shader & getDeferredLightingShader();
+		Shader & getPostShader(int effects);
 		std::unique_ptr<Framebuffer> & getMultisampleFBO();
 		std::unique_ptr<Framebuffer> & getNormalFBO(int index);
-		std::unique_ptr<Framebuffer> & getOmniDepthFBO(int index);
-		std::unique_ptr<Framebuffer> & getStdDepthFBO(int index);
+		std::unique_ptr<Framebuffer> & getShadowAtlasFBO();
+		std::unique_ptr<Framebuffer> & getShadowAtlasCacheFBO();
+		std::unique_ptr<Framebuffer> & getOmniShadowFBO();
+		std::unique_ptr<Framebuffer> & getOmniShadowCacheFBO();
+		ShadowAtlas & getShadowAtlas();
+		int getOmniShadowResolution();
+		ShadowCache & getOmniShadowCache(int index);
+		ShadowCache & getStdShadowCache(int index);
+		LightClusters & getLightClusters();
 		std::unique_ptr<Framebuffer> & getGBufferFBO();
-		std::unique_ptr<Framebuffer> & getAOFBO(int index);
-		std::unique_ptr<Framebuffer> & getDownSamplingFBO(int index);
-		std::unique_ptr<Framebuffer> & getPingPongFBO(int index);
-		std::unique_ptr<Framebuffer> & getUpSamplingFBO(int index);
-		std::unique_ptr<Framebuffer> & getVolumetricsFBO(int index);
+		std::unique_ptr<Framebuffer> & getVolumetricsHistoryFBO(int index);
+		void releaseVolumetricsHistory();
+		std::unique_ptr<Framebuffer> & getTAAHistoryFBO(int index);
+		void releaseTAAHistory();
+		RenderGraph & getRenderGraph();
 		std::unique_ptr<Mesh> & getQuadMesh();
+		std::unique_ptr<Mesh> & getScaledQuadMesh();
+		DynamicResolution & getDynamicResolution();
+		void setRenderScale(glm::vec2 scale);
+		glm::vec2 getRenderScale();
+		void setUpscaleSharpness(float sharpness);
+		float getUpscaleSharpness();
+		void setExposure(float e);
+		float getExposure();
+		void setVignette(bool v);
+		bool vignetteOn();
+		void setColorGrading(bool c, float aSaturation = 1.0f, float aContrast = 1.0f, glm::vec3 aColorFilter = glm::vec3(1.0f));
+		bool colorGradingOn();
 		void resizeScreen(int width, int height);
+		void createColorFBO(int width, int height);
 		std::vector<glm::vec3> & getAOKernel();
-		GLuint getAONoiseTexture();
-		GLuint getBloomTexture(int index);
+		void generateAOKernel();
+		GLuint getAOKernelBuffer();
 
 	public:
 
-		std::unique_ptr<Framebuffer> multisample; // color + depth + stencil
+		std::unique_ptr<Framebuffer> multisample; // color + bright color + OIT accumulation + OIT revealage + depth + stencil, single sample unless MSAA
 		std::array<std::unique_ptr<Framebuffer>, 2> normal; // only color, no multisampling
-		std::array<std::unique_ptr<Framebuffer>, 10> omniDepth; // for omnidirectional shadow mapping
-		std::array<std::unique_ptr<Framebuffer>, 10> stdDepth; // for directional and spotlight shadow mapping
-		std::unique_ptr<Framebuffer> GBuffer; // view position + normal + view depth + world position
-		std::array<std::unique_ptr<Framebuffer>, 2> AOBuffer; // single color component (RED) for ambient occlusion data
-		std::array<std::unique_ptr<Framebuffer>, 6> downSampling; // only color, no multisampling
-		std::array<std::unique_ptr<Framebuffer>, 12> ping_pong; // only color, no multisampling
-		std::array<std::unique_ptr<Framebuffer>, 12> upSampling; // only color, no multisampling
-		std::array<GLuint, 2> bloomTexture;
-        std::array<std::unique_ptr<Framebuffer>, 4> volumetrics; // hdr color, no multisampling
-        std::unique_ptr<Framebuffer> motionBlurFBO;
-        std::unique_ptr<Framebuffer> userInterfaceFBO;
-		std::array<std::unique_ptr<Framebuffer>, 2> compositeFBO;
-		std::array<RenderTexture, 2> toonOutlineRT;
+		std::unique_ptr<Framebuffer> shadowAtlasFBO; // directional and spotlight shadow maps
+		std::unique_ptr<Framebuffer> shadowAtlasCacheFBO; // static casters only
+		ShadowAtlas shadowAtlas;
+		std::vector<ShadowCache> stdCache;
+		std::unique_ptr<Framebuffer> omniShadowFBO; // cube map array, one layer per point light
+		std::unique_ptr<Framebuffer> omniShadowCacheFBO; // static casters only
+		int omniShadowResolution;
+		int omniShadowCapacity;
+		std::vector<ShadowCache> omniCache;
+		LightClusters lightClusters;
+		DynamicResolution dynamicResolution;
+		std::unique_ptr<Framebuffer> GBuffer; // octahedral normal + albedo + metallic/roughness + emission + depth
+        std::array<std::unique_ptr<Framebuffer>, 2> volumetricsHistory; // low res, allocated while volumetrics run
+		std::array<std::unique_ptr<Framebuffer>, 2> taaHistory; // allocated while TAA runs
+		RenderGraph renderGraph; // per frame targets : AO, bloom, volumetrics, motion blur, UI, compositing
+		int screenWidth;
+		int screenHeight;
 
 		TONE_MAPPING scene_tone_mapping;
 		TONE_MAPPING ui_tone_mapping;
@@ -125,26 +195,35 @@ class Graphics
 		float far;
 		bool shadows;
 		bool bloomEffect;
-		float bloomSigma;
-		int bloomSize;
 		bool ssaoEffect;
         int ssaoSampleCount;
         float ssaoRadius;
 		bool volumetricsOn;
+		int volumetricsFrame; // frames accumulated in the volumetrics history, 0 when invalid
+		bool oitEffect; // weighted blended order independent transparency
+		bool deferredShading; // opaque lit once per pixel from the G-buffer, PBR only
+		ANTI_ALIASING antiAliasing;
+		int taaFrame; // frames accumulated in the TAA history, 0 when invalid
         bool motionBlurFX;
         int motionBlurStrength;
+		glm::vec2 renderScale; // rendered part of the full size scene targets
+		float upscaleSharpness;
+		float exposure;
+		bool vignette;
+		bool colorGrading;
+		float saturation;
+		float contrast;
+		glm::vec3 colorFilter;
 		glm::mat4 omniPerspProjection; // for point lights
-		GLuint aoNoiseTexture;
+		GLuint aoKernelUBO;
 		std::vector<glm::vec3> aoKernel;
 		glm::vec3 outlineColor;
 
-		Shader cs_gaussianBlur;
-		Shader cs_sobel;
-		Shader cs_nms; // non maximum suppression
-		Shader cs_double_thresholding;
-		Shader cs_hysteresis;
-		Shader cs_dilate;
-		Shader cs_outline;
+		Shader cs_toonEdges; // blur, sobel, non maximum suppression, thresholds, hysteresis
+		Shader cs_toonOutline; // dilation, blur, outline
+		Shader cs_bloomDownSample; // every bloom level in one dispatch
+		Shader cs_bloomUpSample; // tent filter, in place
+		Shader cs_skinning; // animated meshes, once per frame for every pass
 		Shader blinnPhong;
 		Shader pbr;
 		Shader toon;
@@ -152,19 +231,24 @@ class Graphics
 		Shader gBuffer;
 		Shader ao;
 		Shader aoBlur;
-		Shader gaussianBlur;
-		Shader tentBlur;
-		Shader downSample;
-		Shader upSample;
+		Shader aoDownSample;
 		Shader volumetricLighting;
 		Shader VLDownSample;
+		Shader VLTemporal;
+		Shader VLUpSample;
         Shader bilateralBlur;
         Shader motionBlur;
-		Shader sceneCompositing;
-		Shader uiCompositing;
-		Shader end;
+		Shader oitCompositing;
+		Shader oitCompositingMS; // per sample, MSAA color targets
+		Shader fxaa;
+		Shader taa;
+		Shader impostor;
+		Shader impostorGBuffer; // G-buffer outputs, lit by the deferred pass
+		Shader deferredLighting;
+		std::unordered_map<int, std::unique_ptr<Shader>> post; // compiled when an effect combination is first used
 
 		std::unique_ptr<Mesh> quad;
+		std::unique_ptr<Mesh> scaledQuad; // texture coordinates span the rendered part only
 		Material quadMaterial;
 };
 
@@ -1,6 +1,38 @@
 #ifndef HELPERS_HPP
 #define HELPERS_HPP
 
+#include <functional>
+#include <vector>
+#include <array>
+#include <cstdint>
+#include <glm/glm.hpp>
+
 float lerp(float a, float b, float k);
 
+template<typename T>
+void hashCombine(std::size_t & seed, const T & v)
+{
+	seed ^= std::hash<T>{}(v) + 0x9e3779b9 + (seed << 6) + (seed >> 2);
+}
+
+void hashCombine(std::size_t & seed, const glm::mat4 & m);
+
+// stable LSD radix sort on 16 bits keys, scratch keeps its capacity between calls
+template<typename T, typename Key>
+void radixSort16(std::vector<T> & items, std::vector<T> & scratch, Key key)
+{
+	scratch.resize(items.size());
+	for(int shift{0}; shift < 16; shift += 8)
+	{
+		std::array<std::size_t, 257> offsets{};
+		for(const T & item : items)
+			offsets[((key(item) >> shift) & 0xff) + 1]++;
+		for(int i{0}; i < 256; ++i)
+			offsets[i + 1] += offsets[i];
+		for(const T & item : items)
+			scratch[offsets[(key(item) >> shift) & 0xff]++] = item;
+		items.swap(scratch);
+	}
+}
+
 #endif
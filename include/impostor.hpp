@@ -0,0 +1,56 @@
+#ifndef IMPOSTOR_HPP
+#define IMPOSTOR_HPP
+
+#include <GL/glew.h>
+#include <array>
+#include <vector>
+#include <cmath>
+#include <cstddef>
+#include <iostream>
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+#include "object.hpp"
+#include "shader_light.hpp"
+#include "ringBuffer.hpp"
+
+#define IMPOSTOR_FADE_RANGE 0.1f // cross-fade band after the impostor distance, fraction of it
+
+struct ImpostorInstance
+{
+	glm::mat4 model;
+	float fade; // 0 geometry only, 1 impostor only
+};
+
+// an object baked from views x views directions laid out on an octahedron into
+// albedo, normal, metallic roughness and depth atlases, drawn far away as one
+// instanced quad that blends the four nearest views
+class Impostor
+{
+	public:
+
+		Impostor(Object & object, Shader & bakeShader, int aViews = 8, int aResolution = 128);
+		~Impostor();
+		void clear();
+		void add(const glm::mat4 & model, float fade);
+		void draw(Shader & shader);
+		glm::vec3 getCenter();
+		float getRadius();
+		static glm::vec3 viewDirection(glm::vec2 uv);
+
+	private:
+
+		void bake(Object & object, Shader & bakeShader);
+
+		int views;
+		int resolution; // per view
+		glm::vec3 center; // object space bounding sphere
+		float radius;
+		std::array<GLuint, 4> atlas; // albedo, normal, metallic roughness, depth
+		GLuint vao;
+		GLuint vbo;
+		std::vector<ImpostorInstance> instances;
+		long instanceOffset; // instances of this frame in the ring buffer, -1 when it was full
+		unsigned long instanceFrame;
+};
+
+#endif
@@ -0,0 +1,68 @@
+#ifndef LIGHT_CLUSTERS_HPP
+#define LIGHT_CLUSTERS_HPP
+
+#include <GL/glew.h>
+#include <vector>
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <glm/glm.hpp>
+#include "shader_light.hpp"
+#include "ringBuffer.hpp"
+
+#define CLUSTER_X 16
+#define CLUSTER_Y 9
+#define CLUSTER_Z 24
+
+// std430 layout of the Light struct read by the lighting shaders
+struct GPULight
+{
+	glm::mat4 lightSpaceMatrix{1.0f};
+	glm::vec4 atlasRegion{0.0f};
+	glm::vec3 position{0.0f};
+	int type{0}; // 0 => point, 1 => directional, 2 => spot
+	glm::vec3 direction{0.0f, -1.0f, 0.0f};
+	float cutOff{0.0f}; // cosine
+	glm::vec3 ambientStrength{0.0f};
+	float outerCutOff{0.0f}; // cosine
+	glm::vec3 diffuseStrength{0.0f};
+	float kc{1.0f};
+	glm::vec3 specularStrength{0.0f};
+	float kl{0.0f};
+	float kq{0.0f};
+	int shadowLayer{-1}; // -1 without omni shadow map
+	float range{0.0f};
+	float padding{0.0f};
+};
+
+// Clustered forward lighting : the view frustum is split in screen tiles and exponential depth slices,
+// each light is listed in the clusters its range overlaps and fragments only loop over their cluster's list.
+// The lists are built on the CPU and streamed through the ring buffer every frame.
+class LightClusters
+{
+	public:
+
+		LightClusters();
+		void update(const std::vector<GPULight> & aLights, const glm::mat4 & aView, const glm::mat4 & aProj, float aNear, float aFar);
+		void bind(Shader & s);
+		int getLightCount();
+		int getIndexCount();
+
+	private:
+
+		bool clusterRange(const GPULight & light, glm::ivec3 & first, glm::ivec3 & last);
+		int slice(float depth);
+
+		std::vector<GPULight> lights;
+		std::vector<glm::uvec2> grid; // first index, count
+		std::vector<GLuint> indices;
+		glm::mat4 view;
+		glm::mat4 proj;
+		float near;
+		float far;
+		long offsets[3]; // lights, grid, indices in the ring buffer
+		long sizes[3];
+		GLint alignment;
+};
+
+#endif
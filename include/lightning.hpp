@@ -5,6 +5,7 @@
 #include <chrono>
 #include <random>
 #include "shader_light.hpp"
+#include "ringBuffer.hpp"
 
 struct Lightning
 {
@@ -38,12 +39,10 @@ struct Lightning
 		for(int i{0}; i < arcs.size(); i+=2)
 			m_arcs.emplace_back(arcs[i], arcs[i+1]);
 
-		// VAO
+		// VAO, triangles are streamed through the ring buffer
 		glGenVertexArrays(1, &VAO);
 		glBindVertexArray(VAO);
-		glGenBuffers(1, &VBO);
-		glBindBuffer(GL_ARRAY_BUFFER, VBO);
-		glBufferData(GL_ARRAY_BUFFER, MAX_POINTS * sizeof(float), nullptr, GL_DYNAMIC_DRAW);
+		glBindBuffer(GL_ARRAY_BUFFER, RingBuffer::get().getId());
 		glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 3 * sizeof(float), (void*)0);
 		glEnableVertexAttribArray(0);
 
@@ -56,10 +55,6 @@ struct Lightning
 
 	~Lightning()
 	{
-		glBindVertexArray(VAO);
-		glBindBuffer(GL_ARRAY_BUFFER, 0);
-		glDeleteBuffers(1, &VBO);
-		glBindVertexArray(0);
 		glDeleteVertexArrays(1, &VAO);
 	}
 
@@ -232,13 +227,6 @@ struct Lightning
 				m_triangles.push_back(p8[2]);
 			}
 		}
-
-		// update VBO
-		glBindVertexArray(VAO);
-		glBindBuffer(GL_ARRAY_BUFFER, VBO);
-		void * vbo_ptr = glMapBuffer(GL_ARRAY_BUFFER, GL_WRITE_ONLY);
-		memcpy(vbo_ptr, m_triangles.data(), m_triangles.size() * sizeof(float));
-		glUnmapBuffer(GL_ARRAY_BUFFER);
 	}
 
 	void draw(glm::mat4 & view, glm::mat4 & proj, float delta)
@@ -252,14 +240,18 @@ struct Lightning
 				genTriangles();
 			}
 		}
+		const long stride{3 * sizeof(float)};
+		long offset = RingBuffer::get().push(m_triangles.data(), m_triangles.size() * sizeof(float), stride);
+		if(offset < 0)
+			return;
+
 		glBindVertexArray(VAO);
-		glBindBuffer(GL_ARRAY_BUFFER, VBO);
 		lightning.use();
 		lightning.setMatrix("view", view);
 		lightning.setMatrix("proj", proj);
 		lightning.setVec3f("color", m_color);
 		lightning.setFloat("intensity", m_intensity);
-		glDrawArrays(GL_TRIANGLES, 0, m_triangles.size()/3);
+		glDrawArrays(GL_TRIANGLES, offset / stride, m_triangles.size()/3);
 	}
 
 	void setIntensity(float intensity)
@@ -288,7 +280,6 @@ struct Lightning
 	std::vector<struct Arc> m_arcs;
 
 	GLuint VAO;
-	GLuint VBO;
 };
 
 #endif
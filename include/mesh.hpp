@@ -10,6 +10,7 @@
 #include <glm/gtx/string_cast.hpp>
 #include "shader_light.hpp"
 #include "IBL.hpp"
+#include "ringBuffer.hpp"
 
 enum class DRAWING_MODE
 {
@@ -67,7 +68,9 @@ class Mesh
 		std::vector<Vertex> const& getVertices() const;
 		std::vector<int> const& getIndices() const;
 		Material & getMaterial();
-		void bindVAO() const;
+		void bindVAO(bool depthOnly = false) const;
+		void setInstanceBuffer(GLuint buffer, long offset);
+		void skin(Shader & cs);
 		void draw(Shader & s, struct IBL_DATA * iblData = nullptr, bool instancing = false, int amount = 1, DRAWING_MODE mode = DRAWING_MODE::SOLID);
 		void recreate(std::vector<Vertex> aVertices, std::vector<int> aIndices, bool dynamicDraw);
 		void updateVBO(std::vector<Vertex> aVertices, std::vector<int> aIndices);
@@ -81,6 +84,9 @@ class Mesh
 		GLuint vao;
 		GLuint vbo;
 		GLuint ebo;
+		GLuint depthVao; // position stream, used by depth only passes
+		GLuint depthVbo;
+		GLuint skinnedVbo; // skinned vertices, written once per frame by a compute pass, 0 until the first one
 
 		std::string name;
 		std::vector<Vertex> vertices;
@@ -88,7 +94,14 @@ class Mesh
         glm::vec3 m_center;
         glm::vec3 m_center_update;
 		Material material;
+		bool streamed; // vertices rewritten every frame (soft bodies), read from the ring buffer
+		long indexOffset; // bytes into the element buffer, -1 when the ring buffer was full
+		unsigned long streamFrame;
 
+		void setPermutation(const std::vector<Vertex> & aVertices);
+		void createDepthStream(const std::vector<Vertex> & aVertices, bool dynamicDraw);
+		void deleteDepthStream();
+		void stream();
 		void shaderProcessing(Shader & s, struct IBL_DATA * iblData); // set proper uniforms according to shader type
 		void processBlinnPhong(Shader& s);
 		void processPBR(Shader & s, struct IBL_DATA * iblData);
@@ -7,7 +7,9 @@
 #include <string>
 #include <glm/glm.hpp>
 #include <glm/gtx/string_cast.hpp>
+#include <algorithm>
 #include "shader_light.hpp"
+#include "ringBuffer.hpp"
 
 class Mouse
 {
@@ -28,7 +30,7 @@ public:
 private:
 
 	GLuint m_vao;
-	GLuint m_vbo;
+	float m_quad[24];
 	int m_screen[2];
 	int m_pos[2]; // [x,y] top left corner
 	int m_size[2]; // [x,y] size
@@ -3,6 +3,7 @@
 
 #include <vector>
 #include <string>
+#include <limits>
 #include <assimp/Importer.hpp>
 #include <assimp/Exporter.hpp>
 #include <assimp/scene.h>
@@ -16,6 +17,7 @@
 #include "rapidxml.hpp"
 #include "mesh.hpp"
 #include "shader_light.hpp"
+#include "culling.hpp"
 
 glm::mat4 assimpMat4_to_glmMat4(aiMatrix4x4 & m);
 glm::mat3 assimpMat3_to_glmMat3(aiMatrix3x3 & m);
@@ -43,12 +45,26 @@ class Object
 		void resetInstancing();
         bool getInstancing();
 		std::string getName();
+		std::string & getPath();
 		glm::mat4 getModel();
 		void setModel(glm::mat4 & matrix);
+		void setDynamic(bool d);
+		bool isDynamic();
+		unsigned int getVersion();
+		void setBatchable(bool b);
+		bool isBatchable();
+		void setOccluder(bool o, const std::string & proxyPath = ""); // optional low poly proxy file
+		bool isOccluder();
+		std::vector<glm::vec3> & getOccluderPositions();
+		std::vector<int> & getOccluderIndices();
+		void setImpostorDistance(float d);
+		float getImpostorDistance();
 		struct AABB getAABB();
+		struct BoundingSphere getBoundingSphere();
 		void setCollisionShape(std::string & collisionFilePath, glm::mat4 & aModel);
 		std::shared_ptr<Object> getCollisionShape();
 		std::vector<glm::mat4> & getInstanceModel();
+		GLuint getInstanceVBO();
 
 	protected:
 
@@ -74,6 +90,16 @@ class Object
 		std::vector<glm::mat4> instanceModel;
 		glm::mat4 model;
 		bool instancing;
+		bool dynamic; // moved every frame (physics, animation), never cached in shadow maps
+		unsigned int version; // bumped each time the object is moved
+		bool batchable; // meshes may be merged with identical ones into instanced draws
+		bool occluder; // rasterized in the CPU occlusion buffer
+		std::vector<glm::vec3> occluderPositions; // all meshes merged, object space
+		std::vector<int> occluderIndices;
+		float impostorDistance; // drawn as an impostor beyond it, 0 never
+		struct BoundingSphere worldSphere; // cached, valid while sphereVersion == version
+		bool sphereValid;
+		unsigned int sphereVersion;
 
 		struct AABB aabb;
 };
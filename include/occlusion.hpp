@@ -0,0 +1,48 @@
+#ifndef OCCLUSION_HPP
+#define OCCLUSION_HPP
+
+#include <vector>
+#include <algorithm>
+#include <limits>
+#include <omp.h>
+#include <glm/glm.hpp>
+#include "culling.hpp"
+
+// small CPU depth buffer, occluders are rasterized in horizontal bands (one per thread)
+// and occludees are tested against a max depth pyramid, no GPU readback involved
+class OcclusionBuffer
+{
+	public:
+
+		OcclusionBuffer(int aWidth = 256, int aHeight = 128);
+		void clear(const glm::mat4 & aViewProj);
+		void addOccluder(const std::vector<glm::vec3> & positions, const std::vector<int> & indices, const glm::mat4 & model);
+		void rasterize();
+		bool isVisible(const BoundingSphere & sphere);
+		bool empty();
+		int getWidth();
+		int getHeight();
+		const std::vector<float> & getDepth(int level = 0);
+
+	private:
+
+		struct ScreenTriangle
+		{
+			glm::vec2 v[3]; // pixels
+			float depth; // farthest vertex depth, conservative
+			int minY;
+			int maxY;
+		};
+
+		void rasterizeBand(int y0, int y1);
+		void buildPyramid();
+
+		int width;
+		int height;
+		glm::mat4 viewProj;
+		std::vector<ScreenTriangle> triangles;
+		std::vector<std::vector<float>> pyramid; // [0] full resolution, then max depth of 2x2 texels
+		std::vector<glm::ivec2> levelSize;
+};
+
+#endif
@@ -13,6 +13,7 @@
 #include <glm/gtx/string_cast.hpp>
 #include <random>
 #include "shader_light.hpp"
+#include "ringBuffer.hpp"
 
 constexpr int MAX_PARTICLES{1'000};
 
@@ -53,8 +54,8 @@ class ParticleEmitter
 		float getMaxLifetime();
 		void setMaxLifetime(float value);
 		void drawEmitter(glm::mat4 view, glm::mat4 proj);
-		void drawParticles(glm::mat4 view, glm::mat4 proj, glm::vec3 camRight, glm::vec3 camUp);
-		void emit(glm::vec3 camPos, float delta);
+		void drawParticles(glm::mat4 view, glm::mat4 proj, glm::vec3 camRight, glm::vec3 camUp, bool orderIndependent = false);
+		void emit(glm::vec3 camPos, float delta, bool sort = true);
 
 	private:
 
@@ -72,12 +73,15 @@ class ParticleEmitter
 		GLuint emitter_vao;
 		GLuint emitter_vbo;
 		GLuint particles_vao;
-		GLuint particles_vbo;
+		long particles_first; // first particle vertex in the streaming ring buffer
+		unsigned long particles_frame; // ring buffer frame particles_first was written in
 		Shader emitter_shader;
 		Shader particles_shader;
 
 	private:
 
+		void streamParticles();
+
 		GLuint fireAtlas;
 };
 
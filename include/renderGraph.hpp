@@ -0,0 +1,96 @@
+#ifndef RENDER_GRAPH_HPP
+#define RENDER_GRAPH_HPP
+
+#include <GL/glew.h>
+#include <vector>
+#include <string>
+#include <functional>
+#include <unordered_map>
+#include <algorithm>
+#include <iostream>
+#include <memory>
+#include "framebuffer.hpp"
+
+#define RENDER_GRAPH_KEEP_FRAMES 3 // pooled targets unused for longer are released
+
+struct RenderTargetDesc
+{
+	RenderTargetDesc(int aWidth, int aHeight, GLint aInternalFormat = GL_RGBA16F, GLenum aFormat = GL_RGBA, GLenum aType = GL_FLOAT, GLenum aFilter = GL_LINEAR, int aAttachments = 1, int aLevels = 1);
+	bool operator==(const RenderTargetDesc & d) const;
+
+	int width;
+	int height;
+	GLint internalFormat;
+	GLenum format;
+	GLenum type;
+	GLenum filter;
+	int attachments; // color attachments, all of the same format
+	int levels; // mip levels, written by compute passes
+};
+
+// passes of a frame declared with the targets they read and write, compiled once per frame :
+// passes none of the outputs depend on are culled, transient targets come from a pool
+// and are shared by targets of the same format whose lifetimes do not overlap
+class RenderGraph
+{
+	public:
+
+		RenderGraph();
+		void reset();
+		void createTarget(const std::string & name, const RenderTargetDesc & desc);
+		void importTarget(const std::string & name, const std::vector<GLuint> & textures = {});
+		void addPass(const std::string & name, const std::vector<std::string> & reads, const std::vector<std::string> & writes, std::function<void()> execute);
+		void markOutput(const std::string & name);
+		void compile();
+		void execute();
+		bool hasTarget(const std::string & name);
+		std::unique_ptr<Framebuffer> & getFBO(const std::string & name);
+		GLuint getTexture(const std::string & name, int attachment = 0);
+		void releasePool();
+		int getPooledTargetCount();
+		int getActivePassCount();
+
+	private:
+
+		struct Resource
+		{
+			std::string name;
+			RenderTargetDesc desc;
+			bool imported;
+			int first; // first and last pass using it, -1 when unused
+			int last;
+			int physical; // pool index
+			std::vector<GLuint> textures; // imported targets only
+		};
+
+		struct Pass
+		{
+			std::string name;
+			std::vector<int> reads;
+			std::vector<int> writes;
+			std::function<void()> execute;
+			bool culled;
+		};
+
+		struct PooledTarget
+		{
+			RenderTargetDesc desc;
+			std::unique_ptr<Framebuffer> fbo;
+			int lastFrame;
+			int busyUntil; // last pass of the resource currently assigned
+		};
+
+		void allocateLevels(GLuint texture, const RenderTargetDesc & desc);
+		int find(const std::string & name);
+		std::vector<int> findAll(const std::vector<std::string> & names);
+
+		std::vector<Resource> resources;
+		std::unordered_map<std::string, int> lookup;
+		std::vector<Pass> passes;
+		std::vector<int> outputs;
+		std::vector<PooledTarget> pool;
+		std::unique_ptr<Framebuffer> none;
+		int frame;
+};
+
+#endif
@@ -0,0 +1,48 @@
+#ifndef RING_BUFFER_HPP
+#define RING_BUFFER_HPP
+
+#include <GL/glew.h>
+#include <array>
+#include <memory>
+#include <cstring>
+#include <iostream>
+
+#define RING_BUFFER_FRAMES 3
+
+struct RingAllocation
+{
+	void * data; // nullptr when the frame region is full
+	long offset; // bytes from the start of the buffer
+};
+
+// persistently mapped streaming buffer shared by every per frame upload,
+// the region written during a frame is only reused once its fence is signaled
+class RingBuffer
+{
+	public:
+
+		RingBuffer(long aFrameSize = 16 * 1024 * 1024);
+		~RingBuffer();
+		static RingBuffer & get();
+		static void release();
+		void beginFrame();
+		void endFrame();
+		RingAllocation allocate(long size, long alignment = 4);
+		long push(const void * data, long size, long alignment = 4);
+		GLuint getId();
+		unsigned long getFrame();
+
+	private:
+
+		GLuint buffer;
+		char * mapped;
+		long frameSize; // bytes per frame region
+		int region;
+		long used;
+		unsigned long frame;
+		std::array<GLsync, RING_BUFFER_FRAMES> fences;
+
+		static std::unique_ptr<RingBuffer> instance;
+};
+
+#endif
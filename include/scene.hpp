@@ -7,17 +7,24 @@
 #include <memory>
 #include <utility>
 #include <cstdlib>
+#include <functional>
+#include <map>
 #include "skybox.hpp"
 #include "camera.hpp"
 #include "color.hpp"
 #include "grid_axis.hpp"
 #include "graphics.hpp"
 #include "character.hpp"
+#include "crowd.hpp"
+#include "impostor.hpp"
 #include "IBL.hpp"
 #include "particle.hpp"
 #include "audio.hpp"
 #include "lightning.hpp"
 #include "worldPhysics.hpp"
+#include "helpers.hpp"
+#include "occlusion.hpp"
+#include "shadowCasters.hpp"
 
 enum class DRAW_TYPE
 {
@@ -41,9 +48,11 @@ class Scene
 		void addSpotLight(SHADOW_QUALITY quality, glm::vec3 pos, glm::vec3 amb, glm::vec3 diff, glm::vec3 spec, glm::vec3 dir, float innerAngle, float outerAngle);
 		void setSkybox(std::vector<std::string> & textures, bool flip);
 		void setIBL(std::string texture, bool flip, int clientWidth, int clientHeight);
+		std::unique_ptr<IBL> & getIBL();
 		void addParticlesEmitter(glm::vec3 pos, int emitRate, float maxLifetime, ParticleEmitter::DIRECTION direction_type, float speed, glm::vec3 direction_vector = glm::vec3(0.0f));
 		void addLightning(glm::vec3 from, glm::vec3 to, int step, glm::vec3 color, float intensity, std::vector<float> & arcs, bool dynamic, float refreshInterval);
 		void addVehicle(std::shared_ptr<Vehicle> vehicle);
+		void addCrowd(std::shared_ptr<Crowd> crowd);
 		std::vector<std::unique_ptr<Lightning>> & getLightnings();
 		void setGridAxis(int gridDim);
 		void setActiveCamera(int index);
@@ -52,12 +61,21 @@ class Scene
 		Camera& getActiveCamera();
 		std::string & getName();
 		void draw(Shader & shader, Graphics& graphics, DRAW_TYPE drawType, float delta, DRAWING_MODE mode = DRAWING_MODE::SOLID, bool debug = false);
+		void drawOrderIndependent(Shader & shader, DRAWING_MODE mode = DRAWING_MODE::SOLID);
+		void cullOccluded();
+		bool isOccluded(int objectIndex);
+		void updateImpostors(Graphics & graphics);
+		bool isImpostor(int objectIndex);
+		ShadowCasters getShadowCasters(const std::function<bool(const BoundingSphere &)> & test);
+		ShadowCasters getShadowCasters(const ShadowCasters & candidates, const std::function<bool(const BoundingSphere &)> & test);
+		void drawShadowCasters(Shader & shader, const ShadowCasters & casters, CASTER_TYPE type = CASTER_TYPE::ALL, DRAWING_MODE mode = DRAWING_MODE::SOLID);
 		std::vector<std::shared_ptr<PointLight>> & getPLights();
 		std::vector<std::shared_ptr<DirectionalLight>> & getDLights();
 		std::vector<std::shared_ptr<SpotLight>> & getSLights();
 		std::vector<std::shared_ptr<Object>>& getObjects();
 		std::shared_ptr<Character> getCharacter();
 		std::vector<std::shared_ptr<Vehicle>> & getVehicles();
+		std::vector<std::shared_ptr<Crowd>> & getCrowds();
 
 		// sound management
 		void addAudioFile(std::string file);
@@ -66,13 +84,35 @@ class Scene
 		void stopSound(int source_index, int audio_index);
 		Source& getSoundSource(int index);
 
-    public:
-        static inline glm::vec3 sortCamPos;
-    private:
-        static int sortTransparentMesh(const void * a, const void * b);
-
 	private:
 
+		struct TransparentDraw
+		{
+			Mesh * mesh;
+			int object;
+			std::uint16_t key; // quantized view space depth, farthest first
+		};
+
+		struct OpaqueDraw
+		{
+			std::shared_ptr<Mesh> mesh;
+			int object;
+			int batch; // same file and mesh index across objects, -1 if never batched
+		};
+
+		struct ImpostorSplit
+		{
+			bool active; // part of the instances are drawn as impostors this frame
+			std::vector<glm::mat4> near; // the others, still drawn with geometry
+			long offset; // near models in the ring buffer, -1 when it was full
+		};
+
+		void sortTransparentMeshes(Camera & cam, bool skipOrderIndependent);
+		void drawOpaqueBatched(Shader & shader, struct IBL_DATA * iblData, DRAWING_MODE mode);
+		void drawSplit(int objectIndex, Mesh & mesh, Shader & shader, struct IBL_DATA * iblData, DRAWING_MODE mode);
+		void drawImpostors(Shader & shader, Graphics & graphics);
+
+
 		int ID;
 		std::string name;
 
@@ -80,10 +120,19 @@ class Scene
 		std::vector<Camera> cameras;
 
 		std::vector<std::shared_ptr<Object>> objects;
-		std::vector<std::pair<std::shared_ptr<Mesh>, int>> opaqueMesh;
-		std::vector<std::pair<std::shared_ptr<Mesh>, int>> transparentMesh;
+		std::vector<OpaqueDraw> opaqueMesh;
+		std::map<std::pair<std::string, int>, int> batchIds;
+		std::vector<std::vector<glm::mat4>> batchModels; // visible members of each batch, refilled every frame
+		std::vector<int> batchFirst; // first opaque draw of each batch, draws the whole batch
+		std::vector<TransparentDraw> transparentMesh;
+		std::vector<TransparentDraw> transparentScratch;
+		OcclusionBuffer occlusion;
+		std::vector<char> occluded; // per object, refreshed once per frame
+		std::map<std::string, std::shared_ptr<Impostor>> impostors; // one per file, shared by the objects loaded from it
+		std::vector<ImpostorSplit> impostorSplit; // per object, refreshed once per frame
 		std::shared_ptr<Character> character;
 		std::vector<std::shared_ptr<Vehicle>> vehicles;
+		std::vector<std::shared_ptr<Crowd>> crowds;
 		Audio audio; // collection of audio files
 		std::vector<Source> sound_source; // collection of sound emitters
 
@@ -6,13 +6,18 @@
 #include <string>
 #include <vector>
 #include <fstream>
+#include <sstream>
+#include <iterator>
 #include <memory>
 #include <utility>
+#include <unordered_map>
 #include <glm/glm.hpp>
 #include <glm/gtc/matrix_transform.hpp>
 #include <glm/gtc/type_ptr.hpp>
 #include <assimp/scene.h>
 #include <cstdio>
+#include <cmath>
+#include <limits>
 #include <string.h>
 
 class Light;
@@ -36,9 +41,21 @@ enum class SHADER_TYPE
     TEXT,
 	COMPOSITING,
 	MOUSE,
+	IMPOSTOR,
 	FINAL
 };
 
+// material permutations : one #define per bit, chosen per mesh when it is loaded
+#define MATERIAL_DIFFUSE_MAP 1
+#define MATERIAL_SPECULAR_MAP 2
+#define MATERIAL_NORMAL_MAP 4
+#define MATERIAL_METALLIC_ROUGH_MAP 8
+#define MATERIAL_EMISSION_MAP 16
+#define MATERIAL_ALPHA_TEST 32
+#define MATERIAL_SKINNED 64
+#define MATERIAL_CROWD 128
+#define MATERIAL_DITHER_FADE 256
+
 class Shader
 {
 	public:
@@ -46,6 +63,7 @@ class Shader
 		Shader(const std::string & vertex_shader_file, const std::string & fragment_shader_file, SHADER_TYPE t = SHADER_TYPE::BLINN_PHONG);
 		Shader(const std::string & vertex_shader_file, const std::string & geometry_shader_file, const std::string & fragment_shader_file, SHADER_TYPE t = SHADER_TYPE::BLINN_PHONG);
 		Shader(const std::string & compute_shader_file, SHADER_TYPE t = SHADER_TYPE::COMPUTE);
+		Shader(const std::string & vertex_shader_file, const std::string & fragment_shader_file, const std::vector<std::string> & defines, SHADER_TYPE t);
 		~Shader();
 		GLuint getId() const;
 		SHADER_TYPE getType();
@@ -54,20 +72,52 @@ class Shader
 		void setBool(const std::string & name, bool v) const;
 		void setVec2f(const std::string & name, glm::vec2 v) const;
 		void setVec3f(const std::string & name, glm::vec3 v) const;
+		void setVec3i(const std::string & name, glm::ivec3 v) const;
 		void setVec4f(const std::string & name, glm::vec4 v) const;
 		void setMatrix(const std::string & name, glm::mat4 m) const;
+		void setDrawMatrix(const std::string & name, glm::mat4 m) const; // only reaches the program picked by getVariant
 		void setLighting(std::vector<std::shared_ptr<PointLight>> & pLights, std::vector<std::shared_ptr<DirectionalLight>> & dLights, std::vector<std::shared_ptr<SpotLight>> & sLight);
 		void use() const;
         void dispatch(int blocks_x, int blocks_y, int blocks_z, GLbitfield barriers);
+		Shader & getVariant(int permutation);
 
 	private:
 
 		void compile(const char * vertex_shader_code, const char * fragment_shader_code);
 		void compile(const char * vertex_shader_code, const char * geometry_shader_code, const char * fragment_shader_code);
 		void compile(const char * compute_shader_code);
+		static std::string addDefines(const std::string & code, const std::vector<std::string> & defines);
+		static std::string addIncludes(const std::string & code);
+		static void setSource(GLuint shader, const char * code);
+		static void copyUniforms(GLuint from, GLuint to);
+		GLint getLocation(const std::string & name) const;
+
+		template<typename F>
+		void forEachProgram(const std::string & name, F f) const
+		{
+			// uniforms set on the base program reach every compiled permutation
+			f(id, getLocation(name));
+			if(variants)
+			{
+				for(auto & variant : variants->programs)
+					f(variant.second->id, variant.second->getLocation(name));
+			}
+		}
+
+		struct Variants
+		{
+			std::string vertex;
+			std::string fragment;
+			std::unordered_map<int, std::unique_ptr<Shader>> programs;
+			std::vector<std::pair<std::string, glm::mat4>> drawMatrices; // per draw, written lazily to the drawing program
+			unsigned long drawStamp; // bumped by every setDrawMatrix
+		};
 
 		GLuint id;
 		SHADER_TYPE type;
+		std::shared_ptr<Variants> variants; // shared by copies, vertex + fragment programs only
+		mutable std::unordered_map<std::string, GLint> locations; // glGetUniformLocation cache of this program
+		unsigned long drawStamp; // draw matrices last written to this program
 };
 
 enum class TEXTURE_TYPE
@@ -97,7 +147,9 @@ struct Texture
 
 struct Material
 {
+    int permutation; // MATERIAL_* bits
     int opaque;
+	int orderIndependent; // transparent, blended without sorting when OIT is on
 	float opacity;
     glm::vec3 color_diffuse;
 	glm::vec3 color_specular;
@@ -107,6 +159,8 @@ struct Material
 	float roughness;
 	float metallic;
 	float emission_intensity;
+	glm::vec3 fadeCenter; // impostor cross-fade, read with MATERIAL_DITHER_FADE
+	glm::vec2 fadeRange;
 	std::vector<Texture> textures; // [0] = diffuse, [1] = specular, [2] = normal, [3] = metallicRough, [4] = emissive
 };
 
@@ -195,6 +249,7 @@ class PointLight : public Light
 		float getKc();
 		float getKl();
 		float getKq();
+		float getRange();
 		virtual LIGHT_TYPE getType() override;
 
 		static constexpr float attenuation[12][4] =
@@ -252,6 +307,7 @@ class SpotLight : public Light
 		void setDirection(glm::vec3 dir);
 		float getCutOff();
 		float getOuterCutOff();
+		float getRange();
 		virtual LIGHT_TYPE getType() override;
 
 	private:
@@ -0,0 +1,36 @@
+#ifndef SHADOW_ATLAS_HPP
+#define SHADOW_ATLAS_HPP
+
+#include <vector>
+#include <algorithm>
+#include <numeric>
+#include <iostream>
+#include <glm/glm.hpp>
+
+// Shelf packer for square shadow maps inside a single depth texture.
+// When only some requested sizes change, the other regions stay in place and
+// the changed maps go in the free space, everything is repacked only if they do not fit.
+class ShadowAtlas
+{
+	public:
+
+		ShadowAtlas(int atlasSize, int minSize);
+		bool update(const std::vector<int> & sizes);
+		glm::ivec3 getRegion(int index); // x, y, size in texels (size 0 => no room left)
+		glm::vec4 getUVRegion(int index); // offset and scale in texture space
+		int getSize();
+		int getCount();
+
+	private:
+
+		bool pack(const std::vector<int> & sizes);
+		bool reallocate(const std::vector<int> & previous);
+		bool isFree(glm::ivec3 region, int index);
+
+		int size;
+		int minSize;
+		std::vector<int> requested;
+		std::vector<glm::ivec3> regions;
+};
+
+#endif
@@ -0,0 +1,29 @@
+#ifndef SHADOW_CASTERS_HPP
+#define SHADOW_CASTERS_HPP
+
+#include <vector>
+#include <utility>
+#include <cstddef>
+#include <glm/glm.hpp>
+
+struct ShadowCasters
+{
+	std::vector<int> staticObjects;
+	std::vector<int> dynamicObjects;
+	bool character;
+	std::vector<int> crowds;
+	std::size_t staticKey; // changes when a static caster enters, leaves or moves
+};
+
+enum class CASTER_TYPE
+{
+	STATIC,
+	DYNAMIC,
+	ALL
+};
+
+// casters redrawn every frame over a cached shadow map : dynamic objects, the character and crowds
+bool hasDynamicCasters(const ShadowCasters & casters);
+bool hasDynamicCasters(const std::vector<std::pair<glm::mat4, ShadowCasters>> & faces);
+
+#endif
@@ -12,8 +12,10 @@
 #include <map>
 #include <vector>
 #include <array>
+#include <algorithm>
 #include <exception>
 #include "shader_light.hpp"
+#include "ringBuffer.hpp"
 
 
 struct Glyph
@@ -44,7 +46,6 @@ private:
     std::vector<std::pair<std::string, Alphabet>> police;
     int activePoliceIndex;
     GLuint vao;
-    GLuint vbo;
     Shader shader;
     glm::mat4 projection;
 };
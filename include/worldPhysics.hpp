@@ -34,6 +34,7 @@ class btDebugDraw : public btIDebugDraw
 {
 	public:
 		btDebugDraw();
+		~btDebugDraw();
 		void drawLine(const btVector3 & from, const btVector3 & to, const btVector3 & color);
 		void drawContactPoint(const btVector3 & PointOnB, const btVector3 & normalOnB, btScalar distance, int lifeTime, const btVector3 & color);
 		void reportErrorWarning(const char * warningString);
@@ -44,7 +45,10 @@ class btDebugDraw : public btIDebugDraw
 		void setProjectionMatrix(glm::mat4 & m);
 
 	private:
+		void streamDraw(const float * points, int count, GLenum primitive, const btVector3 & color);
+
 		int mode;
+		GLuint vao;
 		Shader shader;
 		glm::mat4 view;
 		glm::mat4 projection;
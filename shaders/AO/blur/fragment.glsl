@@ -2,22 +2,45 @@
 
 out vec4 fragColor;
 
-uniform sampler2D aoInput;
+uniform sampler2D aoInput; // low resolution
+uniform sampler2D normalDepth; // low resolution, linear depth in alpha
+uniform sampler2D depthBuffer; // full resolution hardware depth
+uniform mat4 invProjection;
+uniform vec2 renderScale; // rendered part of the full size targets
 
 in vec2 texCoords;
 
 void main()
 {
+	// full resolution linear depth of this pixel
+	vec4 view = invProjection * vec4(vec3(texCoords / renderScale, texture(depthBuffer, texCoords).r) * 2.0f - 1.0f, 1.0f);
+	float depth = -view.z / view.w;
+
+	// 4x4 low resolution taps (the noise period), weighted by depth similarity
 	vec2 texelSize = 1.0f / vec2(textureSize(aoInput, 0));
+	vec2 origin = (floor(texCoords / texelSize - 0.5f) + 0.5f) * texelSize;
 	float result = 0.0f;
-
-	for(int x = -2; x < 2; ++x)
+	float weights = 0.0f;
+	float closest = 1e30f;
+	float closestAO = 1.0f;
+	for(int x = -1; x < 3; ++x)
 	{
-		for(int y = -2; y < 2; ++y)
+		for(int y = -1; y < 3; ++y)
 		{
-			vec2 offset = vec2(float(x), float(y)) * texelSize;
-			result += texture(aoInput, texCoords + offset).r;
+			vec2 uv = origin + vec2(float(x), float(y)) * texelSize;
+			float ao = texture(aoInput, uv).r;
+			float difference = abs(texture(normalDepth, uv).a - depth);
+			float weight = exp(-difference * difference / (0.0025f * depth * depth + 1e-4f));
+			result += ao * weight;
+			weights += weight;
+			if(difference < closest)
+			{
+				closest = difference;
+				closestAO = ao;
+			}
 		}
 	}
-	fragColor = vec4(vec3(result / 16.0f), 1.0f);
+
+	// no tap on the same surface : nearest depth wins instead of a halo
+	fragColor = vec4(vec3((weights > 1e-3f) ? result / weights : closestAO), 1.0f);
 }
@@ -0,0 +1,48 @@
+#version 460 core
+
+out vec4 fragColor;
+
+uniform sampler2D depthBuffer;
+uniform sampler2D normalBuffer; // octahedral, view space
+uniform mat4 invProjection;
+uniform int downSample;
+uniform vec2 renderScale; // rendered part of the full size targets
+
+in vec2 texCoords;
+
+vec3 decodeNormal(vec2 e)
+{
+	e = e * 2.0f - 1.0f;
+	vec3 n = vec3(e, 1.0f - abs(e.x) - abs(e.y));
+	float t = clamp(-n.z, 0.0f, 1.0f);
+	n.xy += vec2(n.x >= 0.0f ? -t : t, n.y >= 0.0f ? -t : t);
+	return normalize(n);
+}
+
+void main()
+{
+	// nearest of the full resolution texels covered by this one, never blends across an edge
+	ivec2 fullSize = textureSize(depthBuffer, 0);
+	ivec2 renderSize = ivec2(vec2(fullSize) * renderScale + 0.5f);
+	ivec2 base = ivec2(gl_FragCoord.xy) * downSample;
+	ivec2 texel = base;
+	float depth = 1.0f;
+	for(int y = 0; y < downSample; ++y)
+	{
+		for(int x = 0; x < downSample; ++x)
+		{
+			ivec2 t = min(base + ivec2(x, y), renderSize - 1);
+			float d = texelFetch(depthBuffer, t, 0).r;
+			if(d < depth)
+			{
+				depth = d;
+				texel = t;
+			}
+		}
+	}
+
+	// view normal and positive linear depth
+	vec2 uv = (vec2(texel) + 0.5f) / vec2(renderSize);
+	vec4 view = invProjection * vec4(vec3(uv, depth) * 2.0f - 1.0f, 1.0f);
+	fragColor = vec4(decodeNormal(texelFetch(normalBuffer, texel, 0).rg), -view.z / view.w);
+}
@@ -4,28 +4,41 @@ out vec4 fragColor;
 
 const int MAX_KERNEL_SIZE = 128;
 
-uniform sampler2D positionBuffer;
-uniform sampler2D normalBuffer;
-uniform sampler2D noiseTexture;
+// low resolution view normal (rgb) and positive linear depth (a)
+uniform sampler2D normalDepth;
+
+layout (std140, binding = 3) uniform AOKernel
+{
+	vec4 samples[MAX_KERNEL_SIZE];
+};
 
 uniform float radius;
 uniform float bias;
 uniform int kernelSize;
-uniform vec3 samples[MAX_KERNEL_SIZE];
 uniform mat4 projection;
-
-uniform float screenWidth;
-uniform float screenHeight;
+uniform mat4 invProjection;
+uniform vec2 renderScale; // rendered part of the full size targets
 
 in vec2 texCoords;
 
-void main()
+vec3 viewPosition(vec2 uv, float linearDepth)
 {
-	const vec2 noiseScale = vec2(screenWidth / 4.0f, screenHeight / 4.0f);
+	// point on the view ray through uv, scaled to the stored depth
+	vec4 ray = invProjection * vec4(uv * 2.0f - 1.0f, 1.0f, 1.0f);
+	ray.xyz /= ray.w;
+	return ray.xyz * (linearDepth / -ray.z);
+}
+
+// 4x4 pixel blocks cover the rotations evenly, removed by the upsample blur
+#include "noise.glsl"
 
-	vec3 fragPos = texture(positionBuffer, texCoords).xyz;
-	vec3 normal = texture(normalBuffer, texCoords).xyz;
-	vec3 randomVec = texture(noiseTexture, texCoords * noiseScale).xyz;
+void main()
+{
+	vec4 center = texture(normalDepth, texCoords);
+	vec3 fragPos = viewPosition(texCoords / renderScale, center.a);
+	vec3 normal = center.rgb;
+	float angle = 6.28318530718f * interleavedGradientNoise(gl_FragCoord.xy);
+	vec3 randomVec = vec3(cos(angle), sin(angle), 0.0f);
 
 	vec3 tangent = normalize(randomVec - normal * dot(randomVec, normal));
 	vec3 bitangent = cross(normal, tangent);
@@ -35,7 +48,7 @@ void main()
 	for(int i = 0; i < kernelSize; ++i)
 	{
 		// get sample position
-		vec3 samplePos = TBN * samples[i]; // from tangent to view-space
+		vec3 samplePos = TBN * samples[i].xyz; // from tangent to view-space
 		samplePos = fragPos + samplePos * radius;
 
 		vec4 offset = vec4(samplePos, 1.0f);
@@ -43,7 +56,7 @@ void main()
 		offset.xyz /= offset.w;
 		offset.xyz = offset.xyz * 0.5f + 0.5f;
 
-		float sampleDepth = texture(positionBuffer, offset.xy).z;
+		float sampleDepth = -texture(normalDepth, clamp(offset.xy, 0.0f, 1.0f) * renderScale).a;
 
 		float rangeCheck = smoothstep(0.0f, 1.0f, radius / abs(fragPos.z - sampleDepth));
 		occlusion += ((sampleDepth >= samplePos.z + bias) ? 1.0f : 0.0f) * rangeCheck;
@@ -1,21 +1,105 @@
 #version 460 core
 
-layout (location = 0) out vec4 fragPosView;
-layout (location = 1) out vec4 fragNormal;
-layout (location = 2) out vec4 fragDepth;
-layout (location = 3) out vec4 fragPosWorld;
+// positions are rebuilt from the depth buffer
+layout (location = 0) out vec2 fragNormal; // octahedral
+layout (location = 1) out vec4 fragAlbedo;
+layout (location = 2) out vec2 fragMetallicRough;
+layout (location = 3) out vec3 fragEmission;
+
+struct Material
+{
+	vec3 albedo;
+	float metallic;
+	float roughness;
+	float opacity;
+	sampler2D albedoMap;
+	sampler2D metallicRoughMap;
+	sampler2D normalMap;
+	vec3 emissiveColor;
+	float emissionIntensity;
+	sampler2D emissionMap;
+};
 
 in VS_OUT
 {
+	vec2 texCoords;
 	vec3 normal;
 	vec3 fragPosView;
-	vec3 fragPosWorld;
 } fs_in;
 
+uniform Material material;
+uniform int deferred; // material outputs for the deferred lighting pass
+
+vec2 encodeNormal(vec3 n)
+{
+	// octahedral mapping to [0, 1]
+	n /= abs(n.x) + abs(n.y) + abs(n.z);
+	if(n.z < 0.0f)
+		n.xy = (1.0f - abs(n.yx)) * vec2(n.x >= 0.0f ? 1.0f : -1.0f, n.y >= 0.0f ? 1.0f : -1.0f);
+	return n.xy * 0.5f + 0.5f;
+}
+
+vec3 getNormalFromMap()
+{
+	// view space, same derivative frame as the PBR shader
+	vec3 tangentNormal = texture(material.normalMap, fs_in.texCoords).xyz * 2.0 - 1.0;
+
+	vec3 Q1 = dFdx(fs_in.fragPosView);
+	vec3 Q2 = dFdy(fs_in.fragPosView);
+	vec2 st1 = dFdx(fs_in.texCoords);
+	vec2 st2 = dFdy(fs_in.texCoords);
+
+	vec3 N = normalize(fs_in.normal);
+	vec3 T = normalize(Q1*st2.t - Q2*st1.t);
+	vec3 B = -normalize(cross(N, T));
+
+	return normalize(mat3(T, B, N) * tangentNormal);
+}
+
+#ifdef DITHER_FADE
+flat in float fade;
+
+#include "noise.glsl"
+#endif
+
 void main()
 {
-	fragPosView = vec4(fs_in.fragPosView, 1.0f);
-	fragNormal = vec4(normalize(fs_in.normal), 1.0f);
-	fragDepth = vec4(vec3(gl_FragCoord.z), 1.0f);
-	fragPosWorld = vec4(fs_in.fragPosWorld, 1.0f);
+#ifdef DITHER_FADE
+	// complementary to the impostor dither, the two never cover the same pixel
+	if(interleavedGradientNoise(gl_FragCoord.xy) < fade)
+		discard;
+#endif
+
+	vec3 normal = normalize(fs_in.normal);
+	if(deferred == 1)
+	{
+#ifdef DIFFUSE_MAP
+		vec4 albedoSample = texture(material.albedoMap, fs_in.texCoords);
+#ifdef ALPHA_TEST
+		if(albedoSample.a == 0.0f)
+			discard;
+#endif
+		fragAlbedo = vec4(pow(albedoSample.rgb, vec3(2.2f)), 1.0f);
+#else
+		fragAlbedo = vec4(material.albedo, 1.0f);
+#endif
+
+#ifdef METALLIC_ROUGH_MAP
+		fragMetallicRough = texture(material.metallicRoughMap, fs_in.texCoords).bg;
+#else
+		fragMetallicRough = vec2(material.metallic, material.roughness);
+#endif
+
+		vec3 emission = material.emissiveColor;
+#ifdef EMISSION_MAP
+		emission = texture(material.emissionMap, fs_in.texCoords).rgb;
+#endif
+		fragEmission = emission * material.emissionIntensity;
+
+#ifdef NORMAL_MAP
+		normal = getNormalFromMap();
+#endif
+	}
+
+	fragNormal = encodeNormal(normal);
 }
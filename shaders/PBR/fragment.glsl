@@ -5,16 +5,21 @@ layout (location = 1) out vec4 brightColor;
 
 struct Light
 {
-	int type; // 0 => point, 1 => directional, 2 => spot
+	mat4 lightSpaceMatrix;
+	vec4 atlasRegion; // xy offset, zw scale in the shadow atlas
 	vec3 position;
+	int type; // 0 => point, 1 => directional, 2 => spot
 	vec3 direction;
 	float cutOff;
+	vec3 ambientStrength;
 	float outerCutOff;
+	vec3 diffuseStrength;
 	float kc;
+	vec3 specularStrength;
 	float kl;
 	float kq;
-	vec3 color;
-	mat4 lightSpaceMatrix;
+	int shadowLayer; // layer in the omni shadow cube map array, -1 without shadow
+	float range;
 };
 
 struct Material
@@ -24,16 +29,11 @@ struct Material
 	float roughness;
 	float opacity;
 	sampler2D albedoMap;
-	int hasAlbedo;
 	sampler2D metallicRoughMap;
-	int hasMetallicRough;
 	sampler2D normalMap;
-	int hasNormal;
 	vec3 emissiveColor;
 	float emissionIntensity;
 	sampler2D emissionMap;
-	int hasEmission;
-	int nbTextures;
 };
 
 struct Camera
@@ -53,16 +53,22 @@ in VS_OUT
 uniform Camera cam;
 
 uniform int shadowOn;
-uniform int lightCount;
-uniform Light light[10];
-uniform sampler2D depthMap[10];
-uniform samplerCube omniDepthMap[10];
-uniform int pointLightCount;
+uniform sampler2D shadowAtlas;
+uniform samplerCubeArray omniShadowMaps;
+
+// clustered lights, lightGrid holds (first, count) into lightIndex per cluster
+layout (std430, binding = 0) readonly buffer LightBuffer { Light light[]; };
+layout (std430, binding = 1) readonly buffer LightGrid { uvec2 lightGrid[]; };
+layout (std430, binding = 2) readonly buffer LightIndexList { uint lightIndex[]; };
+uniform ivec3 clusterGrid;
+uniform vec2 clusterDepth; // near, far
+uniform mat4 view;
 
 uniform Material material;
 uniform sampler2D ssao;
 uniform int hasSSAO;
 uniform vec2 viewport;
+uniform int oitPass; // accumulation + revealage outputs
 
 uniform int IBL;
 uniform samplerCube irradianceMap;
@@ -137,7 +143,7 @@ vec3 fresnelSchlickRoughness(float cosTheta, vec3 F0, float roughness)
 float calculateShadow(vec4 fragPosLightSpace, vec3 lightDir, int l)
 {
 	float shadow = 0.0;
-	vec2 texelSize = 1.0 / textureSize(depthMap[l - pointLightCount], 0);
+	vec2 texelSize = 1.0 / textureSize(shadowAtlas, 0);
 	float bias = max(0.005 * (1.0 - dot(fs_in.normal, -lightDir)), 0.0005);
 
 	// perform perspective divide
@@ -145,7 +151,8 @@ float calculateShadow(vec4 fragPosLightSpace, vec3 lightDir, int l)
 	
 	// transform to [0,1] range
 	projCoords = (projCoords * 0.5) + 0.5;
-	if(projCoords.z > 1.0)
+	vec4 region = light[l].atlasRegion;
+	if(projCoords.z > 1.0 || region.z == 0.0 || any(lessThan(projCoords.xy, vec2(0.0))) || any(greaterThan(projCoords.xy, vec2(1.0))))
 	{
 		shadow = 0.0;
 		return shadow;
@@ -153,12 +160,14 @@ float calculateShadow(vec4 fragPosLightSpace, vec3 lightDir, int l)
 
 	// get depth of current fragment from light's perspective
 	float currentDepth = projCoords.z;
+	vec2 regionMin = region.xy + texelSize * 0.5;
+	vec2 regionMax = region.xy + region.zw - texelSize * 0.5;
 	
 	for(int x = -1; x <= 1; ++x)
 	{
 		for(int y = -1; y <= 1; ++y)
 		{
-			float depth = texture(depthMap[l - pointLightCount], projCoords.xy + vec2(x, y) * texelSize).r;
+			float depth = texture(shadowAtlas, clamp(region.xy + projCoords.xy * region.zw + vec2(x, y) * texelSize, regionMin, regionMax)).r;
 			shadow += (currentDepth - bias) > depth ? 1.0 : 0.0;
 		}
 	}
@@ -183,12 +192,15 @@ float calculateOmniShadow(vec3 fragPos, vec3 lightPos, int l)
 	float viewDistance = length(cam.viewPos - fragPos);
 	float diskRadius = (1.0 + (viewDistance / 100.0f)) / 25.0;
 	
+	if(light[l].shadowLayer < 0)
+		return 0.0;
+
 	vec3 distFragLight = fragPos - lightPos;
 	float currentDepth = length(distFragLight);
 	
 	for(int i = 0; i < samples; ++i)
 	{
-		float closestDepth = texture(omniDepthMap[l], distFragLight + sampleOffsetDirections[i] * diskRadius).r;
+		float closestDepth = texture(omniShadowMaps, vec4(distFragLight + sampleOffsetDirections[i] * diskRadius, light[l].shadowLayer)).r;
 		closestDepth *= 100.0f;
 		if(currentDepth - bias > closestDepth)
 			shadow += 1.0f;
@@ -199,43 +211,64 @@ float calculateOmniShadow(vec3 fragPos, vec3 lightPos, int l)
 	return shadow;
 }
 // ----------------------------------------------------------------------------
+uint clusterIndex()
+{
+	// screen tile, then exponential view depth slice
+	float depth = clamp(-(view * vec4(fs_in.fragPos, 1.0f)).z, clusterDepth.x, clusterDepth.y);
+	int slice = min(int(log(depth / clusterDepth.x) / log(clusterDepth.y / clusterDepth.x) * clusterGrid.z), clusterGrid.z - 1);
+	ivec2 tile = min(ivec2(gl_FragCoord.xy / viewport * vec2(clusterGrid.xy)), clusterGrid.xy - 1);
+	return uint((slice * clusterGrid.y + tile.y) * clusterGrid.x + tile.x);
+}
+
+#ifdef DITHER_FADE
+flat in float fade;
+
+#include "noise.glsl"
+#endif
+
+#include "oit.glsl"
+
 void main()
 {
+#ifdef DITHER_FADE
+	// complementary to the impostor dither, the two never cover the same pixel
+	if(interleavedGradientNoise(gl_FragCoord.xy) < fade)
+		discard;
+#endif
+
 	// early discard
 	if(material.opacity == 0.0f)
 		discard;
-	if(material.nbTextures > 0)
-	{
-		if(texture(material.albedoMap, fs_in.texCoords).a == 0.0f)
-			discard;
-	}
 
-	vec3 albedo;
-	float metallic;
-	float roughness;
-	vec2 fragCoords = gl_FragCoord.xy / viewport;
+	// material inputs, the branches are resolved by the permutation defines
+#ifdef DIFFUSE_MAP
+	vec4 albedoSample = texture(material.albedoMap, fs_in.texCoords);
+#ifdef ALPHA_TEST
+	if(albedoSample.a == 0.0f)
+		discard;
+#endif
+	vec3 albedo = pow(albedoSample.rgb, vec3(2.2f));
+	float alpha = albedoSample.a * material.opacity;
+#else
+	vec3 albedo = material.albedo;
+	float alpha = material.opacity;
+#endif
+#ifdef METALLIC_ROUGH_MAP
+	vec2 metallicRough = texture(material.metallicRoughMap, fs_in.texCoords).bg;
+	float metallic = metallicRough.x;
+	float roughness = metallicRough.y;
+#else
+	float metallic = material.metallic;
+	float roughness = material.roughness;
+#endif
+#ifdef NORMAL_MAP
+	vec3 N = getNormalFromMap();
+#else
+	vec3 N = fs_in.normal;
+#endif
+
+	vec2 fragCoords = gl_FragCoord.xy / vec2(textureSize(ssao, 0)); // full size target, partly rendered
 	float ao = (hasSSAO == 1) ? texture(ssao, fragCoords).r : 1.0f;
-	float alpha = (material.hasAlbedo == 1) ? texture(material.albedoMap, fs_in.texCoords).a * material.opacity : material.opacity;
-	if(material.hasAlbedo == 1)
-    	albedo = pow(texture(material.albedoMap, fs_in.texCoords).rgb, vec3(2.2f));
-	else
-		albedo = material.albedo;
-	if(material.hasMetallicRough == 1)
-	{
-    	metallic = texture(material.metallicRoughMap, fs_in.texCoords).b;
-    	roughness = texture(material.metallicRoughMap, fs_in.texCoords).g;
-	}
-	else
-	{
-		metallic = material.metallic;
-		roughness = material.roughness;
-	}
-
-	vec3 N;
-	if(material.hasNormal == 1)
-    	N = getNormalFromMap();
-	else
-		N = fs_in.normal;
     vec3 V = normalize(cam.viewPos - fs_in.fragPos);
 
     // calculate reflectance at normal incidence; if dia-electric (like plastic) use F0 
@@ -245,8 +278,11 @@ void main()
 
     // reflectance equation
     vec3 Lo = vec3(0.0);
-    for(int i = 0; i < lightCount; ++i) 
+    uvec2 cluster = lightGrid[clusterIndex()];
+    for(uint n = 0; n < cluster.y; ++n)
     {
+		int i = int(lightIndex[cluster.x + n]);
+
 		// calculate per-light radiance
         vec3 L = normalize(light[i].position - fs_in.fragPos);
         vec3 H = normalize(V + L);
@@ -258,7 +294,7 @@ void main()
 			attenuation = 1.0f / (distance * distance);
 		else
 			attenuation = 1.0f;
-        vec3 radiance = light[i].color * attenuation;
+        vec3 radiance = light[i].diffuseStrength * attenuation;
 
         // Cook-Torrance BRDF
         float NDF = DistributionGGX(N, H, roughness);   
@@ -340,8 +376,9 @@ void main()
 
 	// get brightness
 	vec3 emission = material.emissiveColor;
-	if(material.hasEmission == 1)
-		emission = texture(material.emissionMap, fs_in.texCoords).rgb;
+#ifdef EMISSION_MAP
+	emission = texture(material.emissionMap, fs_in.texCoords).rgb;
+#endif
 	emission *= material.emissionIntensity;
 	float brightness = dot(fragColor.rgb + emission, vec3(0.2126f, 0.7152f, 0.0722f));
 
@@ -354,4 +391,12 @@ void main()
 	}
 	else
 		brightColor = vec4(0.0f, 0.0f, 0.0f, 1.0f);
+
+	// weighted blended order independent transparency
+	if(oitPass == 1)
+	{
+		float weight = oitWeight(alpha, gl_FragCoord.z);
+		fragColor = vec4(fragColor.rgb * alpha, alpha) * weight;
+		brightColor = vec4(alpha);
+	}
 }
@@ -24,11 +24,30 @@ uniform mat4 proj;
 
 uniform bool instancing;
 
+#ifdef DITHER_FADE
+uniform vec3 fadeCenter; // object space
+uniform vec2 fadeRange; // distances where the geometry starts and ends fading to its impostor
+flat out float fade;
+#endif
+
 //#################### ANIMATION DATA ####################
-uniform int animated;
-const int MAX_BONES = 50;
 const int MAX_BONE_INFLUENCE = 4;
-uniform mat4 bonesMatrices[MAX_BONES];
+layout (std430, binding = 4) readonly buffer BonePalette { mat4 bonesMatrices[]; }; // one range per skeleton
+#ifdef CROWD
+uniform sampler2D animationTexture; // baked clips, 3 texels per joint, one row per frame
+uniform float crowdTime;
+uniform float bakeRate; // baked frames per second
+layout (std430, binding = 5) readonly buffer CrowdInstances { vec4 crowdInstance[]; }; // first row, frame count, time offset, playback rate
+
+mat4 crowdJoint(int joint, int row)
+{
+	// rows of the affine joint matrix
+	vec4 r0 = texelFetch(animationTexture, ivec2(3 * joint, row), 0);
+	vec4 r1 = texelFetch(animationTexture, ivec2(3 * joint + 1, row), 0);
+	vec4 r2 = texelFetch(animationTexture, ivec2(3 * joint + 2, row), 0);
+	return transpose(mat4(r0, r1, r2, vec4(0.0f, 0.0f, 0.0f, 1.0f)));
+}
+#endif
 //########################################################
 
 void main()
@@ -36,16 +55,29 @@ void main()
 	vs_out.texCoords = aTex;
 	vec4 position = vec4(aPos, 1.0f);
 	vec4 normal = vec4(aNorm, 0.0f);
-	if(animated == 1)
+#ifdef SKINNED
+	mat4 boneTransform = mat4(0.0f);
+	for(int i = 0; i < MAX_BONE_INFLUENCE; ++i)
 	{
-		mat4 boneTransform = mat4(0.0f);
-		for(int i = 0; i < MAX_BONE_INFLUENCE; ++i)
-		{
-			boneTransform += bonesMatrices[boneID[i]] * boneWeight[i];
-		}
-		position = boneTransform * vec4(aPos, 1.0f);
-		normal = boneTransform * vec4(aNorm, 0.0f);
+		boneTransform += bonesMatrices[boneID[i]] * boneWeight[i];
 	}
+	position = boneTransform * vec4(aPos, 1.0f);
+	normal = boneTransform * vec4(aNorm, 0.0f);
+#endif
+#ifdef CROWD
+	// clip, time offset and rate of this instance, blended between the two nearest baked frames
+	vec4 instance = crowdInstance[gl_InstanceID];
+	float frame = mod((crowdTime * instance.w + instance.z) * bakeRate, instance.y);
+	int row = int(instance.x) + int(frame);
+	int nextRow = int(instance.x) + (int(frame) + 1) % int(instance.y);
+	mat4 crowdTransform = mat4(0.0f);
+	for(int i = 0; i < MAX_BONE_INFLUENCE; ++i)
+	{
+		crowdTransform += mix(crowdJoint(boneID[i], row), crowdJoint(boneID[i], nextRow), fract(frame)) * boneWeight[i];
+	}
+	position = crowdTransform * vec4(aPos, 1.0f);
+	normal = crowdTransform * vec4(aNorm, 0.0f);
+#endif
 
 	if(instancing)
 	{
@@ -61,4 +93,10 @@ void main()
 	}
 	vs_out.viewMatrix = view;
 	vs_out.projMatrix = proj;
+
+#ifdef DITHER_FADE
+	// cross-fade from the distance of the object (or instance) center to the eye
+	vec3 fadePosition = vec3(((instancing) ? instanceModel : model) * vec4(fadeCenter, 1.0f));
+	fade = clamp((distance(fadePosition, vec3(inverse(view)[3])) - fadeRange.x) / (fadeRange.y - fadeRange.x), 0.0f, 1.0f);
+#endif
 }
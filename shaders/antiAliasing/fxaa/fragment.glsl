@@ -0,0 +1,134 @@
+#version 460 core
+
+out vec4 color;
+
+in VS_OUT
+{
+	vec2 texCoords;
+} fs_in;
+
+uniform sampler2D scene; // HDR, single sample
+uniform vec2 renderScale; // rendered part of the full size targets
+
+#define EDGE_THRESHOLD_MIN 0.0312f
+#define EDGE_THRESHOLD_MAX 0.125f
+#define SEARCH_STEPS 8
+#define SUBPIXEL_QUALITY 0.75f
+
+vec2 texelSize;
+vec2 maxUV;
+
+// luma of the tone mapped color, edges are found where they will be seen
+float luma(vec2 uv)
+{
+	vec3 c = texture(scene, min(uv, maxUV)).rgb;
+	c = c / (1.0f + c);
+	return sqrt(dot(c, vec3(0.299f, 0.587f, 0.114f)));
+}
+
+void main()
+{
+	texelSize = 1.0f / vec2(textureSize(scene, 0));
+	maxUV = renderScale - 0.5f * texelSize;
+	vec2 uv = fs_in.texCoords;
+	vec4 center = texture(scene, uv);
+
+	// local contrast, flat areas are left untouched
+	float lumaM = luma(uv);
+	float lumaN = luma(uv + vec2(0.0f, texelSize.y));
+	float lumaS = luma(uv - vec2(0.0f, texelSize.y));
+	float lumaE = luma(uv + vec2(texelSize.x, 0.0f));
+	float lumaW = luma(uv - vec2(texelSize.x, 0.0f));
+	float lumaMin = min(lumaM, min(min(lumaN, lumaS), min(lumaE, lumaW)));
+	float lumaMax = max(lumaM, max(max(lumaN, lumaS), max(lumaE, lumaW)));
+	float range = lumaMax - lumaMin;
+	if(range < max(EDGE_THRESHOLD_MIN, lumaMax * EDGE_THRESHOLD_MAX))
+	{
+		color = center;
+		return;
+	}
+
+	float lumaNE = luma(uv + texelSize);
+	float lumaSW = luma(uv - texelSize);
+	float lumaNW = luma(uv + vec2(-texelSize.x, texelSize.y));
+	float lumaSE = luma(uv + vec2(texelSize.x, -texelSize.y));
+
+	// edge orientation
+	float edgeH = abs(lumaNW + lumaNE - 2.0f * lumaN) + 2.0f * abs(lumaW + lumaE - 2.0f * lumaM) + abs(lumaSW + lumaSE - 2.0f * lumaS);
+	float edgeV = abs(lumaNW + lumaSW - 2.0f * lumaW) + 2.0f * abs(lumaN + lumaS - 2.0f * lumaM) + abs(lumaNE + lumaSE - 2.0f * lumaE);
+	bool horizontal = edgeH >= edgeV;
+
+	// side of the pixel the edge lies on
+	float luma1 = (horizontal) ? lumaS : lumaW;
+	float luma2 = (horizontal) ? lumaN : lumaE;
+	float gradient1 = abs(luma1 - lumaM);
+	float gradient2 = abs(luma2 - lumaM);
+	float stepLength = (horizontal) ? texelSize.y : texelSize.x;
+	float lumaLocal;
+	float gradient;
+	if(gradient1 >= gradient2)
+	{
+		stepLength = -stepLength;
+		lumaLocal = 0.5f * (luma1 + lumaM);
+		gradient = 0.25f * gradient1;
+	}
+	else
+	{
+		lumaLocal = 0.5f * (luma2 + lumaM);
+		gradient = 0.25f * gradient2;
+	}
+
+	// walk along the edge in both directions until its end
+	vec2 edgeUV = uv;
+	vec2 offset = (horizontal) ? vec2(texelSize.x, 0.0f) : vec2(0.0f, texelSize.y);
+	if(horizontal)
+		edgeUV.y += 0.5f * stepLength;
+	else
+		edgeUV.x += 0.5f * stepLength;
+
+	vec2 uv1 = edgeUV - offset;
+	vec2 uv2 = edgeUV + offset;
+	float end1 = luma(uv1) - lumaLocal;
+	float end2 = luma(uv2) - lumaLocal;
+	bool reached1 = abs(end1) >= gradient;
+	bool reached2 = abs(end2) >= gradient;
+	for(int i = 1; i < SEARCH_STEPS && !(reached1 && reached2); ++i)
+	{
+		float stride = (i < 4) ? 1.0f : 2.0f;
+		if(!reached1)
+		{
+			uv1 -= offset * stride;
+			end1 = luma(uv1) - lumaLocal;
+			reached1 = abs(end1) >= gradient;
+		}
+		if(!reached2)
+		{
+			uv2 += offset * stride;
+			end2 = luma(uv2) - lumaLocal;
+			reached2 = abs(end2) >= gradient;
+		}
+	}
+
+	// offset toward the nearest end, only when the edge goes the right way there
+	float distance1 = (horizontal) ? uv.x - uv1.x : uv.y - uv1.y;
+	float distance2 = (horizontal) ? uv2.x - uv.x : uv2.y - uv.y;
+	bool nearest1 = distance1 < distance2;
+	float distanceMin = min(distance1, distance2);
+	float edgeLength = distance1 + distance2;
+	bool centerSmaller = lumaM < lumaLocal;
+	bool correctVariation = ((nearest1) ? end1 : end2) < 0.0f != centerSmaller;
+	float pixelOffset = (correctVariation) ? -distanceMin / edgeLength + 0.5f : 0.0f;
+
+	// sub pixel aliasing, thin lines and single pixels
+	float lumaAverage = (2.0f * (lumaN + lumaS + lumaE + lumaW) + lumaNE + lumaNW + lumaSE + lumaSW) / 12.0f;
+	float subPixel = clamp(abs(lumaAverage - lumaM) / range, 0.0f, 1.0f);
+	subPixel = (-2.0f * subPixel + 3.0f) * subPixel * subPixel;
+	pixelOffset = max(pixelOffset, subPixel * subPixel * SUBPIXEL_QUALITY);
+
+	vec2 finalUV = uv;
+	if(horizontal)
+		finalUV.y += pixelOffset * stepLength;
+	else
+		finalUV.x += pixelOffset * stepLength;
+	color = vec4(texture(scene, min(finalUV, maxUV)).rgb, center.a);
+}
@@ -0,0 +1,64 @@
+#version 460 core
+
+out vec4 color;
+
+in VS_OUT
+{
+	vec2 texCoords;
+} fs_in;
+
+uniform sampler2D current; // this frame, jittered projection
+uniform sampler2D history; // resolved previous frames
+uniform sampler2D depthMap;
+uniform mat4 inv_viewProj;
+uniform mat4 prev_viewProj;
+uniform int historyValid;
+uniform float blendFactor; // weight of the current frame
+uniform vec2 renderScale; // rendered part of the full size targets
+
+// tone mapped weights keep bright samples from dominating the neighbourhood
+vec3 compress(vec3 c)
+{
+	return c / (1.0f + max(c.r, max(c.g, c.b)));
+}
+
+vec3 expand(vec3 c)
+{
+	return c / max(1.0f - max(c.r, max(c.g, c.b)), 1e-4f);
+}
+
+void main()
+{
+	vec2 texelSize = 1.0f / vec2(textureSize(current, 0));
+	vec2 maxUV = renderScale - 0.5f * texelSize;
+	vec4 center = texture(current, fs_in.texCoords);
+	vec3 currentColor = compress(center.rgb);
+
+	// neighbourhood bounds, rejects history that no longer matches the scene
+	vec3 minColor = currentColor;
+	vec3 maxColor = currentColor;
+	for(int x = -1; x <= 1; ++x)
+	{
+		for(int y = -1; y <= 1; ++y)
+		{
+			vec3 c = compress(texture(current, min(fs_in.texCoords + vec2(x, y) * texelSize, maxUV)).rgb);
+			minColor = min(minColor, c);
+			maxColor = max(maxColor, c);
+		}
+	}
+
+	// reprojection with last frame camera, same velocity as the motion blur
+	float depth = texture(depthMap, fs_in.texCoords).r;
+	vec4 worldPos = inv_viewProj * vec4(vec3(fs_in.texCoords / renderScale, depth) * 2.0f - 1.0f, 1.0f);
+	vec4 prevPos = prev_viewProj * vec4(worldPos.xyz / worldPos.w, 1.0f);
+	vec2 prevUV = (prevPos.xy / prevPos.w) * 0.5f + 0.5f;
+
+	if(historyValid == 0 || any(lessThan(prevUV, vec2(0.0f))) || any(greaterThan(prevUV, vec2(1.0f))))
+	{
+		color = center;
+		return;
+	}
+
+	vec3 historyColor = clamp(compress(texture(history, min(prevUV * renderScale, maxUV)).rgb), minColor, maxColor);
+	color = vec4(expand(mix(historyColor, currentColor, blendFactor)), center.a);
+}
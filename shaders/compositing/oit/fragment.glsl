@@ -0,0 +1,36 @@
+#version 460 core
+
+out vec4 fragColor;
+
+in vec2 texCoords;
+
+#ifdef MULTISAMPLE
+uniform sampler2DMS accumulation;
+uniform sampler2DMS revealage;
+#else
+uniform sampler2D accumulation;
+uniform sampler2D revealage;
+#endif
+
+void main()
+{
+	// per sample, keeps the multisampled edges of transparent surfaces
+	ivec2 texel = ivec2(gl_FragCoord.xy);
+#ifdef MULTISAMPLE
+	float reveal = texelFetch(revealage, texel, gl_SampleID).r;
+#else
+	float reveal = texelFetch(revealage, texel, 0).r;
+#endif
+	if(reveal == 1.0f)
+		discard;
+
+#ifdef MULTISAMPLE
+	vec4 accum = texelFetch(accumulation, texel, gl_SampleID);
+#else
+	vec4 accum = texelFetch(accumulation, texel, 0);
+#endif
+	vec3 average = accum.rgb / max(accum.a, 1e-5);
+
+	// blended with (1 - alpha, alpha) over the opaque color
+	fragColor = vec4(average, reveal);
+}
@@ -0,0 +1,78 @@
+#version 460 core
+
+// the six bloom levels built by a single dispatch : each workgroup reduces
+// a 64 x 64 texels tile of the source to 32 x 32, 16 x 16 ... 1 x 1 in shared memory
+
+layout (local_size_x = 16, local_size_y = 16, local_size_z = 1) in;
+
+layout (rgba16f, binding = 0) uniform writeonly image2D levels[6];
+
+uniform sampler2D image;
+uniform vec2 renderScale; // rendered part of the source
+
+shared vec3 tile[32][32];
+
+vec3 fetch(vec2 uv, vec2 texelSize)
+{
+	// clamped to the rendered region
+	return texture(image, min(uv, renderScale - 0.5f * texelSize)).rgb;
+}
+
+vec3 box(vec2 uv, vec2 texelSize)
+{
+	vec3 sum = fetch(uv + texelSize * vec2(-1.0f, 1.0f), texelSize);
+	sum += fetch(uv + texelSize * vec2(1.0f, 1.0f), texelSize);
+	sum += fetch(uv + texelSize * vec2(-1.0f, -1.0f), texelSize);
+	sum += fetch(uv + texelSize * vec2(1.0f, -1.0f), texelSize);
+	return sum / 4.0f;
+}
+
+vec3 firstLevel(ivec2 texel)
+{
+	// 13 taps, 5 overlapping 4x4 boxes around the 2x2 source texels
+	vec2 texelSize = 1.0f / vec2(textureSize(image, 0));
+	vec2 uv = vec2(2 * texel + 1) * texelSize;
+	vec3 C = box(uv, texelSize);
+	vec3 NW = box(uv + texelSize * vec2(-1.0f, 1.0f), texelSize);
+	vec3 NE = box(uv + texelSize * vec2(1.0f, 1.0f), texelSize);
+	vec3 SE = box(uv + texelSize * vec2(1.0f, -1.0f), texelSize);
+	vec3 SW = box(uv + texelSize * vec2(-1.0f, -1.0f), texelSize);
+	return 0.5f * C + 0.125f * (NW + NE + SE + SW);
+}
+
+void main()
+{
+	ivec2 group = ivec2(gl_WorkGroupID.xy);
+	ivec2 local = ivec2(gl_LocalInvocationID.xy);
+
+	// level 0 : 2x2 texels per invocation
+	for(int i = 0; i < 4; ++i)
+	{
+		ivec2 p = local * 2 + ivec2(i % 2, i / 2);
+		ivec2 texel = group * 32 + p;
+		vec3 color = firstLevel(texel);
+		tile[p.y][p.x] = color;
+		imageStore(levels[0], texel, vec4(color, 1.0f));
+	}
+
+	// following levels : 2x2 box of the previous one
+	int index = int(gl_LocalInvocationIndex);
+	for(int l = 1; l < 6; ++l)
+	{
+		int size = 32 >> l;
+		ivec2 p = ivec2(index % size, index / size);
+		bool active = index < size * size;
+
+		barrier();
+		vec3 color = vec3(0.0f);
+		if(active)
+			color = 0.25f * (tile[2*p.y][2*p.x] + tile[2*p.y][2*p.x+1] + tile[2*p.y+1][2*p.x] + tile[2*p.y+1][2*p.x+1]);
+		barrier();
+
+		if(active)
+		{
+			tile[p.y][p.x] = color;
+			imageStore(levels[l], group * size + p, vec4(color, 1.0f));
+		}
+	}
+}
@@ -0,0 +1,49 @@
+#version 460 core
+
+// tent filtered lower level added to the current one, in place in the bloom levels
+// or, for the last step, to the source image into the bloom output
+
+layout (local_size_x = 16, local_size_y = 16, local_size_z = 1) in;
+
+layout (rgba16f, binding = 0) uniform image2D target;
+
+uniform sampler2D low_res; // bloom levels
+uniform int low_res_level;
+uniform sampler2D high_res; // source image
+uniform int merge_source; // 1 : last step, added to the source image
+uniform vec2 renderScale;
+
+vec3 fetch(vec2 uv, vec2 texelSize)
+{
+	return textureLod(low_res, min(uv, renderScale - 0.5f * texelSize), float(low_res_level)).rgb;
+}
+
+void main()
+{
+	ivec2 texel = ivec2(gl_GlobalInvocationID.xy);
+	ivec2 size = imageSize(target);
+	if(any(greaterThanEqual(texel, size)))
+		return;
+
+	vec2 uv = (vec2(texel) + 0.5f) / vec2(size);
+	vec2 texelSize = 1.0f / vec2(textureSize(low_res, low_res_level));
+
+	// 3x3 tent
+	vec3 color = vec3(0.0f);
+	color += fetch(uv + vec2(-1.0f, 1.0f) * texelSize, texelSize);
+	color += fetch(uv + vec2(0.0f, 1.0f) * texelSize, texelSize) * 2.0f;
+	color += fetch(uv + vec2(1.0f, 1.0f) * texelSize, texelSize);
+	color += fetch(uv + vec2(-1.0f, 0.0f) * texelSize, texelSize) * 2.0f;
+	color += fetch(uv, texelSize) * 4.0f;
+	color += fetch(uv + vec2(1.0f, 0.0f) * texelSize, texelSize) * 2.0f;
+	color += fetch(uv + vec2(-1.0f, -1.0f) * texelSize, texelSize);
+	color += fetch(uv + vec2(0.0f, -1.0f) * texelSize, texelSize) * 2.0f;
+	color += fetch(uv + vec2(1.0f, -1.0f) * texelSize, texelSize);
+	color /= 16.0f;
+
+	if(merge_source == 1)
+		color += texelFetch(high_res, texel, 0).rgb;
+	else
+		color += imageLoad(target, texel).rgb;
+	imageStore(target, texel, vec4(color, 1.0f));
+}
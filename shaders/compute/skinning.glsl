@@ -0,0 +1,60 @@
+#version 460 core
+// skins the vertices of one mesh into its cached vertex buffer, once per frame,
+// every pass (shadows, G-buffer, color) then draws it as static geometry
+layout(local_size_x = 64, local_size_y = 1, local_size_z = 1) in ;
+
+const int MAX_BONE_INFLUENCE = 4;
+const int VERTEX_SIZE = 22; // floats : position 3, normal 3, texCoords 2, tangent 3, biTangent 3, bonesID 4, weights 4
+
+layout(std430, binding = 0) readonly buffer BindPose
+{
+	float bindPose[];
+};
+
+layout(std430, binding = 1) writeonly buffer Skinned
+{
+	float skinned[];
+};
+
+layout(std430, binding = 4) readonly buffer BonePalette
+{
+	mat4 bonesMatrices[]; // range of the skinned object
+};
+
+uniform int vertexCount;
+
+vec3 read3(int index)
+{
+	return vec3(bindPose[index], bindPose[index + 1], bindPose[index + 2]);
+}
+
+void write3(int index, vec3 v)
+{
+	skinned[index] = v.x;
+	skinned[index + 1] = v.y;
+	skinned[index + 2] = v.z;
+}
+
+void main()
+{
+	int v = int(gl_GlobalInvocationID.x);
+	if(v >= vertexCount)
+		return;
+
+	int base = v * VERTEX_SIZE;
+	mat4 boneTransform = mat4(0.0f);
+	for(int i = 0; i < MAX_BONE_INFLUENCE; ++i)
+	{
+		int boneID = floatBitsToInt(bindPose[base + 14 + i]);
+		boneTransform += bonesMatrices[boneID] * bindPose[base + 18 + i];
+	}
+
+	write3(base, vec3(boneTransform * vec4(read3(base), 1.0f)));
+	write3(base + 3, vec3(boneTransform * vec4(read3(base + 3), 0.0f)));
+	skinned[base + 6] = bindPose[base + 6];
+	skinned[base + 7] = bindPose[base + 7];
+	write3(base + 8, vec3(boneTransform * vec4(read3(base + 8), 0.0f)));
+	write3(base + 11, vec3(boneTransform * vec4(read3(base + 11), 0.0f)));
+	for(int i = 0; i < 2 * MAX_BONE_INFLUENCE; ++i)
+		skinned[base + 14 + i] = bindPose[base + 14 + i];
+}
@@ -0,0 +1,163 @@
+#version 460 core
+// blur, sobel, non maximum suppression, double thresholding and hysteresis in one dispatch,
+// intermediates stay in shared memory over the tile and a halo wide enough for every step
+layout(local_size_x = 16, local_size_y = 16, local_size_z = 1) in ;
+layout(rgba16f, binding = 0) readonly uniform image2D image_in;
+layout(r8, binding = 1) writeonly uniform image2D edges_out;
+
+uniform float sigma;
+uniform float low_thr;
+uniform float high_thr;
+
+const int TILE = 16;
+const int HALO = 5; // blur 2 + sobel 1 + nms 1 + hysteresis 1
+const int N = TILE + 2 * HALO;
+const int BLUR_SIZE = 5;
+
+shared float grey[N * N];
+shared float tmp[N * N];
+shared vec3 gradient[N * N];
+
+mat3 sobelX = mat3(
+    vec3(-1, -2, -1),
+    vec3(0, 0, 0),
+    vec3(1, 2, 1)
+);
+
+mat3 sobelY = mat3(
+    vec3(1, 0, -1),
+    vec3(2, 0, -2),
+    vec3(1, 0, -1)
+);
+
+ivec2 origin()
+{
+    return ivec2(gl_WorkGroupID.xy) * TILE - HALO;
+}
+
+int at(int x, int y)
+{
+    return clamp(y, 0, N - 1) * N + clamp(x, 0, N - 1);
+}
+
+bool inside(int i)
+{
+    // out of the image the chained passes read zeros, kept so the result does not change
+    ivec2 p = origin() + ivec2(i % N, i / N);
+    return all(greaterThanEqual(p, ivec2(0))) && all(lessThan(p, imageSize(image_in)));
+}
+
+int getOrientation(vec2 gradient)
+{
+	if (gradient[1] < 0.0f)
+	{
+		gradient *= -1.0f;
+	}
+	gradient = gradient / (sqrt(gradient[0] * gradient[0] + gradient[1] * gradient[1]));
+
+	float f0 = abs(gradient.x);
+	float f1 = abs(dot(gradient, vec2(sqrt(2.0) / 2.0, sqrt(2.0) / 2.0)));
+	float f2 = abs(gradient.y);
+	float f3 = abs(dot(gradient, vec2(-sqrt(2.0) / 2.0, sqrt(2.0) / 2.0)));
+	float fmax = max(max(max(f3, f2), f1), f0);
+
+	if (fmax == f0) { return 0; }
+	else if (fmax == f1) { return 1; }
+	else if (fmax == f2) { return 2; }
+	return 3;
+}
+
+float blur(int x, int y, ivec2 direction, bool fromGrey)
+{
+    int halfSize = BLUR_SIZE / 2;
+    float twoSigmaSquared = 2.0f * sigma * sigma;
+    float color = 0.0f;
+    float sum = 0.0f;
+    for(int i = -halfSize; i < halfSize; ++i)
+    {
+        int j = at(x + direction.x * i, y + direction.y * i);
+        float g = exp(-(i*i) / twoSigmaSquared);
+        color += ((fromGrey) ? grey[j] : tmp[j]) * g;
+        sum += g;
+    }
+    return color / sum;
+}
+
+void main()
+{
+    int first = int(gl_LocalInvocationIndex);
+    int stride = TILE * TILE;
+
+    // luminance, blurring it equals blurring the color then turning it to grey
+    for(int i = first; i < N * N; i += stride)
+    {
+        vec3 color = inside(i) ? imageLoad(image_in, origin() + ivec2(i % N, i / N)).rgb : vec3(0.0f);
+        grey[i] = dot(color, vec3(0.2126f, 0.7152f, 0.0722f));
+    }
+    barrier();
+
+    // gaussian blur
+    for(int i = first; i < N * N; i += stride)
+        tmp[i] = inside(i) ? blur(i % N, i / N, ivec2(1, 0), true) : 0.0f;
+    barrier();
+    for(int i = first; i < N * N; i += stride)
+        grey[i] = inside(i) ? blur(i % N, i / N, ivec2(0, 1), false) : 0.0f;
+    barrier();
+
+    // edge detection
+    for(int i = first; i < N * N; i += stride)
+    {
+        float GX = 0.0f;
+        float GY = 0.0f;
+        for(int line = -1; line < 2; ++line)
+        {
+            for(int col = -1; col < 2; ++col)
+            {
+                float g = grey[at(i % N + col, i / N + line)];
+                GX += g * sobelX[col+1][line+1];
+                GY += g * sobelY[col+1][line+1];
+            }
+        }
+        gradient[i] = inside(i) ? vec3(GX, GY, sqrt(GX*GX + GY*GY)) : vec3(0.0f);
+    }
+    barrier();
+
+    // non maximum suppression then double thresholding
+    for(int i = first; i < N * N; i += stride)
+    {
+        int x = i % N;
+        int y = i / N;
+        vec3 G = gradient[i];
+        int orientation = getOrientation(G.xy);
+        ivec2 offset = (orientation == 0) ? ivec2(1, 0) : (orientation == 1) ? ivec2(1, -1) : (orientation == 2) ? ivec2(0, 1) : ivec2(1, 1);
+        float a = gradient[at(x - offset.x, y - offset.y)].z;
+        float b = gradient[at(x + offset.x, y + offset.y)].z;
+        float color = (G.z > a && G.z > b) ? G.z : 0.0f;
+        tmp[i] = (!inside(i) || color < low_thr) ? 0.0f : (color <= high_thr) ? 0.5f : 1.0f;
+    }
+    barrier();
+
+    // hysteresis : weak edges kept next to a strong one
+    ivec2 local = ivec2(gl_LocalInvocationID.xy) + HALO;
+    float strength = tmp[at(local.x, local.y)];
+    float color = 0.0f;
+    if(strength >= 0.49f && strength <= 0.51f)
+    {
+        for(int line = -1; line < 2; ++line)
+        {
+            for(int col = -1; col < 2; ++col)
+            {
+                if(tmp[at(local.x + col, local.y + line)] == 1.0f)
+                    color = 1.0f;
+            }
+        }
+    }
+    else if(strength >= 0.99f)
+    {
+        color = 1.0f;
+    }
+
+    ivec2 coords = ivec2(gl_GlobalInvocationID);
+    if(all(lessThan(coords, imageSize(edges_out))))
+        imageStore(edges_out, coords, vec4(color, color, color, 1.0f));
+}
@@ -0,0 +1,97 @@
+#version 460 core
+// two dilations and a blur of the edges in shared memory, then drawn over the image in place
+layout(local_size_x = 16, local_size_y = 16, local_size_z = 1) in ;
+layout(r8, binding = 0) readonly uniform image2D edges;
+layout(rgba16f, binding = 1) uniform image2D image;
+
+uniform float sigma;
+uniform vec3 outline_color;
+
+const int TILE = 16;
+const int HALO = 4; // dilate 1 + dilate 1 + blur 2
+const int N = TILE + 2 * HALO;
+const int BLUR_SIZE = 5;
+
+shared float a[N * N];
+shared float b[N * N];
+
+ivec2 origin()
+{
+    return ivec2(gl_WorkGroupID.xy) * TILE - HALO;
+}
+
+int at(int x, int y)
+{
+    return clamp(y, 0, N - 1) * N + clamp(x, 0, N - 1);
+}
+
+bool inside(int i)
+{
+    ivec2 p = origin() + ivec2(i % N, i / N);
+    return all(greaterThanEqual(p, ivec2(0))) && all(lessThan(p, imageSize(image)));
+}
+
+float dilate(int x, int y, bool fromA)
+{
+    float sum = 0.0f;
+    for(int line = -1; line < 2; ++line)
+    {
+        for(int col = -1; col < 2; ++col)
+        {
+            int j = at(x + col, y + line);
+            sum += (fromA) ? a[j] : b[j];
+        }
+    }
+    return (sum > 0.0f) ? 1.0f : 0.0f;
+}
+
+float blur(int x, int y, ivec2 direction, bool fromA)
+{
+    int halfSize = BLUR_SIZE / 2;
+    float twoSigmaSquared = 2.0f * sigma * sigma;
+    float color = 0.0f;
+    float sum = 0.0f;
+    for(int i = -halfSize; i < halfSize; ++i)
+    {
+        int j = at(x + direction.x * i, y + direction.y * i);
+        float g = exp(-(i*i) / twoSigmaSquared);
+        color += ((fromA) ? a[j] : b[j]) * g;
+        sum += g;
+    }
+    return color / sum;
+}
+
+void main()
+{
+    int first = int(gl_LocalInvocationIndex);
+    int stride = TILE * TILE;
+
+    for(int i = first; i < N * N; i += stride)
+        a[i] = inside(i) ? imageLoad(edges, origin() + ivec2(i % N, i / N)).x : 0.0f;
+    barrier();
+
+    // dilation, twice
+    for(int i = first; i < N * N; i += stride)
+        b[i] = inside(i) ? dilate(i % N, i / N, true) : 0.0f;
+    barrier();
+    for(int i = first; i < N * N; i += stride)
+        a[i] = inside(i) ? dilate(i % N, i / N, false) : 0.0f;
+    barrier();
+
+    // soften the outline
+    for(int i = first; i < N * N; i += stride)
+        b[i] = inside(i) ? blur(i % N, i / N, ivec2(1, 0), true) : 0.0f;
+    barrier();
+    for(int i = first; i < N * N; i += stride)
+        a[i] = inside(i) ? blur(i % N, i / N, ivec2(0, 1), false) : 0.0f;
+    barrier();
+
+    // each invocation reads and writes its own pixel only
+    ivec2 coords = ivec2(gl_GlobalInvocationID);
+    if(any(greaterThanEqual(coords, imageSize(image))))
+        return;
+    ivec2 local = ivec2(gl_LocalInvocationID.xy) + HALO;
+    float edge = a[at(local.x, local.y)];
+    if(edge > 0.0f)
+        imageStore(image, coords, vec4(outline_color * edge, 1.0f));
+}
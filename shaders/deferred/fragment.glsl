@@ -0,0 +1,309 @@
+#version 460 core
+
+layout (location = 0) out vec4 fragColor;
+layout (location = 1) out vec4 brightColor;
+
+struct Light
+{
+	mat4 lightSpaceMatrix;
+	vec4 atlasRegion; // xy offset, zw scale in the shadow atlas
+	vec3 position;
+	int type; // 0 => point, 1 => directional, 2 => spot
+	vec3 direction;
+	float cutOff;
+	vec3 ambientStrength;
+	float outerCutOff;
+	vec3 diffuseStrength;
+	float kc;
+	vec3 specularStrength;
+	float kl;
+	float kq;
+	int shadowLayer; // layer in the omni shadow cube map array, -1 without shadow
+	float range;
+};
+
+struct Camera
+{
+	vec3 viewPos;
+};
+
+in vec2 texCoords;
+
+// G-buffer, world positions are rebuilt from the depth
+uniform sampler2D gNormal; // octahedral, view space
+uniform sampler2D gDepth;
+uniform sampler2D gAlbedo;
+uniform sampler2D gMetallicRough;
+uniform sampler2D gEmission;
+
+uniform Camera cam;
+
+uniform int shadowOn;
+uniform sampler2D shadowAtlas;
+uniform samplerCubeArray omniShadowMaps;
+
+// clustered lights, lightGrid holds (first, count) into lightIndex per cluster
+layout (std430, binding = 0) readonly buffer LightBuffer { Light light[]; };
+layout (std430, binding = 1) readonly buffer LightGrid { uvec2 lightGrid[]; };
+layout (std430, binding = 2) readonly buffer LightIndexList { uint lightIndex[]; };
+uniform ivec3 clusterGrid;
+uniform vec2 clusterDepth; // near, far
+uniform mat4 view;
+uniform mat4 invViewProj;
+
+uniform sampler2D ssao;
+uniform int hasSSAO;
+uniform vec2 viewport;
+uniform vec2 renderScale; // rendered part of the full size targets
+
+uniform int IBL;
+uniform samplerCube irradianceMap;
+uniform samplerCube prefilterMap;
+uniform sampler2D brdfLUT;
+
+const float PI = 3.14159265359;
+// ----------------------------------------------------------------------------
+float DistributionGGX(vec3 N, vec3 H, float roughness)
+{
+    float a = roughness*roughness;
+    float a2 = a*a;
+    float NdotH = max(dot(N, H), 0.0);
+    float NdotH2 = NdotH*NdotH;
+
+    float nom   = a2;
+    float denom = (NdotH2 * (a2 - 1.0) + 1.0);
+    denom = PI * denom * denom;
+
+    return nom / denom;
+}
+// ----------------------------------------------------------------------------
+float GeometrySchlickGGX(float NdotV, float roughness)
+{
+    float r = (roughness + 1.0);
+    float k = (r*r) / 8.0;
+
+    float nom   = NdotV;
+    float denom = NdotV * (1.0 - k) + k;
+
+    return nom / denom;
+}
+// ----------------------------------------------------------------------------
+float GeometrySmith(vec3 N, vec3 V, vec3 L, float roughness)
+{
+    float NdotV = max(dot(N, V), 0.0);
+    float NdotL = max(dot(N, L), 0.0);
+    float ggx2 = GeometrySchlickGGX(NdotV, roughness);
+    float ggx1 = GeometrySchlickGGX(NdotL, roughness);
+
+    return ggx1 * ggx2;
+}
+// ----------------------------------------------------------------------------
+vec3 fresnelSchlick(float cosTheta, vec3 F0)
+{
+    return F0 + (1.0 - F0) * pow(max(1.0 - cosTheta, 0.0), 5.0);
+}
+// ----------------------------------------------------------------------------
+vec3 fresnelSchlickRoughness(float cosTheta, vec3 F0, float roughness)
+{
+    return F0 + (max(vec3(1.0 - roughness), F0) - F0) * pow(max(1.0 - cosTheta, 0.0), 5.0);
+}
+// ----------------------------------------------------------------------------
+float calculateShadow(vec4 fragPosLightSpace, vec3 N, vec3 lightDir, int l)
+{
+	float shadow = 0.0;
+	vec2 texelSize = 1.0 / textureSize(shadowAtlas, 0);
+	float bias = max(0.005 * (1.0 - dot(N, -lightDir)), 0.0005);
+
+	// perform perspective divide
+	vec3 projCoords = fragPosLightSpace.xyz / fragPosLightSpace.w;
+	
+	// transform to [0,1] range
+	projCoords = (projCoords * 0.5) + 0.5;
+	vec4 region = light[l].atlasRegion;
+	if(projCoords.z > 1.0 || region.z == 0.0 || any(lessThan(projCoords.xy, vec2(0.0))) || any(greaterThan(projCoords.xy, vec2(1.0))))
+	{
+		shadow = 0.0;
+		return shadow;
+	}
+
+	// get depth of current fragment from light's perspective
+	float currentDepth = projCoords.z;
+	vec2 regionMin = region.xy + texelSize * 0.5;
+	vec2 regionMax = region.xy + region.zw - texelSize * 0.5;
+	
+	for(int x = -1; x <= 1; ++x)
+	{
+		for(int y = -1; y <= 1; ++y)
+		{
+			float depth = texture(shadowAtlas, clamp(region.xy + projCoords.xy * region.zw + vec2(x, y) * texelSize, regionMin, regionMax)).r;
+			shadow += (currentDepth - bias) > depth ? 1.0 : 0.0;
+		}
+	}
+	
+	return shadow / 9.0;
+}
+// ----------------------------------------------------------------------------
+vec3 sampleOffsetDirections[20] = vec3[]
+(
+	vec3(1, 1, 1), vec3(1, -1, 1), vec3(-1, -1, 1), vec3(-1, 1, 1),
+	vec3(1, 1, -1), vec3(1, -1, -1), vec3(-1, -1, -1), vec3(-1, 1, -1),
+	vec3(1, 1, 0), vec3(1, -1, 0), vec3(-1, -1, 0), vec3(-1, 1, 0),
+	vec3(1, 0, 1), vec3(-1, 0, 1), vec3(1, 0, -1), vec3(-1, 0, -1),
+	vec3(0, 1, 1), vec3(0, -1, 1), vec3(0, -1, -1), vec3(0, 1, -1)
+);
+
+float calculateOmniShadow(vec3 fragPos, vec3 lightPos, int l)
+{
+	float shadow = 0.0;
+	float bias = 0.1;
+	int samples = 20;
+	float viewDistance = length(cam.viewPos - fragPos);
+	float diskRadius = (1.0 + (viewDistance / 100.0f)) / 25.0;
+	
+	if(light[l].shadowLayer < 0)
+		return 0.0;
+
+	vec3 distFragLight = fragPos - lightPos;
+	float currentDepth = length(distFragLight);
+	
+	for(int i = 0; i < samples; ++i)
+	{
+		float closestDepth = texture(omniShadowMaps, vec4(distFragLight + sampleOffsetDirections[i] * diskRadius, light[l].shadowLayer)).r;
+		closestDepth *= 100.0f;
+		if(currentDepth - bias > closestDepth)
+			shadow += 1.0f;
+	}
+
+	shadow /= float(samples);
+
+	return shadow;
+}
+// ----------------------------------------------------------------------------
+vec3 decodeNormal(vec2 e)
+{
+	e = e * 2.0f - 1.0f;
+	vec3 n = vec3(e, 1.0f - abs(e.x) - abs(e.y));
+	float t = clamp(-n.z, 0.0f, 1.0f);
+	n.xy += vec2(n.x >= 0.0f ? -t : t, n.y >= 0.0f ? -t : t);
+	return normalize(n);
+}
+// ----------------------------------------------------------------------------
+uint clusterIndex(vec3 fragPos)
+{
+	// screen tile, then exponential view depth slice
+	float depth = clamp(-(view * vec4(fragPos, 1.0f)).z, clusterDepth.x, clusterDepth.y);
+	int slice = min(int(log(depth / clusterDepth.x) / log(clusterDepth.y / clusterDepth.x) * clusterGrid.z), clusterGrid.z - 1);
+	ivec2 tile = min(ivec2(gl_FragCoord.xy / viewport * vec2(clusterGrid.xy)), clusterGrid.xy - 1);
+	return uint((slice * clusterGrid.y + tile.y) * clusterGrid.x + tile.x);
+}
+
+void main()
+{
+	// background pixels keep the cleared color, the sky is drawn afterwards
+	ivec2 texel = ivec2(gl_FragCoord.xy);
+	float depth = texelFetch(gDepth, texel, 0).r;
+	if(depth == 1.0f)
+		discard;
+	gl_FragDepth = depth;
+
+	vec4 worldPos = invViewProj * vec4(vec3(texCoords / renderScale, depth) * 2.0f - 1.0f, 1.0f);
+	vec3 fragPos = worldPos.xyz / worldPos.w;
+	vec3 N = normalize(transpose(mat3(view)) * decodeNormal(texelFetch(gNormal, texel, 0).rg));
+	vec3 albedo = texelFetch(gAlbedo, texel, 0).rgb;
+	vec2 metallicRough = texelFetch(gMetallicRough, texel, 0).rg;
+	float metallic = metallicRough.r;
+	float roughness = metallicRough.g;
+	vec3 emission = texelFetch(gEmission, texel, 0).rgb;
+	float ao = (hasSSAO == 1) ? texture(ssao, texCoords).r : 1.0f;
+
+	vec3 V = normalize(cam.viewPos - fragPos);
+	vec3 F0 = mix(vec3(0.04), albedo, metallic);
+
+	// reflectance equation, each light evaluated once per pixel
+	vec3 Lo = vec3(0.0);
+	uvec2 cluster = lightGrid[clusterIndex(fragPos)];
+	for(uint n = 0; n < cluster.y; ++n)
+	{
+		int i = int(lightIndex[cluster.x + n]);
+
+		vec3 L = normalize(light[i].position - fragPos);
+		vec3 H = normalize(V + L);
+		float distance = length(light[i].position - fragPos);
+		float attenuation;
+		if(light[i].type == 0)
+			attenuation = 1.0f / (light[i].kc + light[i].kl * distance + light[i].kq * (distance * distance));
+		else if(light[i].type == 2)
+			attenuation = 1.0f / (distance * distance);
+		else
+			attenuation = 1.0f;
+		vec3 radiance = light[i].diffuseStrength * attenuation;
+
+		// Cook-Torrance BRDF
+		float NDF = DistributionGGX(N, H, roughness);
+		float G = GeometrySmith(N, V, L, roughness);
+		vec3 F = fresnelSchlick(max(dot(H, V), 0.0), F0);
+
+		vec3 specular = (NDF * G * F) / (4 * max(dot(N, V), 0.0) * max(dot(N, L), 0.0) + 0.001);
+		vec3 kD = (vec3(1.0) - F) * (1.0 - metallic);
+		float NdotL = max(dot(N, L), 0.0);
+
+		float shadow = 0.0f;
+		float theta;
+		float intensity;
+		vec3 lightDir;
+
+		if(light[i].type == 0)
+			lightDir = normalize(fragPos - light[i].position);
+		else if(light[i].type == 1)
+			lightDir = light[i].direction;
+		else if(light[i].type == 2)
+		{
+			lightDir = normalize(fragPos - light[i].position);
+			theta = dot(lightDir, normalize(light[i].direction));
+			float epsilon = light[i].cutOff - light[i].outerCutOff;
+			intensity = clamp((theta - light[i].outerCutOff) / epsilon, 0.0f, 1.0f);
+		}
+
+		if(shadowOn == 1 && light[i].type != 0)
+			shadow = calculateShadow(light[i].lightSpaceMatrix * vec4(fragPos, 1.0f), N, lightDir, i);
+		else if(shadowOn == 1 && light[i].type == 0)
+			shadow = calculateOmniShadow(fragPos, light[i].position, i);
+
+		if(light[i].type == 2 && theta > light[i].outerCutOff)
+			Lo += (kD * albedo / PI + specular) * radiance * NdotL * (1.0f - shadow) * intensity;
+		else if(light[i].type != 2)
+			Lo += (kD * albedo / PI + specular) * radiance * NdotL * (1.0f - shadow);
+	}
+
+	vec3 ambient;
+	if(IBL == 1)
+	{
+		vec3 R = reflect(-V, N);
+		vec3 F = fresnelSchlickRoughness(max(dot(N, V), 0.0), F0, roughness);
+		vec3 kD = (1.0 - F) * (1.0 - metallic);
+		vec3 diffuse = texture(irradianceMap, N).rgb * albedo;
+
+		const float MAX_REFLECTION_LOD = 4.0;
+		vec3 prefilteredColor = textureLod(prefilterMap, R, roughness * MAX_REFLECTION_LOD).rgb;
+		vec2 brdf = texture(brdfLUT, vec2(max(dot(N, V), 0.0), roughness)).rg;
+		vec3 specular = prefilteredColor * (F * brdf.x + brdf.y);
+
+		ambient = (kD * diffuse + specular * metallic) * ao * 0.33;
+	}
+	else
+	{
+		ambient = albedo * ao * 0.33;
+	}
+	fragColor = vec4(ambient + Lo, 1.0f);
+
+	// bright color, same threshold as the forward PBR shader
+	float brightness = dot(fragColor.rgb + emission, vec3(0.2126f, 0.7152f, 0.0722f));
+	if(brightness > 1.0f)
+	{
+		brightColor = vec4(fragColor.rgb + emission, 1.0f);
+		if(emission == vec3(0.0f) && brightness > 5.0f)
+			brightColor = vec4(0.0f, 0.0f, 0.0f, 1.0f);
+	}
+	else
+		brightColor = vec4(0.0f, 0.0f, 0.0f, 1.0f);
+}
@@ -0,0 +1,107 @@
+#version 460 core
+
+#ifdef GBUFFER
+layout (location = 0) out vec2 fragNormal; // octahedral
+layout (location = 1) out vec4 fragAlbedo;
+layout (location = 2) out vec2 fragMetallicRough;
+layout (location = 3) out vec3 fragEmission;
+#else
+layout (location = 0) out vec4 fragColor;
+layout (location = 1) out vec4 brightColor;
+#endif
+
+in VS_OUT
+{
+	vec2 texCoords;
+	vec3 worldPos;
+} fs_in;
+
+flat in vec3 worldBack;
+flat in mat3 normalMatrix;
+flat in ivec2 cell;
+flat in vec2 cellWeights;
+flat in float fade;
+
+uniform sampler2D albedoAtlas;
+uniform sampler2D normalAtlas;
+uniform sampler2D metallicRoughAtlas;
+uniform sampler2D depthAtlas;
+uniform mat4 view;
+uniform mat4 proj;
+uniform int views;
+
+#ifndef GBUFFER
+// impostors are lit by the sun only
+uniform vec3 lightDirection;
+uniform vec3 lightColor;
+uniform vec3 ambient;
+#endif
+
+#include "noise.glsl"
+
+vec2 encodeNormal(vec3 n)
+{
+	n /= abs(n.x) + abs(n.y) + abs(n.z);
+	if(n.z < 0.0f)
+		n.xy = (1.0f - abs(n.yx)) * vec2(n.x >= 0.0f ? 1.0f : -1.0f, n.y >= 0.0f ? 1.0f : -1.0f);
+	return n.xy * 0.5f + 0.5f;
+}
+
+vec3 decodeNormal(vec2 e)
+{
+	e = e * 2.0f - 1.0f;
+	vec3 n = vec3(e, 1.0f - abs(e.x) - abs(e.y));
+	float t = clamp(-n.z, 0.0f, 1.0f);
+	n.xy += vec2(n.x >= 0.0f ? -t : t, n.y >= 0.0f ? -t : t);
+	return normalize(n);
+}
+
+void main()
+{
+	// complementary to the geometry dither, the two never cover the same pixel
+	if(interleavedGradientNoise(gl_FragCoord.xy) >= fade)
+		discard;
+
+	// bilinear blend of the four nearest baked views, weighted by their coverage
+	ivec2 cells[4] = ivec2[](cell, cell + ivec2(1, 0), cell + ivec2(0, 1), cell + ivec2(1, 1));
+	float weights[4] = float[](
+			(1.0f - cellWeights.x) * (1.0f - cellWeights.y),
+			cellWeights.x * (1.0f - cellWeights.y),
+			(1.0f - cellWeights.x) * cellWeights.y,
+			cellWeights.x * cellWeights.y);
+	vec4 albedo = vec4(0.0f);
+	vec3 normal = vec3(0.0f);
+	vec2 metallicRough = vec2(0.0f);
+	float depth = 0.0f;
+	for(int i = 0; i < 4; ++i)
+	{
+		vec2 uv = (vec2(cells[i]) + fs_in.texCoords) / float(views);
+		vec4 sampleAlbedo = texture(albedoAtlas, uv);
+		float w = weights[i] * sampleAlbedo.a;
+		albedo += vec4(sampleAlbedo.rgb * w, w);
+		normal += decodeNormal(texture(normalAtlas, uv).rg) * w;
+		metallicRough += texture(metallicRoughAtlas, uv).rg * w;
+		depth += texture(depthAtlas, uv).r * w;
+	}
+	if(albedo.a < 0.5f)
+		discard;
+	albedo.rgb /= albedo.a;
+	metallicRough /= albedo.a;
+	depth /= albedo.a;
+	normal = normalize(normalMatrix * normal);
+
+	// baked depth puts the fragment back on the surface it stands for
+	vec4 clip = proj * view * vec4(fs_in.worldPos + worldBack * (2.0f * depth - 1.0f), 1.0f);
+	gl_FragDepth = clip.z / clip.w * 0.5f + 0.5f;
+
+#ifdef GBUFFER
+	fragNormal = encodeNormal(normalize(mat3(view) * normal));
+	fragAlbedo = vec4(albedo.rgb, 1.0f);
+	fragMetallicRough = metallicRough;
+	fragEmission = vec3(0.0f);
+#else
+	vec3 color = albedo.rgb * (ambient + lightColor * max(dot(normal, -lightDirection), 0.0f));
+	fragColor = vec4(color, 1.0f);
+	brightColor = vec4(0.0f, 0.0f, 0.0f, 1.0f);
+#endif
+}
@@ -0,0 +1,56 @@
+#version 460 core
+
+layout (location = 0) in vec2 aPos; // quad corner in [-1, 1]
+layout (location = 1) in mat4 instanceModel;
+layout (location = 5) in float instanceFade;
+
+out VS_OUT
+{
+	vec2 texCoords;
+	vec3 worldPos;
+} vs_out;
+
+flat out vec3 worldBack; // from the quad to the back of the bounding sphere, scaled by the baked depth
+flat out mat3 normalMatrix; // baked view space normals to world space
+flat out ivec2 cell; // lower left of the four nearest views
+flat out vec2 cellWeights;
+flat out float fade;
+
+uniform mat4 view;
+uniform mat4 proj;
+uniform vec3 center; // object space bounding sphere
+uniform float radius;
+uniform int views; // views x views octahedral grid
+
+vec2 octahedralEncode(vec3 d)
+{
+	// y up, same layout as Impostor::viewDirection
+	vec3 n = vec3(d.x, d.z, d.y) / (abs(d.x) + abs(d.y) + abs(d.z));
+	if(n.z < 0.0f)
+		n.xy = (1.0f - abs(n.yx)) * vec2(n.x >= 0.0f ? 1.0f : -1.0f, n.y >= 0.0f ? 1.0f : -1.0f);
+	return n.xy * 0.5f + 0.5f;
+}
+
+void main()
+{
+	// object space direction to the eye picks the baked views
+	mat3 rotation = mat3(instanceModel);
+	vec3 eye = vec3(inverse(view)[3]);
+	vec3 dir = normalize(inverse(rotation) * (eye - vec3(instanceModel * vec4(center, 1.0f))));
+	vec2 grid = clamp(octahedralEncode(dir) * views - 0.5f, vec2(0.0f), vec2(views - 1));
+	cell = min(ivec2(grid), ivec2(views - 2));
+	cellWeights = grid - vec2(cell);
+
+	// quad facing the eye, same basis as the bake cameras
+	vec3 up = (abs(dir.y) > 0.999f) ? vec3(0.0f, 0.0f, 1.0f) : vec3(0.0f, 1.0f, 0.0f);
+	vec3 right = normalize(cross(-dir, up));
+	up = cross(right, -dir);
+	vec3 localPos = center + (right * aPos.x + up * aPos.y) * radius;
+
+	vs_out.texCoords = aPos * 0.5f + 0.5f;
+	vs_out.worldPos = vec3(instanceModel * vec4(localPos, 1.0f));
+	worldBack = rotation * (-dir * radius);
+	normalMatrix = rotation * mat3(right, up, dir);
+	fade = instanceFade;
+	gl_Position = proj * view * vec4(vs_out.worldPos, 1.0f);
+}
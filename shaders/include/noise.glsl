@@ -0,0 +1,5 @@
+// per pixel noise in [0, 1), shared by the dither fades and the AO rotations
+float interleavedGradientNoise(vec2 pixel)
+{
+	return fract(52.9829189f * fract(dot(pixel, vec2(0.06711056f, 0.00583715f))));
+}
@@ -0,0 +1,5 @@
+// weighted blended OIT weight, favours opaque and close fragments
+float oitWeight(float alpha, float depth)
+{
+	return clamp(pow(min(1.0f, alpha * 10.0f) + 0.01f, 3.0f) * 1e8 * pow(1.0f - depth * 0.9f, 3.0f), 1e-2, 3e3);
+}
@@ -7,13 +7,17 @@ in VS_OUT
     vec2 texCoords;
 } fs_in;
 
-uniform sampler2D worldPos;
+uniform sampler2D depthMap;
+uniform mat4 inv_viewProj;
 uniform mat4 prev_MVP;
 uniform mat4 curr_MVP;
+uniform vec2 renderScale; // rendered part of the full size targets
 
 void main()
 {
-    vec4 world_coords = texture(worldPos, fs_in.texCoords);
+    float depth = texture(depthMap, fs_in.texCoords).r;
+    vec4 world_coords = inv_viewProj * vec4(vec3(fs_in.texCoords / renderScale, depth) * 2.0f - 1.0f, 1.0f);
+    world_coords /= world_coords.w;
     vec4 prev_pos = prev_MVP * world_coords;
     prev_pos /= prev_pos.w;
     vec4 curr_pos = curr_MVP * world_coords;
@@ -1,8 +1,10 @@
 #version 460 core
 
-out vec4 color;
+layout (location = 0) out vec4 color;
+layout (location = 1) out vec4 revealage;
 
 uniform sampler2D particle;
+uniform int oitPass;
 
 in GS_OUT
 {
@@ -10,6 +12,8 @@ in GS_OUT
 	float lifetimeRatio;
 } fs_in;
 
+#include "oit.glsl"
+
 void main()
 {
 	color = texture(particle, fs_in.texCoords);
@@ -20,4 +24,14 @@ void main()
 	//color.a *= fs_in.lifetimeRatio * 0.75f;
 	//color.a *= fs_in.lifetimeRatio;
 	//color.a *= 0.25f;
+
+	revealage = vec4(0.0f); // leaves the bright color untouched
+
+	// weighted blended order independent transparency
+	if(oitPass == 1)
+	{
+		float weight = oitWeight(color.a, gl_FragCoord.z);
+		revealage = vec4(color.a);
+		color = vec4(color.rgb * color.a, color.a) * weight;
+	}
 }
@@ -0,0 +1,134 @@
+#version 460 core
+
+// every per pixel post effect in one pass, straight to the screen
+// enabled effects come as defines : BLOOM, VOLUMETRICS, MOTION_BLUR, SHARPEN, VIGNETTE, COLOR_GRADING
+
+out vec4 fragColor;
+
+in vec2 texCoords;
+
+uniform sampler2D scene;
+uniform sampler2D bloom;
+uniform sampler2D volumetrics;
+uniform sampler2D motionBlur;
+uniform sampler2D ui;
+uniform sampler2D uiBloom;
+uniform int motionBlurStrength;
+uniform int scene_tone_mapping; // 0 = Reinhard, 1 = ACES, 2 = OFF
+uniform int ui_tone_mapping;
+uniform float exposure;
+uniform vec2 renderScale; // rendered part of the full size targets
+uniform float sharpness;
+uniform float saturation;
+uniform float contrast;
+uniform vec3 colorFilter;
+
+const int MOTION_BLUR_SAMPLES = 20;
+
+vec3 sharpen(vec2 uv, vec2 texelSize)
+{
+	// unsharp mask on the cross neighbourhood, clamped to it so no ringing appears
+	vec3 center = texture(scene, uv).rgb;
+	vec3 north = texture(scene, uv + vec2(0.0f, texelSize.y)).rgb;
+	vec3 south = texture(scene, uv - vec2(0.0f, texelSize.y)).rgb;
+	vec3 east = texture(scene, uv + vec2(texelSize.x, 0.0f)).rgb;
+	vec3 west = texture(scene, uv - vec2(texelSize.x, 0.0f)).rgb;
+	vec3 minColor = min(center, min(min(north, south), min(east, west)));
+	vec3 maxColor = max(center, max(max(north, south), max(east, west)));
+	vec3 sharpened = center + sharpness * (center - 0.25f * (north + south + east + west));
+	return clamp(sharpened, minColor, maxColor);
+}
+
+vec3 effects(vec2 uv)
+{
+	// added on top of the scene
+	vec3 color = vec3(0.0f);
+#ifdef BLOOM
+	color += texture(bloom, uv).rgb;
+#endif
+#ifdef VOLUMETRICS
+	color += texture(volumetrics, uv).rgb;
+#endif
+	return color;
+}
+
+vec3 gammaCorrection(vec3 c)
+{
+	float gamma = 1.0/2.2;
+	return pow(c, vec3(gamma));
+}
+
+vec3 reinhard(vec3 data)
+{
+	return data / (data + 1.0f);
+}
+
+vec3 ACES_tone_mapping(vec3 data)
+{
+	float a = 2.51f;
+	float b = 0.03f;
+	float c = 2.43f;
+	float d = 0.59f;
+	float e = 0.14f;
+	return clamp((data*(a*data+b))/(data*(c*data+d)+e),0.0f, 1.0f);
+}
+
+vec3 toneMapping(vec3 color, int mode)
+{
+	if(mode == 0)
+		return reinhard(color);
+	else if(mode == 1)
+		return ACES_tone_mapping(color);
+	return color;
+}
+
+void main()
+{
+	vec2 texelSize = 1.0f / textureSize(scene, 0);
+
+	// screen coordinates to the rendered part, kept off its unwritten border
+	vec2 maxUV = renderScale - 0.5f * texelSize;
+	vec2 uv = min(texCoords * renderScale, maxUV);
+
+#ifdef SHARPEN
+	vec3 color = sharpen(uv, texelSize) + effects(uv);
+#else
+	vec3 color = texture(scene, uv).rgb + effects(uv);
+#endif
+
+#ifdef MOTION_BLUR
+	vec2 motionBlurVec = texture(motionBlur, uv).rg * motionBlurStrength;
+	vec2 step = texelSize * motionBlurVec * renderScale;
+	for(int i = 0; i < MOTION_BLUR_SAMPLES; ++i)
+	{
+		vec2 blurUV = min(uv + step * i, maxUV);
+		color += texture(scene, blurUV).rgb + effects(blurUV);
+	}
+	color /= (MOTION_BLUR_SAMPLES+1);
+#endif
+
+#ifdef VIGNETTE
+	float dist = distance(texCoords, vec2(0.5, 0.5));
+	color *= 1.0f - dist;
+#endif
+
+	color = toneMapping(color * exposure, scene_tone_mapping);
+
+#ifdef COLOR_GRADING
+	// on the display referred color : tint, saturation around the luminance, contrast around middle grey
+	color *= colorFilter;
+	float luminance = dot(color, vec3(0.2126f, 0.7152f, 0.0722f));
+	color = mix(vec3(luminance), color, saturation);
+	color = max((color - 0.5f) * contrast + 0.5f, 0.0f);
+#endif
+
+	vec3 sceneColor = gammaCorrection(color);
+
+	// user interface, opaque where it was drawn
+	vec4 uiColor = texture(ui, texCoords);
+	vec3 userInterface = gammaCorrection(toneMapping(uiColor.rgb + texture(uiBloom, texCoords).rgb, ui_tone_mapping));
+	if(uiColor.a != 0.0f)
+		fragColor = vec4(userInterface, 1.0f);
+	else
+		fragColor = vec4(userInterface + sceneColor, 1.0f);
+}
@@ -1,7 +1,6 @@
 #version 460 core
 
 uniform sampler2D diffuse;
-uniform int hasDiffuse;
 
 float linearizeDepth(float depth)
 {
@@ -12,7 +11,7 @@ float linearizeDepth(float depth)
 	return z / far;
 }
 
-in GS_OUT
+in VS_OUT
 {
 	vec2 texCoords;
 	vec4 fragPos;
@@ -23,9 +22,11 @@ uniform vec3 lightPosition;
 
 void main()
 {
-	if(hasDiffuse == 1 && texture(diffuse, fs_in.texCoords).a == 0.0f)
+#ifdef ALPHA_TEST
+	if(texture(diffuse, fs_in.texCoords).a == 0.0f)
 		gl_FragDepth = 1.0f;
 	else
+#endif
 	{
 		if(omnilightFragDepth)
 		{
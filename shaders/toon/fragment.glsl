@@ -5,18 +5,21 @@ layout (location = 1) out vec4 brightColor;
 
 struct Light
 {
-	int type; // 0 => point, 1 => directional, 2 => spot
+	mat4 lightSpaceMatrix;
+	vec4 atlasRegion; // xy offset, zw scale in the shadow atlas
 	vec3 position;
+	int type; // 0 => point, 1 => directional, 2 => spot
 	vec3 direction;
 	float cutOff;
+	vec3 ambientStrength;
 	float outerCutOff;
+	vec3 diffuseStrength;
 	float kc;
+	vec3 specularStrength;
 	float kl;
 	float kq;
-	vec3 ambientStrength;
-	vec3 diffuseStrength;
-	vec3 specularStrength;
-	mat4 lightSpaceMatrix;
+	int shadowLayer; // layer in the omni shadow cube map array, -1 without shadow
+	float range;
 };
 
 struct Material
@@ -27,16 +30,11 @@ struct Material
 	float opacity;
 	float shininess;
 	sampler2D diffuse;
-	int hasDiffuse;
 	sampler2D specular;
-	int hasSpecular;
 	sampler2D normal;
-	int hasNormal;
 	vec3 emissiveColor;
 	float emissionIntensity;
 	sampler2D emissionMap;
-	int hasEmission;
-	int nbTextures;
 };
 
 struct Camera
@@ -55,16 +53,22 @@ in VS_OUT
 uniform Camera cam;
 
 uniform int shadowOn;
-uniform int lightCount;
-uniform Light light[10];
-uniform sampler2D depthMap[10];
-uniform samplerCube omniDepthMap[10];
-uniform int pointLightCount;
+uniform sampler2D shadowAtlas;
+uniform samplerCubeArray omniShadowMaps;
+
+// clustered lights, lightGrid holds (first, count) into lightIndex per cluster
+layout (std430, binding = 0) readonly buffer LightBuffer { Light light[]; };
+layout (std430, binding = 1) readonly buffer LightGrid { uvec2 lightGrid[]; };
+layout (std430, binding = 2) readonly buffer LightIndexList { uint lightIndex[]; };
+uniform ivec3 clusterGrid;
+uniform vec2 clusterDepth; // near, far
+uniform mat4 view;
 
 uniform Material material;
 uniform sampler2D ssao;
 uniform int hasSSAO;
 uniform vec2 viewport;
+uniform int oitPass; // accumulation + revealage outputs
 
 float linearizeDepth(float depth)
 {
@@ -78,16 +82,13 @@ float linearizeDepth(float depth)
 vec3 calculateDiffuse(vec3 lightDir, vec3 diffuseStrength, vec3 objColor)
 {
 	vec3 norm;
-	if(material.hasNormal == 1)
-	{
-		norm = texture(material.normal, fs_in.texCoords).rgb;
-		norm = normalize(norm * 2.0f - 1.0f);
-		lightDir = fs_in.TBN * lightDir;
-	}
-	else
-	{
-		norm = normalize(fs_in.normal);
-	}
+#ifdef NORMAL_MAP
+	norm = texture(material.normal, fs_in.texCoords).rgb;
+	norm = normalize(norm * 2.0f - 1.0f);
+	lightDir = fs_in.TBN * lightDir;
+#else
+	norm = normalize(fs_in.normal);
+#endif
 	float discrete = max(dot(norm, -lightDir), 0.0f);
 	if(discrete < 0.33f) {
 		discrete = 0.15f;
@@ -103,18 +104,15 @@ vec3 calculateSpecular(vec3 viewPos, vec3 lightDir, vec3 specularStrength, vec3
 {
 	vec3 fragPos;
 	vec3 norm;
-	if(material.hasNormal == 1)
-	{
-		fragPos = fs_in.TBN * fs_in.fragPos;
-		norm = texture(material.normal, fs_in.texCoords).rgb;
-		norm = normalize(norm * 2.0f - 1.0f);
-		lightDir = fs_in.TBN * lightDir;
-	}
-	else
-	{
-		fragPos = fs_in.fragPos;
-		norm = normalize(fs_in.normal);
-	}
+#ifdef NORMAL_MAP
+	fragPos = fs_in.TBN * fs_in.fragPos;
+	norm = texture(material.normal, fs_in.texCoords).rgb;
+	norm = normalize(norm * 2.0f - 1.0f);
+	lightDir = fs_in.TBN * lightDir;
+#else
+	fragPos = fs_in.fragPos;
+	norm = normalize(fs_in.normal);
+#endif
 	vec3 viewDir = normalize(viewPos - fragPos);
 	vec3 halfwayDir = normalize(-lightDir + viewDir);
 	float discrete = max(dot(norm, halfwayDir), 0.0f);
@@ -132,7 +130,7 @@ vec3 calculateSpecular(vec3 viewPos, vec3 lightDir, vec3 specularStrength, vec3
 float calculateShadow(vec4 fragPosLightSpace, vec3 lightDir, int l)
 {
 	float shadow = 0.0;
-	vec2 texelSize = 1.0 / textureSize(depthMap[l - pointLightCount], 0);
+	vec2 texelSize = 1.0 / textureSize(shadowAtlas, 0);
 	float bias = max(0.005 * (1.0 - dot(fs_in.normal, -lightDir)), 0.0005);
 
 	// perform perspective divide
@@ -140,7 +138,8 @@ float calculateShadow(vec4 fragPosLightSpace, vec3 lightDir, int l)
 	
 	// transform to [0,1] range
 	projCoords = (projCoords * 0.5) + 0.5;
-	if(projCoords.z > 1.0)
+	vec4 region = light[l].atlasRegion;
+	if(projCoords.z > 1.0 || region.z == 0.0 || any(lessThan(projCoords.xy, vec2(0.0))) || any(greaterThan(projCoords.xy, vec2(1.0))))
 	{
 		shadow = 0.0;
 		return shadow;
@@ -148,12 +147,14 @@ float calculateShadow(vec4 fragPosLightSpace, vec3 lightDir, int l)
 
 	// get depth of current fragment from light's perspective
 	float currentDepth = projCoords.z;
+	vec2 regionMin = region.xy + texelSize * 0.5;
+	vec2 regionMax = region.xy + region.zw - texelSize * 0.5;
 	
 	for(int x = -1; x <= 1; ++x)
 	{
 		for(int y = -1; y <= 1; ++y)
 		{
-			float depth = texture(depthMap[l - pointLightCount], projCoords.xy + vec2(x, y) * texelSize).r;
+			float depth = texture(shadowAtlas, clamp(region.xy + projCoords.xy * region.zw + vec2(x, y) * texelSize, regionMin, regionMax)).r;
 			shadow += (currentDepth - bias) > depth ? 1.0 : 0.0;
 		}
 	}
@@ -178,12 +179,15 @@ float calculateOmniShadow(vec3 fragPos, vec3 lightPos, int l)
 	float viewDistance = length(cam.viewPos - fragPos);
 	float diskRadius = (1.0 + (viewDistance / 100.0f)) / 25.0;
 	
+	if(light[l].shadowLayer < 0)
+		return 0.0;
+
 	vec3 distFragLight = fragPos - lightPos;
 	float currentDepth = length(distFragLight);
 
 	for(int i = 0; i < samples; ++i)
 	{
-		float closestDepth = texture(omniDepthMap[l], distFragLight + sampleOffsetDirections[i] * diskRadius).r;
+		float closestDepth = texture(omniShadowMaps, vec4(distFragLight + sampleOffsetDirections[i] * diskRadius, light[l].shadowLayer)).r;
 		closestDepth *= 100.0f;
 		if(currentDepth - bias > closestDepth)
 			shadow += 1.0f;
@@ -194,32 +198,71 @@ float calculateOmniShadow(vec3 fragPos, vec3 lightPos, int l)
 	return shadow;
 }
 
+uint clusterIndex()
+{
+	// screen tile, then exponential view depth slice
+	float depth = clamp(-(view * vec4(fs_in.fragPos, 1.0f)).z, clusterDepth.x, clusterDepth.y);
+	int slice = min(int(log(depth / clusterDepth.x) / log(clusterDepth.y / clusterDepth.x) * clusterGrid.z), clusterGrid.z - 1);
+	ivec2 tile = min(ivec2(gl_FragCoord.xy / viewport * vec2(clusterGrid.xy)), clusterGrid.xy - 1);
+	return uint((slice * clusterGrid.y + tile.y) * clusterGrid.x + tile.x);
+}
+
+#ifdef DITHER_FADE
+flat in float fade;
+
+#include "noise.glsl"
+#endif
+
+#include "oit.glsl"
+
 void main()
 {
-	// early discard
-	if(material.nbTextures > 0)
-	{
-		if(texture(material.diffuse, fs_in.texCoords).a == 0.0f)
-			discard;
-	}
+#ifdef DITHER_FADE
+	// complementary to the impostor dither, the two never cover the same pixel
+	if(interleavedGradientNoise(gl_FragCoord.xy) < fade)
+		discard;
+#endif
+
+	// material inputs, the branches are resolved by the permutation defines
+#ifdef DIFFUSE_MAP
+	vec4 diffuseSample = texture(material.diffuse, fs_in.texCoords);
+#ifdef ALPHA_TEST
+	if(diffuseSample.a == 0.0f)
+		discard;
+#endif
+	vec3 ambientColor = diffuseSample.rgb;
+	vec3 diffuseColor = diffuseSample.rgb;
+	float alpha = diffuseSample.a * material.opacity;
+#else
+	vec3 ambientColor = material.color_ambient;
+	vec3 diffuseColor = material.color_diffuse;
+	float alpha = material.opacity;
+#endif
+#ifdef SPECULAR_MAP
+	vec3 specularColor = texture(material.specular, fs_in.texCoords).rgb;
+#else
+	vec3 specularColor = material.color_specular;
+#endif
 
 	// start
-	vec2 fragCoords = gl_FragCoord.xy / viewport;
+	vec2 fragCoords = gl_FragCoord.xy / vec2(textureSize(ssao, 0)); // full size target, partly rendered
 	float ao = (hasSSAO == 1) ? texture(ssao, fragCoords).r : 1.0f;
-	vec3 color;
+	vec3 color = vec3(0.0f);
 
-	for(int l = 0; l < lightCount; ++l)
+	// lights reaching the fragment's cluster
+	uvec2 cluster = lightGrid[clusterIndex()];
+	for(uint n = 0; n < cluster.y; ++n)
 	{
+		int l = int(lightIndex[cluster.x + n]);
 		vec3 lightPos = light[l].position;
 		vec3 fragPos = fs_in.fragPos;
 		vec3 viewPos = cam.viewPos;
 
-		if(material.hasNormal == 1)
-		{
-			lightPos = fs_in.TBN * light[l].position;
-			fragPos = fs_in.TBN * fs_in.fragPos;
-			viewPos = fs_in.TBN * cam.viewPos;
-		}
+#ifdef NORMAL_MAP
+		lightPos = fs_in.TBN * light[l].position;
+		fragPos = fs_in.TBN * fs_in.fragPos;
+		viewPos = fs_in.TBN * cam.viewPos;
+#endif
 
 		vec3 lightDir;
 		float dist = length(lightPos - fragPos);
@@ -243,6 +286,8 @@ void main()
 			theta = dot(lightDir, normalize(light[l].direction));
 			epsilon = light[l].cutOff - light[l].outerCutOff;
 			intensity = clamp((theta - light[l].outerCutOff) / epsilon, 0.0f, 1.0f);
+			// inverse square, matches the range used by the light clusters
+			attenuation = 1.0f / (dist * dist);
 		}
 
 		// calculate shadow
@@ -254,100 +299,39 @@ void main()
 		else if(shadowOn == 0)
 			shadow = 0.0f;
 
-		if(material.nbTextures > 0)
+		// ambient
+		vec3 ambient = ao * light[l].ambientStrength * ambientColor;
+
+		if(light[l].type == 2 && theta > light[l].outerCutOff)
 		{
-			// ambient
-			vec3 ambient = ao * light[l].ambientStrength * texture(material.diffuse, fs_in.texCoords).rgb;
-
-			if(light[l].type == 2 && theta > light[l].outerCutOff)
-			{
-				// diffuse
-				vec3 diffuse = calculateDiffuse(lightDir, light[l].diffuseStrength, texture(material.diffuse, fs_in.texCoords).rgb);
-
-				// specular
-				vec3 specular;
-				if(material.hasSpecular == 1)
-					specular = calculateSpecular(viewPos, lightDir, light[l].specularStrength, texture(material.specular, fs_in.texCoords).rgb);
-				else
-					specular = calculateSpecular(viewPos, lightDir, light[l].specularStrength, material.color_specular);
-				
-				diffuse = diffuse * intensity * (1.0 - shadow);
-				specular = specular * intensity * (1.0 - shadow);
-			
-				// putting it all together
-				color += ambient + diffuse + specular;
-			}
-			else if(light[l].type == 2)
-			{
-				color += ambient;
-			}
-			else
-			{
-				// diffuse
-				vec3 diffuse = calculateDiffuse(lightDir, light[l].diffuseStrength, texture(material.diffuse, fs_in.texCoords).rgb) * (1.0 - shadow);
-
-				// specular
-				vec3 specular;
-				if(material.hasSpecular == 1)
-					specular = calculateSpecular(viewPos, lightDir, light[l].specularStrength, texture(material.specular, fs_in.texCoords).rgb) * (1.0 - shadow);
-				else
-					specular = calculateSpecular(viewPos, lightDir, light[l].specularStrength, material.color_specular) * (1.0 - shadow);
-				
-				// putting it all together
-				if(light[l].type == 0)
-					color += (ambient + diffuse + specular) * attenuation;
-				else
-					color += (ambient + diffuse + specular);
-			}
+			vec3 diffuse = calculateDiffuse(lightDir, light[l].diffuseStrength, diffuseColor);
+			vec3 specular = calculateSpecular(viewPos, lightDir, light[l].specularStrength, specularColor);
+			color += (ambient + (diffuse + specular) * intensity * (1.0 - shadow)) * attenuation;
+		}
+		else if(light[l].type == 2)
+		{
+			color += ambient * attenuation;
 		}
-
 		else
 		{
-			// ambient
-			vec3 ambient = ao * light[l].ambientStrength * material.color_ambient;
-
-			if(light[l].type == 2 && theta > light[l].outerCutOff)
-			{
-				// diffuse
-				vec3 diffuse = calculateDiffuse(lightDir, light[l].diffuseStrength, material.color_diffuse) * (1.0 - shadow);
-
-				// specular
-				vec3 specular = calculateSpecular(viewPos, lightDir, light[l].specularStrength, material.color_specular) * (1.0 - shadow);
-				
-				diffuse = diffuse * intensity;
-				specular = specular * intensity;
-			
-				// putting it all together
-				color += ambient + diffuse + specular;
-			}
-			else if(light[l].type == 2)
-			{
-				color += ambient;
-			}
+			vec3 diffuse = calculateDiffuse(lightDir, light[l].diffuseStrength, diffuseColor) * (1.0 - shadow);
+			vec3 specular = calculateSpecular(viewPos, lightDir, light[l].specularStrength, specularColor) * (1.0 - shadow);
+
+			// putting it all together
+			if(light[l].type == 0)
+				color += (ambient + diffuse + specular) * attenuation;
 			else
-			{
-				// diffuse
-				vec3 diffuse = calculateDiffuse(lightDir, light[l].diffuseStrength, material.color_diffuse) * (1.0 - shadow);
-
-				// specular
-				vec3 specular = calculateSpecular(viewPos, lightDir, light[l].specularStrength, material.color_specular) * (1.0 - shadow);
-
-				// putting it all together
-				if(light[l].type == 0)
-					color += (ambient + diffuse + specular) * attenuation;
-				else
-					color += (ambient + diffuse + specular);
-			}
+				color += (ambient + diffuse + specular);
 		}
 	}
 
-	float alpha = (material.hasDiffuse == 1) ? texture(material.diffuse, fs_in.texCoords).a * material.opacity : material.opacity;
 	fragColor = vec4(color, alpha);
 
 	// get brightness
 	vec3 emission = material.emissiveColor;
-	if(material.hasEmission == 1)
-		emission = texture(material.emissionMap, fs_in.texCoords).rgb;
+#ifdef EMISSION_MAP
+	emission = texture(material.emissionMap, fs_in.texCoords).rgb;
+#endif
 	emission *= material.emissionIntensity;
 	float brightness = dot(fragColor.rgb + emission, vec3(0.2126f, 0.7152f, 0.0722f));
 
@@ -360,4 +344,12 @@ void main()
 	}
 	else
 		brightColor = vec4(0.0f, 0.0f, 0.0f, 1.0f);
+
+	// weighted blended order independent transparency
+	if(oitPass == 1)
+	{
+		float weight = oitWeight(alpha, gl_FragCoord.z);
+		fragColor = vec4(fragColor.rgb * alpha, alpha) * weight;
+		brightColor = vec4(alpha);
+	}
 }
@@ -4,11 +4,13 @@ out vec4 color;
 
 in vec2 texCoords;
 
-uniform sampler2D fragWorldPos;
+uniform sampler2D depthMap;
+uniform mat4 inv_viewProj;
+uniform vec2 renderScale; // rendered part of the full size targets
 
 void main()
 {
-	vec2 texelSize = 2.0f / textureSize(fragWorldPos, 0);
+	vec2 texelSize = 2.0f / textureSize(depthMap, 0);
 	
 	// orientation
 	vec2 N = vec2(0.0f, 1.0f);
@@ -16,5 +18,15 @@ void main()
 	vec2 E = vec2(1.0f, 0.0f);
 	vec2 W = vec2(-1.0f, 0.0f);
 
-    color = texture(fragWorldPos, texCoords + texelSize * (S+W));
+	// world position rebuilt from depth, background stays at the origin
+	// depth kept in alpha for reprojection and upsampling
+	vec2 uv = texCoords + texelSize * (S+W);
+	float depth = texture(depthMap, uv).r;
+	if(depth == 1.0f)
+	{
+		color = vec4(0.0f, 0.0f, 0.0f, depth);
+		return;
+	}
+	vec4 fragWorldPos = inv_viewProj * vec4(vec3(uv / renderScale, depth) * 2.0f - 1.0f, 1.0f);
+	color = vec4(fragWorldPos.xyz / fragWorldPos.w, depth);
 }
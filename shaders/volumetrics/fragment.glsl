@@ -12,6 +12,8 @@ struct Light
     float kl;
     float kq;
 	mat4 lightSpaceMatrix;
+	vec4 atlasRegion; // xy offset, zw scale in the shadow atlas
+	int shadowLayer; // layer in the omni shadow cube map array
     int isVolumetric;
     int hasFog;
     float tau;
@@ -30,12 +32,13 @@ struct Camera
 
 uniform float time;
 uniform int N; // raymarching steps
+uniform float jitter; // per frame ray offset, accumulated temporally
 uniform sampler2D worldPosMap;
 uniform Camera cam;
 uniform int lightCount;
 uniform Light light[10];
-uniform sampler2D depthMap[10];
-uniform samplerCube omniDepthMap[10];
+uniform sampler2D shadowAtlas;
+uniform samplerCubeArray omniShadowMaps;
 uniform int pointLightCount;
 
 in VS_OUT
@@ -55,7 +58,8 @@ float fetchShadow(vec4 fragPosLightSpace, vec3 lightDir, int l)
 	
 	// transform to [0,1] range
 	projCoords = (projCoords * 0.5) + 0.5;
-	if(projCoords.z > 1.0)
+	vec4 region = light[l].atlasRegion;
+	if(projCoords.z > 1.0 || region.z == 0.0 || any(lessThan(projCoords.xy, vec2(0.0))) || any(greaterThan(projCoords.xy, vec2(1.0))))
 	{
 		shadow = 0.0;
 		return shadow;
@@ -63,7 +67,7 @@ float fetchShadow(vec4 fragPosLightSpace, vec3 lightDir, int l)
 
 	// get depth of current fragment from light's perspective
 	float currentDepth = projCoords.z;
-	float depth = texture(depthMap[l - pointLightCount], projCoords.xy).r;
+	float depth = texture(shadowAtlas, region.xy + projCoords.xy * region.zw).r;
 	shadow = (currentDepth - bias) > depth ? 1.0 : 0.0;
 	return shadow;
 }
@@ -76,7 +80,7 @@ float fetchOmniShadow(vec3 fragPos, vec3 lightPos, int l)
 	vec3 distFragLight = fragPos - lightPos;
 	float currentDepth = length(distFragLight);
 	
-	float closestDepth = texture(omniDepthMap[l], distFragLight).r;
+	float closestDepth = texture(omniShadowMaps, vec4(distFragLight, light[l].shadowLayer)).r;
 	closestDepth *= cam.far_plane; // times far_plane because closestDepth sits in range [0 - 1]
 	if((currentDepth - bias) > closestDepth)
 		shadow = 1.0;
@@ -186,14 +190,14 @@ void main()
     vec3 accumFog = vec3(0.0f);
     float light_contribution = 0.0f;
     float ratio = 0.0f;
+    float dither_value = fract(dither_pattern[(int(gl_FragCoord.x) % 4) * 4 + (int(gl_FragCoord.y) % 4)] + jitter);
     for(int i = 0; i < lightCount; ++i)
     {
         if(light[i].isVolumetric == 0)
             continue;
         for(int j = 0; j < N; ++j)
         {
-            float dither_value = dither_pattern[ (int(gl_FragCoord.x) % 4)* 4 + (int(gl_FragCoord.y) % 4) ];
-            vec3 current_position_world = fragWorldPos.xyz + dither_value * (raymarching_dir * step * j);
+            vec3 current_position_world = fragWorldPos.xyz + (float(j) + dither_value) * step * raymarching_dir;
 			// >>>>> get visibility
 			float visibility = getFragVisibility(current_position_world, i);
 			// <<<<< get visibility
@@ -0,0 +1,51 @@
+#version 460 core
+
+out vec4 color;
+
+in VS_OUT
+{
+	vec2 texCoords;
+} fs_in;
+
+uniform sampler2D current; // this frame, few jittered steps
+uniform sampler2D history;
+uniform sampler2D worldPosDepth; // depth in alpha
+uniform mat4 inv_viewProj;
+uniform mat4 prev_viewProj;
+uniform int historyValid;
+uniform float blendFactor; // weight of the current frame
+uniform vec2 renderScale; // rendered part of the full size targets
+
+void main()
+{
+	vec3 currentColor = texture(current, fs_in.texCoords).rgb;
+
+	// neighbourhood bounds, rejects history that no longer matches the scene
+	vec2 texelSize = 1.0f / vec2(textureSize(current, 0));
+	vec3 minColor = currentColor;
+	vec3 maxColor = currentColor;
+	for(int x = -1; x <= 1; ++x)
+	{
+		for(int y = -1; y <= 1; ++y)
+		{
+			vec3 c = texture(current, fs_in.texCoords + vec2(x, y) * texelSize).rgb;
+			minColor = min(minColor, c);
+			maxColor = max(maxColor, c);
+		}
+	}
+
+	// reprojection with last frame camera
+	float depth = texture(worldPosDepth, fs_in.texCoords).a;
+	vec4 worldPos = inv_viewProj * vec4(vec3(fs_in.texCoords / renderScale, depth) * 2.0f - 1.0f, 1.0f);
+	vec4 prevPos = prev_viewProj * vec4(worldPos.xyz / worldPos.w, 1.0f);
+	vec2 prevUV = (prevPos.xy / prevPos.w) * 0.5f + 0.5f;
+
+	if(historyValid == 0 || any(lessThan(prevUV, vec2(0.0f))) || any(greaterThan(prevUV, vec2(1.0f))))
+	{
+		color = vec4(currentColor, 1.0f);
+		return;
+	}
+
+	vec3 historyColor = clamp(texture(history, prevUV * renderScale).rgb, minColor, maxColor);
+	color = vec4(mix(historyColor, currentColor, blendFactor), 1.0f);
+}
@@ -1,12 +1,15 @@
 #version 460 core
 
 layout (location = 0) in vec3 aPos;
-layout (location=  2) in vec2 aTex;
+layout (location = 2) in vec2 aTex;
 
-out vec2 texCoords;
+out VS_OUT
+{
+	vec2 texCoords;
+} vs_out;
 
 void main()
 {
 	gl_Position = vec4(aPos, 1.0f);
-	texCoords = aTex;
+	vs_out.texCoords = aTex;
 }
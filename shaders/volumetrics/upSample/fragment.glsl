@@ -0,0 +1,56 @@
+#version 460 core
+
+out vec4 color;
+
+in VS_OUT
+{
+	vec2 texCoords;
+} fs_in;
+
+uniform sampler2D volumetrics; // low res
+uniform sampler2D worldPosDepth; // low res, depth in alpha
+uniform sampler2D depthMap; // full res
+uniform float near_plane;
+uniform float far_plane;
+
+float linearizeDepth(float depth)
+{
+	float z_n = 2.0 * depth - 1.0;
+	return 2.0 * near_plane * far_plane / (far_plane + near_plane - z_n * (far_plane - near_plane));
+}
+
+void main()
+{
+	float depth = linearizeDepth(texture(depthMap, fs_in.texCoords).r);
+
+	// bilinear footprint of the low res texels, weighted by depth similarity
+	vec2 lowSize = vec2(textureSize(volumetrics, 0));
+	vec2 position = fs_in.texCoords * lowSize - 0.5f;
+	vec2 f = fract(position);
+	vec2 origin = (floor(position) + 0.5f) / lowSize;
+
+	vec3 result = vec3(0.0f);
+	float weights = 0.0f;
+	float closest = 1e30f;
+	vec3 closestColor = vec3(0.0f);
+	for(int x = 0; x < 2; ++x)
+	{
+		for(int y = 0; y < 2; ++y)
+		{
+			vec2 uv = origin + vec2(x, y) / lowSize;
+			vec3 c = texture(volumetrics, uv).rgb;
+			float difference = abs(linearizeDepth(texture(worldPosDepth, uv).a) - depth);
+			float bilinear = ((x == 0) ? 1.0f - f.x : f.x) * ((y == 0) ? 1.0f - f.y : f.y);
+			float weight = bilinear / (1e-3f + difference);
+			result += c * weight;
+			weights += weight;
+			if(difference < closest)
+			{
+				closest = difference;
+				closestColor = c;
+			}
+		}
+	}
+
+	color = vec4((weights > 1e-4f) ? result / weights : closestColor, 1.0f);
+}
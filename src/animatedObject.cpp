@@ -92,18 +92,12 @@ glm::mat4 JointAnim::interpolateScaling(float t)
 
 Animator::Animator() :
 	currentTime(0.0f)
-{
-	for(int i{0}; i < 50; ++i)
-		finalJointTransform[i] = glm::mat4(1.0f);
-}
+{}
 
 Animator::Animator(std::shared_ptr<Animation> animation) :
 	currentTime(0.0f),
 	currentAnimation(animation)
-{
-	for(int i{0}; i < 50; ++i)
-		finalJointTransform[i] = glm::mat4(1.0f);
-}
+{}
 
 void Animator::updateAnimation(float delta)
 {
@@ -141,6 +135,15 @@ void Animator::stopAnimation()
 	}
 }
 
+void Animator::sampleAnimation(std::shared_ptr<Animation> & animation, float ticks)
+{
+	// pose of a clip at a given time, joints it does not animate keep the identity
+	currentAnimation = animation;
+	currentTime = fmod(ticks, animation->duration);
+	std::fill(finalJointTransform.begin(), finalJointTransform.end(), glm::mat4(1.0f));
+	calculateJointTransform(animation->rootJoint, glm::mat4(1.0f));
+}
+
 void Animator::calculateJointTransform(std::shared_ptr<Joint> joint, glm::mat4 parentTransform)
 {
 	glm::mat4 jointTransform;
@@ -164,7 +167,8 @@ void Animator::calculateJointTransform(std::shared_ptr<Joint> joint, glm::mat4 p
 
 		int index = jointAnim->joint->getId();
 		glm::mat4 offset = jointAnim->joint->getOffsetMatrix();
-		finalJointTransform[index] = currentAnimation->globalInverseTransform * globalTransformation * offset;
+		if(index < finalJointTransform.size())
+			finalJointTransform[index] = currentAnimation->globalInverseTransform * globalTransformation * offset;
 
 		for(int i{0}; i < joint->getChildren().size(); ++i)
 		{
@@ -173,7 +177,12 @@ void Animator::calculateJointTransform(std::shared_ptr<Joint> joint, glm::mat4 p
 	}
 }
 
-std::array<glm::mat4, 50> & Animator::getFinalJointTransform()
+void Animator::setJointCount(int count)
+{
+	finalJointTransform.assign(count, glm::mat4(1.0f));
+}
+
+std::vector<glm::mat4> & Animator::getFinalJointTransform()
 {
 	return finalJointTransform;
 }
@@ -189,8 +198,14 @@ std::shared_ptr<Animation> & Animator::getCurrentAnimation()
 
 AnimatedObject::AnimatedObject(const std::string & path, glm::mat4 p_model) :
 	Object(p_model),
-	animator(std::make_unique<Animator>())
+	animator(std::make_unique<Animator>()),
+	skinned(false),
+	jointCount(0),
+	paletteAlignment(256),
+	paletteOffset(-1),
+	paletteFrame(0)
 {
+	glGetIntegerv(GL_SHADER_STORAGE_BUFFER_OFFSET_ALIGNMENT, &paletteAlignment);
 	load(path);
 }
 
@@ -206,19 +221,14 @@ std::unique_ptr<Animator> & AnimatedObject::getAnimator()
 	return animator;
 }
 
-void AnimatedObject::draw(Shader& shader, std::array<glm::mat4, 50> & finalJointTransform, struct IBL_DATA * iblData, DRAWING_MODE mode)
+void AnimatedObject::draw(Shader& shader, std::vector<glm::mat4> & finalJointTransform, struct IBL_DATA * iblData, DRAWING_MODE mode)
 {
 	shader.use();
-	shader.setInt("animated", 1);
-	shader.setMatrix("model", model);
+	shader.setDrawMatrix("model", model);
 
-	for(int i{0}; i < finalJointTransform.size(); ++i)
-	{
-		std::string boneMatrixStr{"bonesMatrices["};
-		boneMatrixStr += std::to_string(i);
-		boneMatrixStr += std::string("]");
-		shader.setMatrix(boneMatrixStr, finalJointTransform[i]);
-	}
+	// meshes skinned this frame by skin() are drawn as static geometry
+	if(!skinned)
+		bindBonePalette(finalJointTransform);
 
 	int meshCount = meshes.size();
 
@@ -228,6 +238,32 @@ void AnimatedObject::draw(Shader& shader, std::array<glm::mat4, 50> & finalJoint
 	}
 }
 
+void AnimatedObject::skin(Shader & cs, std::vector<glm::mat4> & finalJointTransform)
+{
+	cs.use();
+	bindBonePalette(finalJointTransform);
+
+	for(int i{0}; i < meshes.size(); ++i)
+		meshes[i]->skin(cs);
+	skinned = true;
+}
+
+void AnimatedObject::bindBonePalette(std::vector<glm::mat4> & finalJointTransform)
+{
+	// written once per frame into the shared ring buffer, every skinned draw binds the same range
+	RingBuffer & ring = RingBuffer::get();
+	long size = finalJointTransform.size() * sizeof(glm::mat4);
+	if(size == 0)
+		return;
+	if(paletteFrame != ring.getFrame() || paletteOffset < 0)
+	{
+		paletteOffset = ring.push(finalJointTransform.data(), size, paletteAlignment);
+		paletteFrame = ring.getFrame();
+	}
+	if(paletteOffset >= 0)
+		glBindBufferRange(GL_SHADER_STORAGE_BUFFER, BONE_PALETTE_BINDING, ring.getId(), paletteOffset, size);
+}
+
 void AnimatedObject::load(const std::string & path)
 {
 	/*
@@ -302,10 +338,12 @@ void AnimatedObject::loadJointHierarchy(const aiScene * scene)
 
 	// get root bone of skeleton
 	aiNode * rootBone = getRootBone(scene->mRootNode, bonesName);
-	rootJoint = std::make_shared<Joint>(1, rootBone->mName.C_Str());
+	jointCount = 1;
+	rootJoint = std::make_shared<Joint>(jointCount, rootBone->mName.C_Str());
 
-	// compute hierarchy
+	// compute hierarchy, the bone palette holds every joint id
 	computeHierarchy(rootBone, rootJoint, bonesName);
+	animator->setJointCount(jointCount + 1);
 
 	// assign offset matrices to each joint
 	for(int m{0}; m < scene->mNumMeshes; ++m)
@@ -326,8 +364,6 @@ void AnimatedObject::loadJointHierarchy(const aiScene * scene)
 
 void AnimatedObject::computeHierarchy(aiNode* node, std::shared_ptr<Joint> joint, std::vector<std::string> & bNames)
 {
-	static int ID{1};
-
 	nameJoint[joint->getName()] = joint;
 	finalJointTransform[joint->getName()] = glm::mat4(1.0f);
 	for(int i{0}; i < node->mNumChildren; ++i)
@@ -335,8 +371,8 @@ void AnimatedObject::computeHierarchy(aiNode* node, std::shared_ptr<Joint> joint
 		aiNode* child = node->mChildren[i];
 		if(std::find(bNames.begin(), bNames.end(), child->mName.C_Str()) != bNames.end())
 		{
-			ID++;
-			std::shared_ptr<Joint> j = std::make_shared<Joint>(ID, child->mName.C_Str());
+			jointCount++;
+			std::shared_ptr<Joint> j = std::make_shared<Joint>(jointCount, child->mName.C_Str());
 			joint->addChild(j);
 			computeHierarchy(child, j, bNames);
 		}
@@ -545,6 +581,7 @@ std::shared_ptr<Mesh> AnimatedObject::getMesh(aiMesh* mesh, const aiScene* scene
 	aiColor3D color_ambient{0.0f, 0.0f, 0.0f};
 	aiColor3D color_emissive{0.0f, 0.0f, 0.0f};
 	int opaque{1};
+	int orderIndependent{0};
     float opacity{1.0f};
 	float shininess{1.0f};
 	float roughness{0.5f};
@@ -602,6 +639,9 @@ std::shared_ptr<Mesh> AnimatedObject::getMesh(aiMesh* mesh, const aiScene* scene
 				emission_intensity = atof(attr->value());
 				attr = attr->next_attribute();
 				opaque = atoi(attr->value());
+				attr = attr->next_attribute();
+				if(attr)
+					orderIndependent = atoi(attr->value());
 			}
 		}
 	}
@@ -613,6 +653,7 @@ std::shared_ptr<Mesh> AnimatedObject::getMesh(aiMesh* mesh, const aiScene* scene
     material.color_ambient = glm::vec3(color_ambient.r, color_ambient.g, color_ambient.b);
     material.color_emissive = glm::vec3(color_emissive.r, color_emissive.g, color_emissive.b);
 	material.opaque = opaque;
+	material.orderIndependent = orderIndependent;
 	material.opacity = opacity;
 	material.shininess = shininess;
 	material.roughness = roughness;
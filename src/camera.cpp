@@ -38,6 +38,7 @@ Camera::Camera(CAM_TYPE type, glm::ivec2 scrDim, glm::vec3 camPos, glm::vec3 cam
 	nearPlane = near;
 	farPlane = far;
 	projection = glm::perspective(glm::radians(fov), aspectRatio, nearPlane, farPlane);
+	jitter = glm::vec2(0.0f);
 }
 
 void Camera::updateViewMatrix(glm::vec3 vehiclePos, glm::vec3 vehicleDirection, glm::vec3 vehicleUp, float steering, float steeringIncrement, const std::bitset<16> & inputs, std::array<int, 3> & mouse, float delta)
@@ -117,6 +118,7 @@ void Camera::updateProjectionMatrix(int w, int h)
 	screenDim.y = h;
 	float aspectRatio = static_cast<float>(w) / static_cast<float>(h);
 	projection = glm::perspective(glm::radians(fov), aspectRatio, nearPlane, farPlane);
+	jitter = glm::vec2(0.0f);
 }
 
 glm::quat Camera::getRotationQuaternion(int x, int y)
@@ -246,6 +248,15 @@ void Camera::setProjection(glm::ivec2 scrDim, float near, float far)
 	nearPlane = near;
 	farPlane = far;
 	projection = glm::perspective(glm::radians(fov), aspectRatio, nearPlane, farPlane);
+	jitter = glm::vec2(0.0f);
+}
+
+void Camera::setJitter(glm::vec2 offset)
+{
+	// shifts the whole image, the projection stays otherwise unchanged
+	projection[2][0] += offset.x - jitter.x;
+	projection[2][1] += offset.y - jitter.y;
+	jitter = offset;
 }
 
 CAM_TYPE Camera::getType()
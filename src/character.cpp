@@ -58,6 +58,11 @@ void Character::draw(Shader & shader, struct IBL_DATA * iblData, DRAWING_MODE mo
 	character->draw(shader, character->getAnimator()->getFinalJointTransform(), iblData, mode);
 }
 
+void Character::skin(Shader & cs)
+{
+	character->skin(cs, character->getAnimator()->getFinalJointTransform());
+}
+
 std::unique_ptr<AnimatedObject> & Character::get()
 {
 	return character;
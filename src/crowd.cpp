@@ -0,0 +1,235 @@
+#include "crowd.hpp"
+
+Crowd::Crowd(const std::string & path, int aBakeRate) :
+	object(std::make_unique<AnimatedObject>(path)),
+	animationTexture(0),
+	instanceBuffer(0),
+	bakeRate(aBakeRate),
+	padding(0.0f),
+	time(0.0f),
+	dirty(false)
+{
+	bake();
+
+	// bones come from the baked texture instead of the bone palette
+	for(auto & mesh : object->getMeshes())
+	{
+		int & permutation = mesh->getMaterial().permutation;
+		if(permutation & MATERIAL_SKINNED)
+			permutation = (permutation & ~MATERIAL_SKINNED) | MATERIAL_CROWD;
+	}
+
+	glGenBuffers(1, &instanceBuffer);
+}
+
+Crowd::~Crowd()
+{
+	glDeleteTextures(1, &animationTexture);
+	glDeleteBuffers(1, &instanceBuffer);
+}
+
+void Crowd::bake()
+{
+	std::unique_ptr<Animator> & animator = object->getAnimator();
+	int jointCount = animator->getFinalJointTransform().size();
+
+	// bind pose bounds of the vertices each joint moves, and of the whole model
+	struct AABB aabb = object->getAABB();
+	glm::vec3 aabbMin(aabb.xMin, aabb.yMin, aabb.zMin);
+	glm::vec3 aabbMax(aabb.xMax, aabb.yMax, aabb.zMax);
+	glm::vec3 bindCenter = (aabbMin + aabbMax) * 0.5f;
+	float bindRadius = glm::length(aabbMax - bindCenter);
+	std::vector<glm::vec3> jointMin(jointCount, glm::vec3(std::numeric_limits<float>::max()));
+	std::vector<glm::vec3> jointMax(jointCount, glm::vec3(std::numeric_limits<float>::lowest()));
+	for(auto & mesh : object->getMeshes())
+	{
+		for(const Vertex & v : mesh->getVertices())
+		{
+			for(int i{0}; i < 4; ++i)
+			{
+				int joint = v.bonesID[i];
+				if(joint < 0 || joint >= jointCount || v.weights[i] <= 0.0f)
+					continue;
+				jointMin[joint] = glm::min(jointMin[joint], v.position);
+				jointMax[joint] = glm::max(jointMax[joint], v.position);
+			}
+		}
+	}
+
+	// one row per frame, three texels per joint (rows of its affine matrix)
+	std::vector<glm::vec4> texels;
+	int rows{0};
+	for(auto & animation : object->getAnimations())
+	{
+		float ticksPerSecond = (animation->ticksPerSecond > 0.0f) ? animation->ticksPerSecond : 25.0f;
+		float seconds = animation->duration / ticksPerSecond;
+		int frameCount = std::max(1, static_cast<int>(std::ceil(seconds * bakeRate)));
+		clips.push_back({animation->name, rows, frameCount, 0.0f});
+
+		for(int f{0}; f < frameCount; ++f)
+		{
+			animator->sampleAnimation(animation, f * ticksPerSecond / bakeRate);
+			std::vector<glm::mat4> & transforms = animator->getFinalJointTransform();
+			for(int j{0}; j < transforms.size(); ++j)
+			{
+				glm::mat4 & m = transforms[j];
+				texels.push_back(glm::row(m, 0));
+				texels.push_back(glm::row(m, 1));
+				texels.push_back(glm::row(m, 2));
+
+				// skinned vertices blend the moved joint spheres, so their union bounds the pose
+				if(j >= jointCount || jointMin[j].x > jointMax[j].x)
+					continue;
+				glm::vec3 center = (jointMin[j] + jointMax[j]) * 0.5f;
+				float radius = glm::length(jointMax[j] - center);
+				float scale = glm::max(glm::length(glm::vec3(m[0])), glm::max(glm::length(glm::vec3(m[1])), glm::length(glm::vec3(m[2]))));
+				float reach = glm::length(glm::vec3(m * glm::vec4(center, 1.0f)) - bindCenter) + radius * scale;
+				clips.back().padding = glm::max(clips.back().padding, reach - bindRadius);
+			}
+		}
+		rows += frameCount;
+	}
+	animator->stopAnimation();
+
+	if(rows == 0)
+	{
+		std::cerr << "Error: crowd model has no animation to bake !" << std::endl;
+		return;
+	}
+
+	GLint maxSize{0};
+	glGetIntegerv(GL_MAX_TEXTURE_SIZE, &maxSize);
+	if(rows > maxSize || jointCount * 3 > maxSize)
+	{
+		std::cerr << "Error: baked crowd animations do not fit in one texture (" << jointCount * 3 << "x" << rows << ") !" << std::endl;
+		return;
+	}
+
+	glGenTextures(1, &animationTexture);
+	glBindTexture(GL_TEXTURE_2D, animationTexture);
+	glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA32F, jointCount * 3, rows, 0, GL_RGBA, GL_FLOAT, texels.data());
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+	glBindTexture(GL_TEXTURE_2D, 0);
+}
+
+int Crowd::getClip(const std::string & name)
+{
+	for(int i{0}; i < clips.size(); ++i)
+	{
+		if(clips[i].name == name)
+			return i;
+	}
+	std::cerr << "Error: crowd clip " << name << " does not exist !" << std::endl;
+	return 0;
+}
+
+int Crowd::addInstance(glm::mat4 model, const std::string & clip, float timeOffset, float rate)
+{
+	models.push_back(model);
+	instances.push_back(glm::vec4(0.0f, 1.0f, timeOffset, rate));
+	setInstanceClip(instances.size() - 1, clip, rate);
+	return instances.size() - 1;
+}
+
+void Crowd::setInstanceClip(int instance, const std::string & clip, float rate)
+{
+	if(instance < 0 || instance >= instances.size() || clips.empty())
+		return;
+
+	CrowdClip & c = clips[getClip(clip)];
+	instances[instance].x = c.firstFrame;
+	instances[instance].y = c.frameCount;
+	instances[instance].w = rate;
+	dirty = true;
+}
+
+void Crowd::clearInstances()
+{
+	models.clear();
+	instances.clear();
+	dirty = true;
+}
+
+void Crowd::update(float delta)
+{
+	time += delta;
+}
+
+void Crowd::upload()
+{
+	if(object->getInstancing())
+		object->resetInstancing();
+	if(!models.empty())
+		object->setInstancing(models);
+
+	glBindBuffer(GL_SHADER_STORAGE_BUFFER, instanceBuffer);
+	glBufferData(GL_SHADER_STORAGE_BUFFER, instances.size() * sizeof(glm::vec4), instances.data(), GL_STATIC_DRAW);
+	glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+
+	// largest clip growth among the instances, scaled like their models
+	padding = 0.0f;
+	for(int i{0}; i < instances.size(); ++i)
+	{
+		const glm::mat4 & m = models[i];
+		float scale = glm::max(glm::length(glm::vec3(m[0])), glm::max(glm::length(glm::vec3(m[1])), glm::length(glm::vec3(m[2]))));
+		for(const CrowdClip & clip : clips)
+		{
+			if(clip.firstFrame == static_cast<int>(instances[i].x))
+				padding = glm::max(padding, clip.padding * scale);
+		}
+	}
+	dirty = false;
+}
+
+void Crowd::draw(Shader & shader, struct IBL_DATA * iblData, DRAWING_MODE mode)
+{
+	if(dirty)
+		upload();
+	if(models.empty() || !animationTexture)
+		return;
+
+	shader.use();
+	shader.setInt("animationTexture", CROWD_TEXTURE_UNIT);
+	shader.setFloat("crowdTime", time);
+	shader.setFloat("bakeRate", bakeRate);
+	glActiveTexture(GL_TEXTURE0 + CROWD_TEXTURE_UNIT);
+	glBindTexture(GL_TEXTURE_2D, animationTexture);
+	glBindBufferBase(GL_SHADER_STORAGE_BUFFER, CROWD_INSTANCE_BINDING, instanceBuffer);
+
+	// every instance of a mesh in one call
+	for(auto & mesh : object->getMeshes())
+	{
+		if(shader.getType() == SHADER_TYPE::SHADOWS && mesh->getMaterial().color_emissive != glm::vec3(0.0f))
+			continue;
+		mesh->draw(shader, iblData, true, models.size(), mode);
+	}
+}
+
+int Crowd::getInstanceCount()
+{
+	return models.size();
+}
+
+struct BoundingSphere Crowd::getBoundingSphere()
+{
+	if(dirty)
+		upload();
+
+	// bind pose sphere grown by the clips the instances play
+	struct BoundingSphere sphere = object->getBoundingSphere();
+	sphere.radius += padding;
+	return sphere;
+}
+
+std::vector<CrowdClip> & Crowd::getClips()
+{
+	return clips;
+}
+
+std::unique_ptr<AnimatedObject> & Crowd::get()
+{
+	return object;
+}
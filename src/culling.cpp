@@ -0,0 +1,54 @@
+#include "culling.hpp"
+
+Frustum frustumFromMatrix(const glm::mat4 & viewProj)
+{
+	// Gribb & Hartmann plane extraction
+	Frustum f;
+	glm::vec4 row0(viewProj[0][0], viewProj[1][0], viewProj[2][0], viewProj[3][0]);
+	glm::vec4 row1(viewProj[0][1], viewProj[1][1], viewProj[2][1], viewProj[3][1]);
+	glm::vec4 row2(viewProj[0][2], viewProj[1][2], viewProj[2][2], viewProj[3][2]);
+	glm::vec4 row3(viewProj[0][3], viewProj[1][3], viewProj[2][3], viewProj[3][3]);
+
+	f.planes[0] = row3 + row0; // left
+	f.planes[1] = row3 - row0; // right
+	f.planes[2] = row3 + row1; // bottom
+	f.planes[3] = row3 - row1; // top
+	f.planes[4] = row3 + row2; // near
+	f.planes[5] = row3 - row2; // far
+
+	for(int i{0}; i < 6; ++i)
+		f.planes[i] /= glm::length(glm::vec3(f.planes[i]));
+
+	return f;
+}
+
+bool sphereInFrustum(const BoundingSphere & sphere, const Frustum & frustum)
+{
+	for(int i{0}; i < 6; ++i)
+	{
+		if(glm::dot(glm::vec3(frustum.planes[i]), sphere.center) + frustum.planes[i].w < -sphere.radius)
+			return false;
+	}
+	return true;
+}
+
+bool sphereInSphere(const BoundingSphere & sphere, const BoundingSphere & range)
+{
+	float r = sphere.radius + range.radius;
+	glm::vec3 d = sphere.center - range.center;
+	return glm::dot(d, d) <= r * r;
+}
+
+bool sphereInCone(const BoundingSphere & sphere, glm::vec3 apex, glm::vec3 direction, float halfAngle, float range)
+{
+	// signed distance from the sphere center to the cone surface
+	glm::vec3 v = sphere.center - apex;
+	float lenSq = glm::dot(v, v);
+	float v1Len = glm::dot(v, direction);
+	float distanceClosestPoint = std::cos(halfAngle) * std::sqrt(glm::max(lenSq - v1Len * v1Len, 0.0f)) - v1Len * std::sin(halfAngle);
+
+	bool angleCull = distanceClosestPoint > sphere.radius;
+	bool frontCull = v1Len > sphere.radius + range;
+	bool backCull = v1Len < -sphere.radius;
+	return !(angleCull || frontCull || backCull);
+}
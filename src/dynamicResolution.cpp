@@ -0,0 +1,104 @@
+#include "dynamicResolution.hpp"
+
+DynamicResolution::DynamicResolution(float aTargetFrameTime, float aMinScale, float aMaxScale) :
+	current(0),
+	enabled(false),
+	targetFrameTime(aTargetFrameTime),
+	minScale(aMinScale),
+	maxScale(aMaxScale),
+	scale(aMaxScale),
+	gpuTime(0.0f)
+{
+	pending.fill(false);
+	queryScale.fill(aMaxScale);
+	glGenQueries(DYNAMIC_RESOLUTION_FRAMES, queries.data());
+}
+
+DynamicResolution::~DynamicResolution()
+{
+	glDeleteQueries(DYNAMIC_RESOLUTION_FRAMES, queries.data());
+}
+
+void DynamicResolution::beginFrame()
+{
+	// the query issued DYNAMIC_RESOLUTION_FRAMES frames ago is usually ready, never waited for
+	if(pending[current])
+	{
+		GLint available{0};
+		glGetQueryObjectiv(queries[current], GL_QUERY_RESULT_AVAILABLE, &available);
+		if(available)
+		{
+			GLuint64 elapsed{0};
+			glGetQueryObjectui64v(queries[current], GL_QUERY_RESULT, &elapsed);
+			gpuTime = static_cast<float>(elapsed) / 1e6f;
+			if(enabled)
+				adjust(gpuTime, queryScale[current]);
+		}
+		pending[current] = false;
+	}
+	if(!enabled)
+		scale = maxScale;
+
+	queryScale[current] = scale;
+	glBeginQuery(GL_TIME_ELAPSED, queries[current]);
+}
+
+void DynamicResolution::endFrame()
+{
+	glEndQuery(GL_TIME_ELAPSED);
+	pending[current] = true;
+	current = (current + 1) % DYNAMIC_RESOLUTION_FRAMES;
+}
+
+void DynamicResolution::adjust(float time, float frameScale)
+{
+	if(time <= 0.0f)
+		return;
+
+	// cost assumed proportional to the pixel count, estimated from the scale that frame used
+	float desired = frameScale * std::sqrt(targetFrameTime * DYNAMIC_RESOLUTION_HEADROOM / time);
+	desired = std::clamp(desired, minScale, maxScale);
+
+	// dead band against oscillation, quick to drop and slow to climb back
+	float difference = desired - scale;
+	if(std::abs(difference) < 0.02f)
+		return;
+	scale = std::clamp(scale + std::clamp(difference, -0.1f, 0.025f), minScale, maxScale);
+}
+
+void DynamicResolution::setEnabled(bool e)
+{
+	enabled = e;
+}
+
+bool DynamicResolution::isEnabled()
+{
+	return enabled;
+}
+
+void DynamicResolution::setTargetFrameTime(float ms)
+{
+	targetFrameTime = ms;
+}
+
+float DynamicResolution::getTargetFrameTime()
+{
+	return targetFrameTime;
+}
+
+void DynamicResolution::setScaleRange(float aMinScale, float aMaxScale)
+{
+	minScale = std::clamp(aMinScale, 0.1f, 1.0f);
+	maxScale = std::clamp(aMaxScale, minScale, 1.0f);
+	scale = std::clamp(scale, minScale, maxScale);
+}
+
+float DynamicResolution::getScale()
+{
+	return scale;
+}
+
+float DynamicResolution::getGPUTime()
+{
+	return gpuTime;
+}
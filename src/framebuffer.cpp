@@ -34,7 +34,7 @@ Framebuffer::~Framebuffer()
 			}
 			glDeleteTextures(1, &attachment[i].id);
 		}
-		else if(attachment[i].type == ATTACHMENT_TYPE::TEXTURE_CUBE_MAP)
+		else if(attachment[i].type == ATTACHMENT_TYPE::TEXTURE_CUBE_MAP || attachment[i].type == ATTACHMENT_TYPE::TEXTURE_CUBE_MAP_ARRAY)
 		{
 			switch(attachment[i].target)
 			{
@@ -544,6 +544,13 @@ void Framebuffer::bind()
 	glBindFramebuffer(GL_FRAMEBUFFER, fbo);
 }
 
+void Framebuffer::bindLayer(int layer, int index)
+{
+	glBindFramebuffer(GL_FRAMEBUFFER, fbo);
+	GLenum target = (attachment[index].target == ATTACHMENT_TARGET::DEPTH) ? GL_DEPTH_ATTACHMENT : GL_COLOR_ATTACHMENT0;
+	glFramebufferTextureLayer(GL_FRAMEBUFFER, target, attachment[index].id, 0, layer);
+}
+
 void Framebuffer::unbind()
 {
 	glBindFramebuffer(GL_FRAMEBUFFER, 0);
@@ -624,3 +631,79 @@ void Framebuffer::addSingleColorTextureAttachment(GLint format, GLenum minMagFil
 	}
 	glDrawBuffers(colorAttachments.size(), colorAttachments.data());
 }
+
+void Framebuffer::addSizedColorTextureAttachment(GLint internalFormat, GLenum format, GLenum type, GLenum minMagFilter, int width, int height)
+{
+	// packed formats (RG16, RGBA8, R11F_G11F_B10F...) independent of the HDR flag
+	struct Attachment buffer;
+	buffer.type = ATTACHMENT_TYPE::TEXTURE;
+	buffer.target = ATTACHMENT_TARGET::COLOR;
+	int count{getColorAttachmentCount()};
+
+	if(multiSample)
+	{
+		std::cerr << "Error : cannot add sized color texture attachment ! This function holds for non MSAA FBOs." << std::endl;
+		return;
+	}
+
+	glBindFramebuffer(GL_FRAMEBUFFER, fbo);
+	glGenTextures(1, &buffer.id);
+	glBindTexture(GL_TEXTURE_2D, buffer.id);
+	glTexImage2D(GL_TEXTURE_2D, 0, internalFormat, width, height, 0, format, type, nullptr);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, minMagFilter);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, minMagFilter);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+	glBindTexture(GL_TEXTURE_2D, 0);
+	glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0 + count, GL_TEXTURE_2D, buffer.id, 0);
+
+	if(glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE)
+		std::cerr << "Error: framebuffer is not complete !" << std::endl;
+	else
+		attachment.push_back(buffer);
+
+	int index{0};
+	std::vector<GLenum> colorAttachments;
+	for(int i{0}; i < attachment.size(); ++i)
+	{
+		if(attachment.at(i).target == ATTACHMENT_TARGET::COLOR)
+		{
+			colorAttachments.push_back(GL_COLOR_ATTACHMENT0 + index);
+			index++;
+		}
+	}
+	glDrawBuffers(colorAttachments.size(), colorAttachments.data());
+	glBindFramebuffer(GL_FRAMEBUFFER, 0);
+}
+
+void Framebuffer::addDepthTextureCubemapArrayAttachment(int width, int height, int layers)
+{
+	struct Attachment buffer;
+	buffer.type = ATTACHMENT_TYPE::TEXTURE_CUBE_MAP_ARRAY;
+	buffer.target = ATTACHMENT_TARGET::DEPTH;
+
+	glBindFramebuffer(GL_FRAMEBUFFER, fbo);
+	glGenTextures(1, &buffer.id);
+	glBindTexture(GL_TEXTURE_CUBE_MAP_ARRAY, buffer.id);
+	glTexImage3D(GL_TEXTURE_CUBE_MAP_ARRAY, 0, GL_DEPTH_COMPONENT32F, width, height, layers * 6, 0, GL_DEPTH_COMPONENT, GL_FLOAT, nullptr);
+	glTexParameteri(GL_TEXTURE_CUBE_MAP_ARRAY, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+	glTexParameteri(GL_TEXTURE_CUBE_MAP_ARRAY, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+	glTexParameteri(GL_TEXTURE_CUBE_MAP_ARRAY, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+	glTexParameteri(GL_TEXTURE_CUBE_MAP_ARRAY, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+	glTexParameteri(GL_TEXTURE_CUBE_MAP_ARRAY, GL_TEXTURE_WRAP_R, GL_CLAMP_TO_EDGE);
+	glBindTexture(GL_TEXTURE_CUBE_MAP_ARRAY, 0);
+
+	glFramebufferTexture(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, buffer.id, 0);
+	if(!renderColor)
+	{
+		glDrawBuffer(GL_NONE);
+		glReadBuffer(GL_NONE);
+	}
+
+	if(glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE)
+		std::cerr << "Error: framebuffer is not complete !" << std::endl;
+	else
+		attachment.push_back(buffer);
+
+	glBindFramebuffer(GL_FRAMEBUFFER, 0);
+}
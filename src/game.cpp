@@ -57,6 +57,7 @@ Game::Game(int clientWidth, int clientHeight) :
 	scenes[0].addObject("assets/character/pillar.glb", glm::mat4(1.0f), "assets/character/pillar_collision_shape.glb", pillarInstance);
 	scenes[0].addObject("assets/character/flag.glb", glm::mat4(1.0f));
 	scenes[0].addObject("assets/character/flag_bearer.glb", glm::mat4(1.0f));
+	scenes[0].getObjects()[6]->setOccluder(true); // pillars
 
 	scenes[0].setIBL("assets/HDRIs/sky_night_red.hdr", true, clientWidth, clientHeight);
 	scenes[0].setGridAxis(8);
@@ -141,45 +142,172 @@ void Game::draw(float& delta, double& elapsedTime, int width, int height, DRAWIN
 
 	if(activeScene < scenes.size())
 	{
+		// crowds only advance their clock, poses are read from the baked clips on the GPU
+		for(auto & crowd : scenes[activeScene].getCrowds())
+			crowd->update(delta);
+		scenes[activeScene].updateImpostors(graphics);
+
+		// DYNAMIC RESOLUTION : scene passes render in the lower left part of the targets
+		DynamicResolution & dynamicResolution = graphics.getDynamicResolution();
+		dynamicResolution.beginFrame();
+		int renderWidth = std::max(8, static_cast<int>(width * dynamicResolution.getScale()));
+		int renderHeight = std::max(8, static_cast<int>(height * dynamicResolution.getScale()));
+		glm::vec2 renderScale(static_cast<float>(renderWidth) / width, static_cast<float>(renderHeight) / height);
+		if(renderScale != graphics.getRenderScale())
+		{
+			// histories stored at the previous scale
+			graphics.volumetricsFrame = 0;
+			graphics.taaFrame = 0;
+		}
+		graphics.setRenderScale(renderScale);
+
+		// TAA : sub pixel jitter of the camera passes, none for the other modes
+		ANTI_ALIASING antiAliasing = graphics.getAntiAliasing();
+		scenes[activeScene].getActiveCamera().setJitter((antiAliasing == ANTI_ALIASING::TAA) ? graphics.getTAAJitter(renderWidth, renderHeight) : glm::vec2(0.0f));
+
 	    s.use();
+		s.setInt("shadowOn", graphics.shadowsOn() ? 1 : 0);
+
+		// RENDER GRAPH : passes declared with what they read and write, compiled every frame.
+		// Passes the screen does not depend on are culled, per frame targets are allocated
+		// only for the effects that run and shared when their lifetimes do not overlap
+		RenderGraph & graph = graphics.getRenderGraph();
+		graph.reset();
+		graph.importTarget("shadow maps");
+		graph.importTarget("visible objects");
+		graph.importTarget("skinned meshes");
+		graph.importTarget("gbuffer");
+		graph.importTarget("scene", {graphics.getNormalFBO(0)->getAttachments()[0].id});
+		graph.importTarget("bright", {graphics.getNormalFBO(1)->getAttachments()[0].id});
+		graph.importTarget("screen");
+		bool volumetrics = graphics.volumetricLightingOn() && graphics.shadowsOn();
+
+		// SKINNING : animated meshes skinned once, every pass below draws the result
+		if(character && character->sceneID == scenes[activeScene].getId())
+			graph.addPass("skinning", {}, {"skinned meshes"}, [&](){ character->skin(graphics.cs_skinning); });
 
-		s.setInt("shadowOn", 0);
         if(graphics.shadowsOn())
         {
-			s.setInt("shadowOn", 1);
-			// SHADOW PASS : directional & spot light sources
-			directionalShadowPass(activeScene, delta, mode);
-			// SHADOW PASS : point light sources
-			omnidirectionalShadowPass(activeScene, delta, mode);
+			graph.addPass("shadows", {"skinned meshes"}, {"shadow maps"}, [&](){
+				// SHADOW PASS : directional & spot light sources
+				directionalShadowPass(activeScene, delta, mode);
+				// SHADOW PASS : point light sources
+				omnidirectionalShadowPass(activeScene, delta, mode);
+			});
         }
 
+        // OCCLUSION CULLING : CPU depth buffer, skips hidden objects in the camera passes
+		graph.addPass("occlusion culling", {}, {"visible objects"}, [&](){ scenes[activeScene].cullOccluded(); });
+
         // FILL G-BUFFER
-        GBufferPass(activeScene, width, height, delta);
+		graph.addPass("gbuffer", {"visible objects", "skinned meshes"}, {"gbuffer"}, [&](){ GBufferPass(activeScene, renderWidth, renderHeight, delta); });
 
 		// SSAO PASS
 		if(graphics.ssaoOn())
-			ssaoPass(activeScene, width, height, delta);
+		{
+			graph.createTarget("ao normal depth", RenderTargetDesc(width / SSAO_DOWNSAMPLE, height / SSAO_DOWNSAMPLE, GL_RGBA16F, GL_RGBA, GL_FLOAT, GL_NEAREST));
+			graph.createTarget("ao raw", RenderTargetDesc(width / SSAO_DOWNSAMPLE, height / SSAO_DOWNSAMPLE, GL_R8, GL_RED, GL_UNSIGNED_BYTE, GL_NEAREST));
+			graph.createTarget("ao", RenderTargetDesc(width, height, GL_R8, GL_RED, GL_UNSIGNED_BYTE, GL_LINEAR));
+			graph.addPass("ssao", {"gbuffer"}, {"ao normal depth", "ao raw", "ao"}, [&](){ ssaoPass(activeScene, renderWidth, renderHeight, delta); });
+		}
+
+		// COLOR PASS : multisampled with MSAA, single sample otherwise
+		std::vector<std::string> colorInputs{"visible objects", "skinned meshes", "gbuffer", "shadow maps"};
+		if(graphics.ssaoOn())
+			colorInputs.push_back("ao");
+		graph.addPass("color", colorInputs, {"scene", "bright"}, [&](){ colorMultisamplePass(activeScene, renderWidth, renderHeight, delta, mode, debug); });
 
-		// COLOR PASS : multisampling
-		colorMultisamplePass(activeScene, width, height, delta, mode, debug);
+		// draw outline if shader type is TOON
+		if(s.getType() == SHADER_TYPE::TOON)
+		{
+			graph.createTarget("toon outline", RenderTargetDesc(width, height, GL_R8, GL_RED, GL_UNSIGNED_BYTE, GL_NEAREST));
+			graph.addPass("toon outline", {"scene"}, {"toon outline", "scene"}, [&](){ toonOutline(renderWidth, renderHeight); });
+		}
+
+		// ANTI ALIASING : single sample scene filtered before post processing
+		std::string sceneTarget{"scene"};
+		if(antiAliasing == ANTI_ALIASING::FXAA)
+		{
+			graph.createTarget("scene fxaa", RenderTargetDesc(width, height));
+			graph.addPass("fxaa", {"scene"}, {"scene fxaa"}, [&](){ fxaaPass(renderWidth, renderHeight); });
+			sceneTarget = "scene fxaa";
+		}
+		if(antiAliasing == ANTI_ALIASING::TAA)
+		{
+			int frame = graphics.taaFrame;
+			std::string history = "taa history " + std::to_string(frame % 2);
+			std::string accumulated = "taa history " + std::to_string((frame + 1) % 2);
+			graph.importTarget(history, {graphics.getTAAHistoryFBO(frame % 2)->getAttachments()[0].id});
+			graph.importTarget(accumulated, {graphics.getTAAHistoryFBO((frame + 1) % 2)->getAttachments()[0].id});
+			graph.addPass("taa", {"scene", "gbuffer", history}, {accumulated}, [&](){ taaPass(activeScene, renderWidth, renderHeight); });
+			graph.markOutput(accumulated); // read next frame
+			sceneTarget = accumulated;
+		}
+		else
+		{
+			graphics.taaFrame = 0; // stale history
+			graphics.releaseTAAHistory();
+		}
 
         // BLOOM PASS
 		if(graphics.bloomOn())
-			bloomPass(width, height, graphics.getNormalFBO(1), 0, graphics.getBloomTexture(0));
+			bloomPass(width, height, renderWidth, renderHeight, "bright", 0, "scene bloom");
 
 		// VOLUMETRICS PASS
-		if(graphics.volumetricLightingOn() && graphics.shadowsOn())
-			volumetricsPass(activeScene, width, height, delta, elapsedTime);
+		if(volumetrics)
+		{
+			int frame = graphics.volumetricsFrame;
+			std::string history = "volumetrics history " + std::to_string(frame % 2);
+			std::string accumulated = "volumetrics history " + std::to_string((frame + 1) % 2);
+			graph.importTarget(history, {graphics.getVolumetricsHistoryFBO(frame % 2)->getAttachments()[0].id});
+			graph.importTarget(accumulated, {graphics.getVolumetricsHistoryFBO((frame + 1) % 2)->getAttachments()[0].id});
+			graph.createTarget("volumetrics position", RenderTargetDesc(width / 2, height / 2));
+			graph.createTarget("volumetrics raymarch", RenderTargetDesc(width / 2, height / 2));
+			graph.createTarget("volumetrics", RenderTargetDesc(width, height));
+			graph.addPass("volumetrics", {"gbuffer", "shadow maps", history}, {"volumetrics position", "volumetrics raymarch", accumulated, "volumetrics"}, [&](){
+				volumetricsPass(activeScene, renderWidth, renderHeight, delta, elapsedTime);
+			});
+			graph.markOutput(accumulated); // read next frame
+		}
+		else
+		{
+			graphics.volumetricsFrame = 0; // stale history
+			graphics.releaseVolumetricsHistory();
+		}
 		
         // MOTION BLUR PASS
 		if(graphics.motionBlurFX)
-			motionBlurPass(activeScene, width, height);
+		{
+			graph.createTarget("motion blur", RenderTargetDesc(width, height));
+			graph.addPass("motion blur", {"gbuffer"}, {"motion blur"}, [&](){ motionBlurPass(activeScene, renderWidth, renderHeight); });
+		}
+
+        // DRAW USER INTERFACE : native resolution
+		graph.createTarget("ui", RenderTargetDesc(width, height, GL_RGBA16F, GL_RGBA, GL_FLOAT, GL_LINEAR, 2));
+		graph.addPass("ui", {}, {"ui"}, [&](){
+			glViewport(0, 0, width, height);
+			drawUI(delta, elapsedTime, width, height, mode);
+		});
+		bloomPass(width, height, width, height, "ui", 1, "ui bloom");
+
+		// POST PROCESSING : one pass from the HDR targets to the screen
+		std::vector<std::string> postInputs{sceneTarget, "ui", "ui bloom"};
+		if(graphics.bloomOn())
+			postInputs.push_back("scene bloom");
+		if(volumetrics)
+			postInputs.push_back("volumetrics");
+		if(graphics.motionBlurFX)
+			postInputs.push_back("motion blur");
+		graph.addPass("post processing", postInputs, {"screen"}, [&](){
+			glViewport(0, 0, width, height);
+			compositingPass(sceneTarget);
+		});
+		graph.markOutput("screen");
 
-        // DRAW USER INTERFACE
-        drawUI(delta, elapsedTime, width, height, mode);
+		graph.compile();
+		graph.execute();
 
-		// COMPOSITING
-		compositingPass();
+		dynamicResolution.endFrame();
 	}
 	else
 	{
@@ -189,7 +317,7 @@ void Game::draw(float& delta, double& elapsedTime, int width, int height, DRAWIN
 
 void Game::drawUI(float& delta, double& elapsedTime, int width, int height, DRAWING_MODE mode)
 {
-    graphics.userInterfaceFBO->bind();
+    graphics.getRenderGraph().getFBO("ui")->bind();
     glClearColor(0.0f, 0.0f, 0.0f, 0.0f);
     glClear(GL_COLOR_BUFFER_BIT);
 
@@ -202,8 +330,6 @@ void Game::drawUI(float& delta, double& elapsedTime, int width, int height, DRAW
 		m_mouse->update_position();
 		m_mouse->draw();
 	}
-
-	bloomPass(width, height, graphics.userInterfaceFBO, 1, graphics.getBloomTexture(1));
 }
 
 
@@ -396,108 +522,322 @@ void Game::vehicleUpdateUpVector()
 
 void Game::directionalShadowPass(int index, float delta, DRAWING_MODE mode)
 {
-	graphics.getShadowMappingShader().use();
-	graphics.getShadowMappingShader().setInt("computeWorldPos", 0);
-	graphics.getShadowMappingShader().setInt("omniDepthRendering", 0);
-	graphics.getShadowMappingShader().setInt("omnilightFragDepth", 0);
-
-	// render directional depth maps
-	int sLightsOffset{0};
-	for(int i{0}; i < scenes[index].getDLights().size(); ++i, ++sLightsOffset)
+	Camera & cam = scenes[index].getActiveCamera();
+	std::vector<std::shared_ptr<DirectionalLight>> & dLights = scenes[index].getDLights();
+	std::vector<std::shared_ptr<SpotLight>> & sLights = scenes[index].getSLights();
+
+	// light transforms and atlas requests (directional first, spot last)
+	std::vector<glm::mat4> views;
+	std::vector<glm::mat4> projs;
+	std::vector<int> sizes;
+	for(int i{0}; i < dLights.size(); ++i)
 	{
-		glViewport(0, 0,
-				static_cast<int>(scenes[index].getDLights()[i]->getShadowQuality()),
-				static_cast<int>(scenes[index].getDLights()[i]->getShadowQuality()));
-		graphics.setStdShadowQuality(scenes[index].getDLights()[i]->getShadowQuality(), i);
-		graphics.getStdDepthFBO(i)->bind();
-		glClear(GL_DEPTH_BUFFER_BIT);
-
-		glm::vec3 lightPosition = scenes[index].getDLights()[i]->getPosition();
-		glm::vec3 lightTarget = lightPosition + scenes[index].getDLights()[i]->getDirection();
-		glm::mat4 lightView = glm::lookAt(lightPosition, lightTarget, glm::vec3(0.0f, 1.0f, 0.0f));
-
-		graphics.getShadowMappingShader().setMatrix("view", lightView);
-		graphics.getShadowMappingShader().setMatrix("proj", graphics.getOrthoProjection(scenes[index].getDLights()[i]->getOrthoDimension()));
-
-		// draw scene
-		scenes[index].draw(graphics.getShadowMappingShader(), graphics, DRAW_TYPE::DRAW_BOTH, delta, mode);
+		glm::vec3 lightPosition = dLights[i]->getPosition();
+		glm::vec3 lightTarget = lightPosition + dLights[i]->getDirection();
+		views.push_back(glm::lookAt(lightPosition, lightTarget, glm::vec3(0.0f, 1.0f, 0.0f)));
+		projs.push_back(graphics.getOrthoProjection(dLights[i]->getOrthoDimension()));
+		sizes.push_back(static_cast<int>(dLights[i]->getShadowQuality()));
 	}
-
-	for(int i{0}; i < scenes[index].getSLights().size(); ++i)
+	for(int i{0}; i < sLights.size(); ++i)
 	{
-		glViewport(0, 0,
-				static_cast<int>(scenes[index].getSLights()[i]->getShadowQuality()),
-				static_cast<int>(scenes[index].getSLights()[i]->getShadowQuality()));
-		graphics.setStdShadowQuality(scenes[index].getSLights()[i]->getShadowQuality(), i + scenes[index].getDLights().size());
-		graphics.getStdDepthFBO(sLightsOffset + i)->bind();
-		glClear(GL_DEPTH_BUFFER_BIT);
-
-		glm::vec3 lightPosition = scenes[index].getSLights()[i]->getPosition();
-		glm::vec3 lightDirection = scenes[index].getSLights()[i]->getDirection();
-		glm::vec3 lightTarget = lightPosition + lightDirection;
+		glm::vec3 lightPosition = sLights[i]->getPosition();
+		glm::vec3 lightDirection = sLights[i]->getDirection();
 		glm::vec3 up = (lightDirection == glm::vec3(0.0f, -1.0f, 0.0f)) ? glm::vec3(1.0f, 0.0f, 0.0f) : glm::vec3(0.0f, 1.0f, 0.0f);
-		glm::mat4 lightView = glm::lookAt(lightPosition, lightTarget, up);
-		float outerCutOff = scenes[index].getSLights()[i]->getOuterCutOff();
+		float outerCutOff = sLights[i]->getOuterCutOff();
+		float range = glm::min(sLights[i]->getRange(), graphics.getFarPlane());
+		views.push_back(glm::lookAt(lightPosition, lightPosition + lightDirection, up));
+		projs.push_back(glm::perspective(outerCutOff * 2.0f, 1.0f, cam.getNearPlane(), range));
+
+		int index = dLights.size() + i;
+		int previous = (index < static_cast<int>(shadowSizes.size())) ? shadowSizes[index] : 0;
+		BoundingSphere volume{lightPosition + glm::normalize(lightDirection) * range * 0.5f, range * 0.5f / std::cos(outerCutOff)};
+		sizes.push_back(shadowMapSize(sLights[i]->getShadowQuality(), volume, cam, previous));
+	}
+	shadowSizes = sizes;
+	graphics.updateShadowAtlas(sizes);
 
-		glm::mat4 spotProj = glm::perspective(
-					outerCutOff * 2.0f, 1.0f,
-					scenes[index].getActiveCamera().getNearPlane(),
-					scenes[index].getActiveCamera().getFarPlane()
-					);
+	stdLightSpaceMatrices.clear();
+	for(int i{0}; i < views.size(); ++i)
+		stdLightSpaceMatrices.push_back(projs[i] * views[i]);
+
+	graphics.getShadowMappingShader().use();
+	graphics.getShadowMappingShader().setInt("omnilightFragDepth", 0);
+
+	glEnable(GL_SCISSOR_TEST);
+	for(int i{0}; i < views.size(); ++i)
+	{
+		glm::ivec3 region = graphics.getShadowAtlas().getRegion(i);
+		if(region.z == 0)
+			continue;
 
-		graphics.getShadowMappingShader().setMatrix("proj", spotProj);
-		graphics.getShadowMappingShader().setMatrix("view", lightView);
+		graphics.getShadowMappingShader().setMatrix("proj", projs[i]);
 
-		// draw scene
-		scenes[index].draw(graphics.getShadowMappingShader(), graphics, DRAW_TYPE::DRAW_BOTH, delta, mode);
+		// casters inside the light frustum (directional) or the light cone (spot)
+		ShadowCasters casters;
+		if(i < dLights.size())
+		{
+			Frustum lightFrustum = frustumFromMatrix(stdLightSpaceMatrices[i]);
+			casters = scenes[index].getShadowCasters([&lightFrustum](const BoundingSphere & s) {
+				return sphereInFrustum(s, lightFrustum);
+			});
+		}
+		else
+		{
+			std::shared_ptr<SpotLight> & light = sLights[i - dLights.size()];
+			glm::vec3 lightPosition = light->getPosition();
+			glm::vec3 lightDirection = glm::normalize(light->getDirection());
+			float outerCutOff = light->getOuterCutOff();
+			float range = glm::min(light->getRange(), graphics.getFarPlane());
+			casters = scenes[index].getShadowCasters([&](const BoundingSphere & s) {
+				return sphereInCone(s, lightPosition, lightDirection, outerCutOff, range);
+			});
+		}
+
+		std::size_t lightKey{0};
+		hashCombine(lightKey, stdLightSpaceMatrices[i]);
+		cachedShadowMap(index, graphics.getShadowAtlasFBO(), graphics.getShadowAtlasCacheFBO(), graphics.getStdShadowCache(i), lightKey, region, -1, {{views[i], casters}}, mode);
 	}
+	glDisable(GL_SCISSOR_TEST);
 
 	glBindFramebuffer(GL_FRAMEBUFFER, 0);
 }
 
 void Game::omnidirectionalShadowPass(int index, float delta, DRAWING_MODE mode)
 {
+	std::vector<std::shared_ptr<PointLight>> & pLights = scenes[index].getPLights();
+
+	// every cube shares the best requested resolution, layers only for lights casting shadows
+	SHADOW_QUALITY quality{SHADOW_QUALITY::TINY};
+	int layerCount{0};
+	omniShadowLayers.assign(pLights.size(), -1);
+	for(int i{0}; i < pLights.size(); ++i)
+	{
+		quality = std::max(quality, pLights[i]->getShadowQuality());
+		if(pLights[i]->getShadowQuality() != SHADOW_QUALITY::OFF)
+			omniShadowLayers[i] = layerCount++;
+	}
+	graphics.updateOmniShadowArray(layerCount, quality);
+
+	int resolution = graphics.getOmniShadowResolution();
+	glViewport(0, 0, resolution, resolution);
+
 	graphics.getShadowMappingShader().use();
-	graphics.getShadowMappingShader().setInt("computeWorldPos", 1);
-	graphics.getShadowMappingShader().setInt("omniDepthRendering", 1);
 	graphics.getShadowMappingShader().setInt("omnilightFragDepth", 1);
+	graphics.getShadowMappingShader().setMatrix("proj", graphics.getOmniPerspProjection());
 
-	// render omnidirectional depth maps
-	std::vector<glm::mat4> omnilightViews;
-	for(int i{0}; i < scenes[index].getPLights().size(); ++i)
+	// render omnidirectional depth maps, one cube face at a time
+	std::array<glm::mat4, 6> omnilightViews;
+	std::vector<std::pair<glm::mat4, ShadowCasters>> faces;
+	for(int i{0}; i < pLights.size(); ++i)
 	{
-		glViewport(0, 0,
-				static_cast<int>(scenes[index].getPLights()[i]->getShadowQuality()),
-				static_cast<int>(scenes[index].getPLights()[i]->getShadowQuality()));
-		graphics.setOmniShadowQuality(scenes[index].getPLights()[i]->getShadowQuality(), i);
-		graphics.getOmniDepthFBO(i)->bind();
-		glClear(GL_DEPTH_BUFFER_BIT);
-
-		// (proj * view)
-		glm::vec3 lightPosition = scenes[index].getPLights()[i]->getPosition();
-		omnilightViews.push_back(graphics.getOmniPerspProjection() * glm::lookAt(lightPosition, lightPosition + glm::vec3(1.0f, 0.0f, 0.0f), glm::vec3(0.0f, -1.0f, 0.0f)));
-		omnilightViews.push_back(graphics.getOmniPerspProjection() * glm::lookAt(lightPosition, lightPosition + glm::vec3(-1.0f, 0.0f, 0.0f), glm::vec3(0.0f, -1.0f, 0.0f)));
-		omnilightViews.push_back(graphics.getOmniPerspProjection() * glm::lookAt(lightPosition, lightPosition + glm::vec3(0.0f, 1.0f, 0.0f), glm::vec3(0.0f, 0.0f, 1.0f)));
-		omnilightViews.push_back(graphics.getOmniPerspProjection() * glm::lookAt(lightPosition, lightPosition + glm::vec3(0.0f, -1.0f, 0.0f), glm::vec3(0.0f, 0.0f, -1.0f)));
-		omnilightViews.push_back(graphics.getOmniPerspProjection() * glm::lookAt(lightPosition, lightPosition + glm::vec3(0.0f, 0.0f, 1.0f), glm::vec3(0.0f, -1.0f, 0.0f)));
-		omnilightViews.push_back(graphics.getOmniPerspProjection() * glm::lookAt(lightPosition, lightPosition + glm::vec3(0.0f, 0.0f, -1.0f), glm::vec3(0.0f, -1.0f, 0.0f)));
+		int layer = omniShadowLayers[i];
+		if(layer < 0)
+			continue;
+
+		glm::vec3 lightPosition = pLights[i]->getPosition();
+		omnilightViews[0] = glm::lookAt(lightPosition, lightPosition + glm::vec3(1.0f, 0.0f, 0.0f), glm::vec3(0.0f, -1.0f, 0.0f));
+		omnilightViews[1] = glm::lookAt(lightPosition, lightPosition + glm::vec3(-1.0f, 0.0f, 0.0f), glm::vec3(0.0f, -1.0f, 0.0f));
+		omnilightViews[2] = glm::lookAt(lightPosition, lightPosition + glm::vec3(0.0f, 1.0f, 0.0f), glm::vec3(0.0f, 0.0f, 1.0f));
+		omnilightViews[3] = glm::lookAt(lightPosition, lightPosition + glm::vec3(0.0f, -1.0f, 0.0f), glm::vec3(0.0f, 0.0f, -1.0f));
+		omnilightViews[4] = glm::lookAt(lightPosition, lightPosition + glm::vec3(0.0f, 0.0f, 1.0f), glm::vec3(0.0f, -1.0f, 0.0f));
+		omnilightViews[5] = glm::lookAt(lightPosition, lightPosition + glm::vec3(0.0f, 0.0f, -1.0f), glm::vec3(0.0f, -1.0f, 0.0f));
 
 		graphics.getShadowMappingShader().setVec3f("lightPosition", lightPosition);
-		for(int j{0}; j < 6; ++j)
-			graphics.getShadowMappingShader().setMatrix("omnilightViews[" + std::to_string(j) + "]", omnilightViews[j]);
-		omnilightViews.clear();
 
-		// draw scene
-		scenes[index].draw(graphics.getShadowMappingShader(), graphics, DRAW_TYPE::DRAW_BOTH, delta, mode);
+		// casters within the light range, then inside each face frustum
+		BoundingSphere lightRange{lightPosition, glm::min(pLights[i]->getRange(), graphics.getFarPlane())};
+		ShadowCasters inRange = scenes[index].getShadowCasters([&lightRange](const BoundingSphere & s) {
+			return sphereInSphere(s, lightRange);
+		});
+
+		faces.clear();
+		for(int f{0}; f < 6; ++f)
+		{
+			Frustum faceFrustum = frustumFromMatrix(graphics.getOmniPerspProjection() * omnilightViews[f]);
+			faces.emplace_back(omnilightViews[f], scenes[index].getShadowCasters(inRange, [&faceFrustum](const BoundingSphere & s) {
+				return sphereInFrustum(s, faceFrustum);
+			}));
+		}
+
+		std::size_t lightKey{0};
+		hashCombine(lightKey, lightPosition.x);
+		hashCombine(lightKey, lightPosition.y);
+		hashCombine(lightKey, lightPosition.z);
+		hashCombine(lightKey, graphics.getFarPlane());
+		cachedShadowMap(index, graphics.getOmniShadowFBO(), graphics.getOmniShadowCacheFBO(), graphics.getOmniShadowCache(layer), lightKey, glm::ivec3(0, 0, resolution), layer, faces, mode);
 	}
 	glBindFramebuffer(GL_FRAMEBUFFER, 0);
 }
 
+void Game::cachedShadowMap(int index, std::unique_ptr<Framebuffer> & fbo, std::unique_ptr<Framebuffer> & cacheFBO, ShadowCache & cache, std::size_t lightKey, glm::ivec3 region, int layer, const std::vector<std::pair<glm::mat4, ShadowCasters>> & faces, DRAWING_MODE mode)
+{
+	// region : atlas rectangle (x, y, size), layer : cube map array layer or -1 for the atlas
+	Shader & shader = graphics.getShadowMappingShader();
+	bool cubeMap = layer >= 0;
+
+	auto bindFace = [&](std::unique_ptr<Framebuffer> & target, int face) {
+		if(cubeMap)
+			target->bindLayer(layer * 6 + face);
+		else
+		{
+			target->bind();
+			glViewport(region.x, region.y, region.z, region.z);
+			glScissor(region.x, region.y, region.z, region.z);
+		}
+	};
+
+	bool hasDynamic = hasDynamicCasters(faces);
+	std::size_t key{lightKey};
+	for(auto & face : faces)
+		hashCombine(key, face.second.staticKey);
+
+	// static casters : rendered once, then only when the light or one of them changes
+	bool staticDirty = !cache.valid || cache.key != key;
+	if(staticDirty)
+	{
+		for(int f{0}; f < faces.size(); ++f)
+		{
+			bindFace(cacheFBO, f);
+			glClear(GL_DEPTH_BUFFER_BIT);
+			shader.setMatrix("view", faces[f].first);
+			scenes[index].drawShadowCasters(shader, faces[f].second, CASTER_TYPE::STATIC, mode);
+		}
+		cache.key = key;
+		cache.valid = true;
+	}
+
+	// dynamic casters : redrawn each frame over a copy of the static layer
+	if(staticDirty || hasDynamic || cache.dynamicDrawn)
+	{
+		GLenum target = (cubeMap) ? GL_TEXTURE_CUBE_MAP_ARRAY : GL_TEXTURE_2D;
+		int z = (cubeMap) ? layer * 6 : 0;
+		glCopyImageSubData(
+				cacheFBO->getAttachments()[0].id, target, 0, region.x, region.y, z,
+				fbo->getAttachments()[0].id, target, 0, region.x, region.y, z,
+				region.z, region.z, (cubeMap) ? 6 : 1);
+
+		for(int f{0}; hasDynamic && f < faces.size(); ++f)
+		{
+			if(!hasDynamicCasters(faces[f].second))
+				continue;
+			bindFace(fbo, f);
+			shader.setMatrix("view", faces[f].first);
+			scenes[index].drawShadowCasters(shader, faces[f].second, CASTER_TYPE::DYNAMIC, mode);
+		}
+	}
+	cache.dynamicDrawn = hasDynamic;
+}
+
+int Game::shadowMapSize(SHADOW_QUALITY quality, const BoundingSphere & volume, Camera & cam, int previous)
+{
+	// halve the requested resolution each time the light volume covers half less of the screen
+	int size = static_cast<int>(quality);
+	float distance = glm::length(volume.center - cam.getPosition());
+	if(distance <= volume.radius)
+		return size;
+
+	float coverage = volume.radius / (distance * std::tan(glm::radians(cam.getFov()) * 0.5f));
+
+	// the previous size is kept until the coverage leaves its band by a margin,
+	// a light hovering over a threshold would otherwise repack the atlas every few frames
+	if(previous >= static_cast<int>(SHADOW_QUALITY::TINY) && previous <= size)
+	{
+		float band = static_cast<float>(previous) / size;
+		bool aboveLower = previous == static_cast<int>(SHADOW_QUALITY::TINY) || coverage >= 0.5f * band * (1.0f - SHADOW_SIZE_HYSTERESIS);
+		bool belowUpper = previous == size || coverage < band * (1.0f + SHADOW_SIZE_HYSTERESIS);
+		if(aboveLower && belowUpper)
+			return previous;
+	}
+
+	while(size > static_cast<int>(SHADOW_QUALITY::TINY) && coverage < 0.5f)
+	{
+		size /= 2;
+		coverage *= 2.0f;
+	}
+	return size;
+}
+
+void Game::setShadowUniforms(Shader & s, int index, int textureUnit)
+{
+	// per light shadow data travels in the GPULight buffer filled by clusterLights
+	glActiveTexture(GL_TEXTURE0 + textureUnit);
+	glBindTexture(GL_TEXTURE_CUBE_MAP_ARRAY, graphics.getOmniShadowFBO()->getAttachments()[0].id);
+	s.setInt("omniShadowMaps", textureUnit);
+	glActiveTexture(GL_TEXTURE0 + textureUnit + 1);
+	glBindTexture(GL_TEXTURE_2D, graphics.getShadowAtlasFBO()->getAttachments()[0].id);
+	s.setInt("shadowAtlas", textureUnit + 1);
+}
+
+void Game::clusterLights(int index)
+{
+	std::vector<std::shared_ptr<PointLight>> & pLights = scenes[index].getPLights();
+	std::vector<std::shared_ptr<DirectionalLight>> & dLights = scenes[index].getDLights();
+	std::vector<std::shared_ptr<SpotLight>> & sLights = scenes[index].getSLights();
+	bool shadows = graphics.shadowsOn();
+
+	std::vector<GPULight> lights;
+	lights.reserve(pLights.size() + dLights.size() + sLights.size());
+	for(int i{0}; i < pLights.size(); ++i)
+	{
+		GPULight l;
+		l.type = 0;
+		l.position = pLights[i]->getPosition();
+		l.ambientStrength = pLights[i]->getAmbientStrength();
+		l.diffuseStrength = pLights[i]->getDiffuseStrength();
+		l.specularStrength = pLights[i]->getSpecularStrength();
+		l.kc = pLights[i]->getKc();
+		l.kl = pLights[i]->getKl();
+		l.kq = pLights[i]->getKq();
+		l.range = glm::min(pLights[i]->getRange(), graphics.getFarPlane());
+		l.shadowLayer = (shadows && i < omniShadowLayers.size()) ? omniShadowLayers[i] : -1;
+		lights.push_back(l);
+	}
+
+	// directional and spot lights : shadow maps in the atlas, same order as stdLightSpaceMatrices
+	for(int i{0}; i < dLights.size() + sLights.size(); ++i)
+	{
+		GPULight l;
+		if(shadows && i < stdLightSpaceMatrices.size())
+		{
+			l.lightSpaceMatrix = stdLightSpaceMatrices[i];
+			l.atlasRegion = graphics.getShadowAtlas().getUVRegion(i);
+		}
+		if(i < dLights.size())
+		{
+			l.type = 1;
+			l.position = dLights[i]->getPosition();
+			l.direction = dLights[i]->getDirection();
+			l.ambientStrength = dLights[i]->getAmbientStrength();
+			l.diffuseStrength = dLights[i]->getDiffuseStrength();
+			l.specularStrength = dLights[i]->getSpecularStrength();
+		}
+		else
+		{
+			std::shared_ptr<SpotLight> & light = sLights[i - dLights.size()];
+			l.type = 2;
+			l.position = light->getPosition();
+			l.direction = light->getDirection();
+			l.cutOff = std::cos(light->getCutOff());
+			l.outerCutOff = std::cos(light->getOuterCutOff());
+			l.ambientStrength = light->getAmbientStrength();
+			l.diffuseStrength = light->getDiffuseStrength();
+			l.specularStrength = light->getSpecularStrength();
+			l.range = glm::min(light->getRange(), graphics.getFarPlane());
+		}
+		lights.push_back(l);
+	}
+
+	Camera & cam = scenes[index].getActiveCamera();
+	graphics.getLightClusters().update(lights, cam.getViewMatrix(), cam.getProjectionMatrix(), cam.getNearPlane(), cam.getFarPlane());
+}
+
 void Game::colorMultisamplePass(int index, int width, int height, float delta, DRAWING_MODE mode, bool debug)
 {
 	// render to multisample framebuffer
 	glViewport(0, 0, width, height);
 	graphics.getMultisampleFBO()->bind();
+	GLenum colorBuffers[] = {GL_COLOR_ATTACHMENT0, GL_COLOR_ATTACHMENT1};
+	glDrawBuffers(2, colorBuffers);
 
 	// get shader
 	Shader s = graphics.getColorShader();
@@ -505,344 +845,328 @@ void Game::colorMultisamplePass(int index, int width, int height, float delta, D
 	// draw scene
 	glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
 	s.use();
-	s.setInt("pointLightCount", scenes[index].getPLights().size());
 	s.setVec3f("cam.viewPos", scenes[index].getActiveCamera().getPosition());
 	s.setMatrix("view", scenes[index].getActiveCamera().getViewMatrix());
 	s.setMatrix("proj", scenes[index].getActiveCamera().getProjectionMatrix());
-	s.setLighting(scenes[index].getPLights(), scenes[index].getDLights(), scenes[index].getSLights());
+
+	// lights are read per cluster from storage buffers, no cap on their number
+	clusterLights(index);
+	graphics.getLightClusters().bind(s);
 	s.setInt("hasSSAO", graphics.ssaoOn() ? 1 : 0);
 	glActiveTexture(GL_TEXTURE0 + 14);
-	glBindTexture(GL_TEXTURE_2D, graphics.getAOFBO(1)->getAttachments()[0].id);
+	glBindTexture(GL_TEXTURE_2D, graphics.getRenderGraph().getTexture("ao"));
 	s.setInt("ssao", 14);
 	s.setVec2f("viewport", glm::vec2(width, height));
 	
-    // set shadow maps (point first, dir second and spot last)
-	int nbPLights = scenes[index].getPLights().size();
-	int nbDLights = scenes[index].getDLights().size();
-	int nbSLights = scenes[index].getSLights().size();
-
-	int textureOffset{5};
-	
-    // "you have to uniform all elements in samplerCube array. Otherwise, there will be a"
-	// "black screen, or your clear color. Also, following draw calls may cause invalid "
-	// "operation. Better to uniform all unused sampler types with some random texture index."
-	for(int i{nbPLights}; i < 10; ++i)
-	{
-		s.setInt("omniDepthMap[" + std::to_string(i) + "]", textureOffset);
-	}
-
+    // set shadow maps (point lights in the cube map array, others in the atlas)
     if(graphics.shadowsOn())
-    {
-	    for(int i{0}; i < nbPLights; ++i)
-	    {
-	    	glActiveTexture(GL_TEXTURE0 + textureOffset);
-	    	glBindTexture(GL_TEXTURE_CUBE_MAP, graphics.getOmniDepthFBO(i)->getAttachments()[0].id);
-	    	s.setInt("omniDepthMap[" + std::to_string(i) + "]", textureOffset);
-	    	s.setMatrix("light[" + std::to_string(i) + "].lightSpaceMatrix", glm::mat4(1.0f));
-	    	textureOffset++;
-	    }
-
-	    int depthMapIndex{0};
-	    for(int i{0}; i < nbDLights; ++i)
-	    {
-		    glm::vec3 lightPosition = scenes[index].getDLights()[i]->getPosition();
-		    glm::vec3 lightTarget = lightPosition + scenes[index].getDLights()[i]->getDirection();
-		    glm::mat4 lightView = glm::lookAt(lightPosition, lightTarget, glm::vec3(0.0f, 1.0f, 0.0f));
-
-		    glActiveTexture(GL_TEXTURE0 + textureOffset);
-		    glBindTexture(GL_TEXTURE_2D, graphics.getStdDepthFBO(depthMapIndex)->getAttachments()[0].id);
-		    s.setInt("depthMap[" + std::to_string(depthMapIndex) + "]", textureOffset);
-		    s.setMatrix("light[" + std::to_string(i + nbPLights) + "].lightSpaceMatrix", graphics.getOrthoProjection(scenes[index].getDLights()[i]->getOrthoDimension()) * lightView);
-		    depthMapIndex++;
-		    textureOffset++;
-	    }
-
-	    for(int i{0}; i < nbSLights; ++i)
-	    {
-		    float outerCutOff = scenes[index].getSLights()[i]->getOuterCutOff();
-		    glm::vec3 lightPosition = scenes[index].getSLights()[i]->getPosition();
-		    glm::vec3 lightTarget = lightPosition + scenes[index].getSLights()[i]->getDirection();
-		    glm::mat4 lightView = glm::lookAt(lightPosition, lightTarget, glm::vec3(0.0f, 1.0f, 0.0f));
-		    glm::mat4 spotProj = glm::perspective(
-                    outerCutOff * 2.0f, 1.0f,
-					scenes[index].getActiveCamera().getNearPlane(),
-					scenes[index].getActiveCamera().getFarPlane()
-					);
+		setShadowUniforms(s, index, 5);
 
-		    glActiveTexture(GL_TEXTURE0 + textureOffset);
-		    glBindTexture(GL_TEXTURE_2D, graphics.getStdDepthFBO(depthMapIndex)->getAttachments()[0].id);
-		    s.setInt("depthMap[" + std::to_string(depthMapIndex) + "]", textureOffset);
-		    s.setMatrix("light[" + std::to_string(i + nbPLights + nbDLights) + "].lightSpaceMatrix", spotProj * lightView);
-		    depthMapIndex++;
-		    textureOffset++;
-	    }
-    }
-
-	scenes[index].draw(s, graphics, DRAW_TYPE::DRAW_OPAQUE, delta, mode, debug);
+	// deferred : opaque lit from the G-buffer, transparents stay forward
+	if(graphics.deferredOn())
+		deferredLightingPass(index, width, height);
+	else
+		scenes[index].draw(s, graphics, DRAW_TYPE::DRAW_OPAQUE, delta, mode, debug);
 	scenes[index].draw(s, graphics, DRAW_TYPE::DRAW_TRANSPARENT, delta, mode, debug);
+	if(graphics.oitOn())
+		orderIndependentPass(index, s, mode);
 
     // blit to normal framebuffer (resolve multisampling)
 	glReadBuffer(GL_COLOR_ATTACHMENT0);
 	graphics.getMultisampleFBO()->blitFramebuffer(graphics.getNormalFBO(0), width, height);
 	glReadBuffer(GL_COLOR_ATTACHMENT1);
 	graphics.getMultisampleFBO()->blitFramebuffer(graphics.getNormalFBO(1), width, height);
+}
+
+void Game::deferredLightingPass(int index, int width, int height)
+{
+	std::unique_ptr<Framebuffer> & gBuffer = graphics.getGBufferFBO();
+	Camera & cam = scenes[index].getActiveCamera();
 
-	// draw outline if shader type is TOON
-	if (s.getType() == SHADER_TYPE::TOON)
+	Shader & deferred = graphics.getDeferredLightingShader();
+	deferred.use();
+	const char * gBufferNames[] = {"gNormal", "gAlbedo", "gMetallicRough", "gEmission", "gDepth"};
+	for(int i{0}; i < 5; ++i)
 	{
-		toonOutline(width, height);
+		glActiveTexture(GL_TEXTURE0 + i);
+		glBindTexture(GL_TEXTURE_2D, gBuffer->getAttachments()[i].id);
+		deferred.setInt(gBufferNames[i], i);
 	}
+	deferred.setVec3f("cam.viewPos", cam.getPosition());
+	deferred.setMatrix("view", cam.getViewMatrix());
+	deferred.setMatrix("invViewProj", glm::inverse(cam.getProjectionMatrix() * cam.getViewMatrix()));
+	deferred.setVec2f("viewport", glm::vec2(width, height));
+	deferred.setVec2f("renderScale", graphics.getRenderScale());
+	graphics.getLightClusters().bind(deferred);
+
+	deferred.setInt("hasSSAO", graphics.ssaoOn() ? 1 : 0);
+	glActiveTexture(GL_TEXTURE0 + 14);
+	glBindTexture(GL_TEXTURE_2D, graphics.getRenderGraph().getTexture("ao"));
+	deferred.setInt("ssao", 14);
+
+	deferred.setInt("shadowOn", graphics.shadowsOn() ? 1 : 0);
+	if(graphics.shadowsOn())
+		setShadowUniforms(deferred, index, 7);
+
+	std::unique_ptr<IBL> & ibl = scenes[index].getIBL();
+	deferred.setInt("IBL", (ibl) ? 1 : 0);
+	if(ibl)
+	{
+		struct IBL_DATA iblData = ibl->get_IBL_data();
+		glActiveTexture(GL_TEXTURE0 + 15);
+		glBindTexture(GL_TEXTURE_CUBE_MAP, iblData.irradiance);
+		deferred.setInt("irradianceMap", 15);
+		glActiveTexture(GL_TEXTURE0 + 16);
+		glBindTexture(GL_TEXTURE_CUBE_MAP, iblData.prefilter);
+		deferred.setInt("prefilterMap", 16);
+		glActiveTexture(GL_TEXTURE0 + 17);
+		glBindTexture(GL_TEXTURE_2D, iblData.brdf);
+		deferred.setInt("brdfLUT", 17);
+	}
+
+	// full screen, writes the G-buffer depth so forward transparents are still depth tested
+	graphics.getScaledQuadMesh()->draw(deferred);
+}
+
+void Game::orderIndependentPass(int index, Shader & s, DRAWING_MODE mode)
+{
+	// weighted blended OIT : accumulation (attachment 2) and revealage (attachment 3)
+	GLenum oitBuffers[] = {GL_COLOR_ATTACHMENT2, GL_COLOR_ATTACHMENT3};
+	glDrawBuffers(2, oitBuffers);
+	float accumClear[] = {0.0f, 0.0f, 0.0f, 0.0f};
+	float revealClear[] = {1.0f, 1.0f, 1.0f, 1.0f};
+	glClearBufferfv(GL_COLOR, 0, accumClear);
+	glClearBufferfv(GL_COLOR, 1, revealClear);
+
+	// depth tested against the opaque geometry, never written
+	glDepthMask(GL_FALSE);
+	glBlendFunci(0, GL_ONE, GL_ONE);
+	glBlendFunci(1, GL_ZERO, GL_ONE_MINUS_SRC_COLOR);
+	scenes[index].drawOrderIndependent(s, mode);
+
+	// composite over the opaque color
+	GLenum colorBuffer[] = {GL_COLOR_ATTACHMENT0};
+	glDrawBuffers(1, colorBuffer);
+	glDisable(GL_DEPTH_TEST);
+	glBlendFunc(GL_ONE_MINUS_SRC_ALPHA, GL_SRC_ALPHA);
+
+	Shader & composite = graphics.getOITCompositingShader();
+	GLenum target = (graphics.getAntiAliasing() == ANTI_ALIASING::MSAA) ? GL_TEXTURE_2D_MULTISAMPLE : GL_TEXTURE_2D;
+	composite.use();
+	glActiveTexture(GL_TEXTURE0);
+	glBindTexture(target, graphics.getMultisampleFBO()->getAttachments()[2].id);
+	composite.setInt("accumulation", 0);
+	glActiveTexture(GL_TEXTURE1);
+	glBindTexture(target, graphics.getMultisampleFBO()->getAttachments()[3].id);
+	composite.setInt("revealage", 1);
+	graphics.getScaledQuadMesh()->draw(composite);
+
+	// restore default state
+	glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+	glEnable(GL_DEPTH_TEST);
+	glDepthMask(GL_TRUE);
+	GLenum colorBuffers[] = {GL_COLOR_ATTACHMENT0, GL_COLOR_ATTACHMENT1};
+	glDrawBuffers(2, colorBuffers);
 }
 
 void Game::toonOutline(int width, int height)
 {
-	Shader& cs_gaussianBlur = graphics.cs_gaussianBlur;
-	Shader& cs_sobel = graphics.cs_sobel;
-	Shader& cs_nms = graphics.cs_nms;
-	Shader& cs_double_thresholding = graphics.cs_double_thresholding;
-	Shader& cs_hysteresis = graphics.cs_hysteresis;
-	Shader& cs_dilate = graphics.cs_dilate;
-	Shader& cs_outline = graphics.cs_outline;
-
-	// horizontal blur
-	cs_gaussianBlur.use();
-	cs_gaussianBlur.setInt("blurSize", 5);
-	cs_gaussianBlur.setFloat("sigma", 1.0f);
-	cs_gaussianBlur.setInt("direction", 0);
-	glBindImageTexture(0, graphics.getNormalFBO(0)->getAttachments()[0].id, 0, GL_FALSE, 0, GL_READ_ONLY, GL_RGBA16F);
-	glBindImageTexture(1, graphics.toonOutlineRT[0].getId(), 0, GL_FALSE, 0, GL_WRITE_ONLY, GL_RGBA16F);
-	cs_gaussianBlur.dispatch(width / 8, height / 8, 1, GL_ALL_BARRIER_BITS);
-	// vertical blur
-	cs_gaussianBlur.setInt("direction", 1);
-	glBindImageTexture(0, graphics.toonOutlineRT[0].getId(), 0, GL_FALSE, 0, GL_READ_ONLY, GL_RGBA16F);
-	glBindImageTexture(1, graphics.toonOutlineRT[1].getId(), 0, GL_FALSE, 0, GL_WRITE_ONLY, GL_RGBA16F);
-	cs_gaussianBlur.dispatch(width / 8, height / 8, 1, GL_ALL_BARRIER_BITS);
-	// edge detection
-	cs_sobel.use();
-	glBindImageTexture(0, graphics.toonOutlineRT[1].getId(), 0, GL_FALSE, 0, GL_READ_ONLY, GL_RGBA16F);
-	glBindImageTexture(1, graphics.toonOutlineRT[0].getId(), 0, GL_FALSE, 0, GL_WRITE_ONLY, GL_RGBA16F);
-	cs_sobel.dispatch(width / 8, height / 8, 1, GL_ALL_BARRIER_BITS);
-	// NMS
-	cs_nms.use();
-	glBindImageTexture(0, graphics.toonOutlineRT[0].getId(), 0, GL_FALSE, 0, GL_READ_ONLY, GL_RGBA16F);
-	glBindImageTexture(1, graphics.toonOutlineRT[1].getId(), 0, GL_FALSE, 0, GL_WRITE_ONLY, GL_RGBA16F);
-	cs_nms.dispatch(width / 8, height / 8, 1, GL_ALL_BARRIER_BITS);
-	// double thresholding
-	cs_double_thresholding.use();
-	cs_double_thresholding.setFloat("low_thr", 0.1f);
-	cs_double_thresholding.setFloat("high_thr", 0.25f);
-	glBindImageTexture(0, graphics.toonOutlineRT[1].getId(), 0, GL_FALSE, 0, GL_READ_ONLY, GL_RGBA16F);
-	glBindImageTexture(1, graphics.toonOutlineRT[0].getId(), 0, GL_FALSE, 0, GL_WRITE_ONLY, GL_RGBA16F);
-	cs_double_thresholding.dispatch(width / 8, height / 8, 1, GL_ALL_BARRIER_BITS);
-	// hysteresis
-	cs_hysteresis.use();
-	cs_hysteresis.setFloat("weak", 0.5f);
-	cs_hysteresis.setFloat("strong", 1.0f);
-	glBindImageTexture(0, graphics.toonOutlineRT[0].getId(), 0, GL_FALSE, 0, GL_READ_ONLY, GL_RGBA16F);
-	glBindImageTexture(1, graphics.toonOutlineRT[1].getId(), 0, GL_FALSE, 0, GL_WRITE_ONLY, GL_RGBA16F);
-	cs_hysteresis.dispatch(width / 8, height / 8, 1, GL_ALL_BARRIER_BITS);
-	// dilation
-	cs_dilate.use();
-	glBindImageTexture(0, graphics.toonOutlineRT[1].getId(), 0, GL_FALSE, 0, GL_READ_ONLY, GL_RGBA16F);
-	glBindImageTexture(1, graphics.toonOutlineRT[0].getId(), 0, GL_FALSE, 0, GL_WRITE_ONLY, GL_RGBA16F);
-	cs_dilate.dispatch(width / 8, height / 8, 1, GL_ALL_BARRIER_BITS);
-	cs_dilate.use();
-	glBindImageTexture(0, graphics.toonOutlineRT[0].getId(), 0, GL_FALSE, 0, GL_READ_ONLY, GL_RGBA16F);
-	glBindImageTexture(1, graphics.toonOutlineRT[1].getId(), 0, GL_FALSE, 0, GL_WRITE_ONLY, GL_RGBA16F);
-	cs_dilate.dispatch(width / 8, height / 8, 1, GL_ALL_BARRIER_BITS);
-	cs_dilate.use();
-	// horizontal blur
-	cs_gaussianBlur.use();
-	cs_gaussianBlur.setInt("direction", 0);
-	glBindImageTexture(0, graphics.toonOutlineRT[1].getId(), 0, GL_FALSE, 0, GL_READ_ONLY, GL_RGBA16F);
-	glBindImageTexture(1, graphics.toonOutlineRT[0].getId(), 0, GL_FALSE, 0, GL_WRITE_ONLY, GL_RGBA16F);
-	cs_gaussianBlur.dispatch(width / 8, height / 8, 1, GL_ALL_BARRIER_BITS);
-	// vertical blur
-	cs_gaussianBlur.setInt("direction", 1);
-	glBindImageTexture(0, graphics.toonOutlineRT[0].getId(), 0, GL_FALSE, 0, GL_READ_ONLY, GL_RGBA16F);
-	glBindImageTexture(1, graphics.toonOutlineRT[1].getId(), 0, GL_FALSE, 0, GL_WRITE_ONLY, GL_RGBA16F);
-	cs_gaussianBlur.dispatch(width / 8, height / 8, 1, GL_ALL_BARRIER_BITS);
-	// outline
+	// 16 x 16 tiles, each stage of the edge detection works in shared memory
+	int groupsX = (width + 15) / 16;
+	int groupsY = (height + 15) / 16;
+	GLuint scene = graphics.getNormalFBO(0)->getAttachments()[0].id;
+	GLuint edges = graphics.getRenderGraph().getTexture("toon outline");
+
+	// blur, sobel, non maximum suppression, double thresholding, hysteresis
+	Shader& cs_edges = graphics.cs_toonEdges;
+	cs_edges.use();
+	cs_edges.setFloat("sigma", 1.0f);
+	cs_edges.setFloat("low_thr", 0.1f);
+	cs_edges.setFloat("high_thr", 0.25f);
+	glBindImageTexture(0, scene, 0, GL_FALSE, 0, GL_READ_ONLY, GL_RGBA16F);
+	glBindImageTexture(1, edges, 0, GL_FALSE, 0, GL_WRITE_ONLY, GL_R8);
+	cs_edges.dispatch(groupsX, groupsY, 1, GL_SHADER_IMAGE_ACCESS_BARRIER_BIT);
+
+	// dilation, blur and outline drawn over the scene
+	Shader& cs_outline = graphics.cs_toonOutline;
 	cs_outline.use();
+	cs_outline.setFloat("sigma", 1.0f);
 	cs_outline.setVec3f("outline_color", graphics.outlineColor);
-	glBindImageTexture(0, graphics.toonOutlineRT[1].getId(), 0, GL_FALSE, 0, GL_READ_ONLY, GL_RGBA16F);
-	glBindImageTexture(1, graphics.getNormalFBO(0)->getAttachments()[0].id, 0, GL_FALSE, 0, GL_WRITE_ONLY, GL_RGBA16F);
-	glBindImageTexture(2, graphics.getNormalFBO(0)->getAttachments()[0].id, 0, GL_FALSE, 0, GL_WRITE_ONLY, GL_RGBA16F);
-	cs_outline.dispatch(width / 8, height / 8, 1, GL_ALL_BARRIER_BITS);
+	glBindImageTexture(0, edges, 0, GL_FALSE, 0, GL_READ_ONLY, GL_R8);
+	glBindImageTexture(1, scene, 0, GL_FALSE, 0, GL_READ_WRITE, GL_RGBA16F);
+	cs_outline.dispatch(groupsX, groupsY, 1, GL_ALL_BARRIER_BITS);
 }
 
-void Game::bloomPass(int width, int height, std::unique_ptr<Framebuffer>& in, int attachmentIndex, GLuint out)
+void Game::bloomPass(int width, int height, int renderWidth, int renderHeight, const std::string & input, int attachmentIndex, const std::string & output)
 {
-	bool firstIteration{true};
-	Shader & downSampling = graphics.getDownSamplingShader();
-	Shader & upSampling = graphics.getUpSamplingShader();
-	Shader & gaussianBlur = graphics.getGaussianBlurShader();
-	Shader & tentBlur = graphics.getTentBlurShader();
-
-	// downsampling and blurring
-	for(int i{0}; i < 6; ++i)
-	{
-		downSampling.use();
-		int factor = std::pow(2, i+1);
-		glViewport(0, 0, width / factor, height / factor);
-		std::unique_ptr<Framebuffer> & fbo = graphics.getDownSamplingFBO(i);
-		fbo->bind();
-		glClear(GL_COLOR_BUFFER_BIT);
-		downSampling.setInt("image", 0);
-		glActiveTexture(GL_TEXTURE0);
-		if(firstIteration)
-		{
-			firstIteration = false;
-			glBindTexture(GL_TEXTURE_2D, in->getAttachments()[attachmentIndex].id);
-		}
-		else
-			glBindTexture(GL_TEXTURE_2D, graphics.getPingPongFBO(i*2-1)->getAttachments()[0].id);
-		graphics.getQuadMesh()->draw(downSampling);
-		
-        // apply horizontal gaussian blur
-		gaussianBlur.use();
-		std::unique_ptr<Framebuffer> & ping = graphics.getPingPongFBO(i*2);
-		ping->bind();
-		glClear(GL_COLOR_BUFFER_BIT);
-		gaussianBlur.setInt("image", 0);
-		gaussianBlur.setInt("blurSize", graphics.getBloomSize());
-		gaussianBlur.setFloat("sigma", graphics.getBloomSigma());
-		gaussianBlur.setInt("direction", 0);
+	// levels of a single half resolution texture : one downsample dispatch, then tent upsampling in place
+	RenderGraph & graph = graphics.getRenderGraph();
+	std::string chain = output + " levels";
+	graph.createTarget(chain, RenderTargetDesc(width / 2, height / 2, GL_RGBA16F, GL_RGBA, GL_FLOAT, GL_LINEAR, 1, BLOOM_LEVELS));
+	graph.createTarget(output, RenderTargetDesc(width, height));
+
+	graph.addPass(output, {input}, {chain, output}, [=, &graph](){
+		glm::vec2 renderScale(static_cast<float>(renderWidth) / width, static_cast<float>(renderHeight) / height);
+		GLuint source = graph.getTexture(input, attachmentIndex);
+		GLuint levels = graph.getTexture(chain);
+		int levelWidth = std::max(1, renderWidth / 2);
+		int levelHeight = std::max(1, renderHeight / 2);
+
+		// downsampling : 64x64 source texels per workgroup
+		Shader & downSample = graphics.cs_bloomDownSample;
+		downSample.use();
+		downSample.setInt("image", 0);
+		downSample.setVec2f("renderScale", renderScale);
 		glActiveTexture(GL_TEXTURE0);
-		glBindTexture(GL_TEXTURE_2D, graphics.getDownSamplingFBO(i)->getAttachments()[0].id);
-		graphics.getQuadMesh()->draw(gaussianBlur);
-
-		// apply vertical gaussian blur
-		std::unique_ptr<Framebuffer> & pong = graphics.getPingPongFBO(i*2+1);
-		pong->bind();
-		glClear(GL_COLOR_BUFFER_BIT);
-		gaussianBlur.setInt("image", 0);
-		gaussianBlur.setInt("blurSize", graphics.getBloomSize());
-		gaussianBlur.setFloat("sigma", graphics.getBloomSigma());
-		gaussianBlur.setInt("direction", 1);
-		glActiveTexture(GL_TEXTURE0);
-		glBindTexture(GL_TEXTURE_2D, graphics.getPingPongFBO(i*2)->getAttachments()[0].id);
-		graphics.getQuadMesh()->draw(gaussianBlur);
-    }
-
-	// upsampling
-	firstIteration = true;
-	for(int i{0}; i < 6; ++i)
-	{
-		upSampling.use();
-        upSampling.setInt("merge_to_current_FBO", 0);
-		int factor = std::pow(2, 5-i);
-		glViewport(0, 0, width / factor, height / factor);
-		std::unique_ptr<Framebuffer> & mergeFBO = graphics.getUpSamplingFBO(i*2);
-		mergeFBO->bind();
-		glClear(GL_COLOR_BUFFER_BIT);
-		upSampling.setInt("low_res", 0);
-		upSampling.setInt("high_res", 1);
+		glBindTexture(GL_TEXTURE_2D, source);
+		for(int l{0}; l < BLOOM_LEVELS; ++l)
+			glBindImageTexture(l, levels, l, GL_FALSE, 0, GL_WRITE_ONLY, GL_RGBA16F);
+		downSample.dispatch((levelWidth + 31) / 32, (levelHeight + 31) / 32, 1, GL_SHADER_IMAGE_ACCESS_BARRIER_BIT | GL_TEXTURE_FETCH_BARRIER_BIT);
+
+		// upsampling : each level gets the tent filtered level below
+		Shader & upSample = graphics.cs_bloomUpSample;
+		upSample.use();
+		upSample.setInt("low_res", 0);
+		upSample.setInt("high_res", 1);
+		upSample.setVec2f("renderScale", renderScale);
 		glActiveTexture(GL_TEXTURE0);
-		if(firstIteration)
+		glBindTexture(GL_TEXTURE_2D, levels);
+		glActiveTexture(GL_TEXTURE1);
+		glBindTexture(GL_TEXTURE_2D, source);
+		for(int l = BLOOM_LEVELS - 2; l >= -1; --l)
 		{
-			firstIteration = false;
-			glBindTexture(GL_TEXTURE_2D, graphics.getPingPongFBO((5-i)*2+1)->getAttachments()[0].id);
+			// level -1 : the output, at the source resolution
+			int w = (l == -1) ? renderWidth : std::max(1, levelWidth >> l);
+			int h = (l == -1) ? renderHeight : std::max(1, levelHeight >> l);
+			if(l == -1)
+				glBindImageTexture(0, graph.getTexture(output), 0, GL_FALSE, 0, GL_WRITE_ONLY, GL_RGBA16F);
+			else
+				glBindImageTexture(0, levels, l, GL_FALSE, 0, GL_READ_WRITE, GL_RGBA16F);
+			upSample.setInt("low_res_level", l + 1);
+			upSample.setInt("merge_source", (l == -1) ? 1 : 0);
+			upSample.dispatch((w + 15) / 16, (h + 15) / 16, 1, GL_SHADER_IMAGE_ACCESS_BARRIER_BIT | GL_TEXTURE_FETCH_BARRIER_BIT);
 		}
-		else
-			glBindTexture(GL_TEXTURE_2D, graphics.getUpSamplingFBO((i-1)*2+1)->getAttachments()[0].id);
-		glActiveTexture(GL_TEXTURE1);
-		if(4-i == -1)
-			glBindTexture(GL_TEXTURE_2D, in->getAttachments()[attachmentIndex].id);
-		else
-			glBindTexture(GL_TEXTURE_2D, graphics.getPingPongFBO((4-i)*2+1)->getAttachments()[0].id);
-		graphics.getQuadMesh()->draw(upSampling);
-
-		// apply tent filter
-		tentBlur.use();
-		std::unique_ptr<Framebuffer> & tentFBO = graphics.getUpSamplingFBO(i*2+1);
-		tentFBO->bind();
-		glClear(GL_COLOR_BUFFER_BIT);
-		tentBlur.setInt("image", 0);
-		glActiveTexture(GL_TEXTURE0);
-		glBindTexture(GL_TEXTURE_2D, graphics.getUpSamplingFBO(i*2)->getAttachments()[0].id);
-		graphics.getQuadMesh()->draw(tentBlur);
-	}
-	glCopyImageSubData(graphics.getUpSamplingFBO(11)->getAttachments()[0].id, GL_TEXTURE_2D, 0, 0, 0, 0, out, GL_TEXTURE_2D, 0, 0, 0, 0, width, height, 1);
+	});
 }
 
 void Game::GBufferPass(int index, int width, int height, float delta)
 {
+	// material attachments are only filled for the deferred path
+	bool deferred = graphics.deferredOn();
+	GLenum gBuffers[] = {GL_COLOR_ATTACHMENT0, GL_COLOR_ATTACHMENT1, GL_COLOR_ATTACHMENT2, GL_COLOR_ATTACHMENT3};
 	graphics.getGBufferFBO()->bind();
+	glDrawBuffers((deferred) ? 4 : 1, gBuffers);
 	glViewport(0, 0, width, height);
 	glClearColor(0.0f, 0.0f, 0.0f, 1.0f);
 	glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
 
-	// render position, normal, and depth data
+	// render normal and depth data
 	graphics.getGBufferShader().use();
+	graphics.getGBufferShader().setInt("deferred", (deferred) ? 1 : 0);
 	graphics.getGBufferShader().setMatrix("view", scenes[index].getActiveCamera().getViewMatrix());
 	graphics.getGBufferShader().setMatrix("proj", scenes[index].getActiveCamera().getProjectionMatrix());
-	scenes[index].draw(graphics.getGBufferShader(), graphics, DRAW_TYPE::DRAW_BOTH, delta);
+	// packed targets carry no alpha, never blended
+	glDisable(GL_BLEND);
+	scenes[index].draw(graphics.getGBufferShader(), graphics, (deferred) ? DRAW_TYPE::DRAW_OPAQUE : DRAW_TYPE::DRAW_BOTH, delta);
+	glEnable(GL_BLEND);
 }
 
 void Game::ssaoPass(int index, int width, int height, float delta)
 {
-	graphics.getAOFBO(0)->bind();
-	glViewport(0, 0, width, height);
+	int w = width / SSAO_DOWNSAMPLE;
+	int h = height / SSAO_DOWNSAMPLE;
+	glm::mat4 proj = scenes[index].getActiveCamera().getProjectionMatrix();
+	glm::mat4 invProj = glm::inverse(proj);
+	GLuint depth = graphics.getGBufferFBO()->getAttachments()[4].id;
 	glClearColor(0.0f, 0.0f, 0.0f, 1.0f);
+	glDisable(GL_BLEND); // linear depth is stored in alpha
+
+	// low resolution view normal and linear depth
+	graphics.getRenderGraph().getFBO("ao normal depth")->bind();
+	glViewport(0, 0, w, h);
+	glClear(GL_COLOR_BUFFER_BIT);
+
+	Shader & downSample{graphics.getAODownSamplingShader()};
+	downSample.use();
+	glActiveTexture(GL_TEXTURE0);
+	glBindTexture(GL_TEXTURE_2D, depth);
+	downSample.setInt("depthBuffer", 0);
+	glActiveTexture(GL_TEXTURE1);
+	glBindTexture(GL_TEXTURE_2D, graphics.getGBufferFBO()->getAttachments()[0].id); // octahedral normal
+	downSample.setInt("normalBuffer", 1);
+	downSample.setMatrix("invProjection", invProj);
+	downSample.setInt("downSample", SSAO_DOWNSAMPLE);
+	downSample.setVec2f("renderScale", graphics.getRenderScale());
+	graphics.getScaledQuadMesh()->draw(downSample);
+
+	// raw AO at low resolution, kernel read from its uniform buffer
+	graphics.getRenderGraph().getFBO("ao raw")->bind();
 	glClear(GL_COLOR_BUFFER_BIT);
 
     Shader & AOShader{graphics.getAOShader()};
 	AOShader.use();
+	glBindBufferBase(GL_UNIFORM_BUFFER, 3, graphics.getAOKernelBuffer());
 	glActiveTexture(GL_TEXTURE0);
-	glBindTexture(GL_TEXTURE_2D, graphics.getGBufferFBO()->getAttachments()[0].id); // position (view space)
-	AOShader.setInt("positionBuffer", 0);
-	glActiveTexture(GL_TEXTURE1);
-	glBindTexture(GL_TEXTURE_2D, graphics.getGBufferFBO()->getAttachments()[1].id); // normal
-	AOShader.setInt("normalBuffer", 1);
-	glActiveTexture(GL_TEXTURE2);
-	glBindTexture(GL_TEXTURE_2D, graphics.getAONoiseTexture()); // noise texture
-	AOShader.setInt("noiseTexture", 2);
+	glBindTexture(GL_TEXTURE_2D, graphics.getRenderGraph().getTexture("ao normal depth"));
+	AOShader.setInt("normalDepth", 0);
     AOShader.setInt("kernelSize", graphics.getAOSampleCount());
-	std::vector<glm::vec3> & aoKernel{graphics.getAOKernel()};
-	for(int i{0}; i < graphics.getAOSampleCount(); ++i)
-		AOShader.setVec3f("samples[" + std::to_string(i) + "]", aoKernel[i]);
 	AOShader.setFloat("radius", graphics.getAORadius());
 	AOShader.setFloat("bias", 0.05f);
-	AOShader.setMatrix("projection", scenes[index].getActiveCamera().getProjectionMatrix());
-	AOShader.setFloat("screenWidth", static_cast<float>(width));
-	AOShader.setFloat("screenHeight", static_cast<float>(height));
-	graphics.getQuadMesh()->draw(AOShader);
+	AOShader.setMatrix("projection", proj);
+	AOShader.setMatrix("invProjection", invProj);
+	AOShader.setVec2f("renderScale", graphics.getRenderScale());
+	graphics.getScaledQuadMesh()->draw(AOShader);
 
-	graphics.getAOFBO(1)->bind();
+	// depth aware blur and upsample to full resolution
+	graphics.getRenderGraph().getFBO("ao")->bind();
 	glViewport(0, 0, width, height);
-	glClearColor(0.0f, 0.0f, 0.0f, 1.0f);
 	glClear(GL_COLOR_BUFFER_BIT);
 	
-	graphics.getAOBlurShader().use();
+	Shader & blur{graphics.getAOBlurShader()};
+	blur.use();
 	glActiveTexture(GL_TEXTURE0);
-	glBindTexture(GL_TEXTURE_2D, graphics.getAOFBO(0)->getAttachments()[0].id); // raw AO
-	graphics.getAOBlurShader().setInt("aoInput", 0);
-	graphics.getQuadMesh()->draw(graphics.getAOBlurShader());
+	glBindTexture(GL_TEXTURE_2D, graphics.getRenderGraph().getTexture("ao raw")); // raw AO
+	blur.setInt("aoInput", 0);
+	glActiveTexture(GL_TEXTURE1);
+	glBindTexture(GL_TEXTURE_2D, graphics.getRenderGraph().getTexture("ao normal depth"));
+	blur.setInt("normalDepth", 1);
+	glActiveTexture(GL_TEXTURE2);
+	glBindTexture(GL_TEXTURE_2D, depth);
+	blur.setInt("depthBuffer", 2);
+	blur.setMatrix("invProjection", invProj);
+	blur.setVec2f("renderScale", graphics.getRenderScale());
+	graphics.getScaledQuadMesh()->draw(blur);
 
-	// reset clear color
+	// reset clear color and blending
 	glClearColor(0.0f, 0.0f, 0.0f, 0.0f);
+	glEnable(GL_BLEND);
 }
 
 void Game::volumetricsPass(int index, int width, int height, float delta, double elapsedTime)
 {
 	glClearColor(0.0f, 0.0f, 0.0f, 0.0f);
+	glDisable(GL_BLEND); // depth is stored in alpha
 
     // Downsample GBuffer frag world pos map (subsample by 2)
-	graphics.getVolumetricsFBO(0)->bind();
+	graphics.getRenderGraph().getFBO("volumetrics position")->bind();
 	glViewport(0, 0, width/2, height/2);
 	glClear(GL_COLOR_BUFFER_BIT);
 
+	Camera & cam = scenes[index].getActiveCamera();
+	glm::mat4 inv_viewProj = glm::inverse(cam.getProjectionMatrix() * cam.getViewMatrix());
+
     Shader VLDownSample = graphics.getVolumetricDownSamplingShader();
     VLDownSample.use();
     glActiveTexture(GL_TEXTURE0);
-	glBindTexture(GL_TEXTURE_2D, graphics.getGBufferFBO()->getAttachments()[3].id); // frag world position
-    VLDownSample.setInt("fragWorldPos", 0);
+	glBindTexture(GL_TEXTURE_2D, graphics.getGBufferFBO()->getAttachments()[4].id); // depth, world position rebuilt from it
+    VLDownSample.setInt("depthMap", 0);
+    VLDownSample.setMatrix("inv_viewProj", inv_viewProj);
+    VLDownSample.setVec2f("renderScale", graphics.getRenderScale());
 	
-    graphics.getQuadMesh()->draw(VLDownSample);
+    graphics.getScaledQuadMesh()->draw(VLDownSample);
 
     // Render volumetric lighting
-	graphics.getVolumetricsFBO(1)->bind();
+	graphics.getRenderGraph().getFBO("volumetrics raymarch")->bind();
 	glClear(GL_COLOR_BUFFER_BIT);
 
 	Shader s = graphics.getVolumetricLightingShader();
@@ -853,112 +1177,73 @@ void Game::volumetricsPass(int index, int width, int height, float delta, double
 	s.setVec3f("cam.viewPos", scenes[index].getActiveCamera().getPosition());
 	s.setFloat("cam.near_plane", scenes[index].getActiveCamera().getNearPlane());
 	s.setFloat("cam.far_plane", scenes[index].getActiveCamera().getFarPlane());
-	glm::mat4 inv_viewProj = glm::inverse(scenes[index].getActiveCamera().getProjectionMatrix() * scenes[index].getActiveCamera().getViewMatrix());
 	s.setMatrix("cam.inv_viewProj", inv_viewProj);
 	glActiveTexture(GL_TEXTURE0 + 10);
-	glBindTexture(GL_TEXTURE_2D, graphics.getGBufferFBO()->getAttachments()[2].id); // depth of each fragment
+	glBindTexture(GL_TEXTURE_2D, graphics.getGBufferFBO()->getAttachments()[4].id); // depth of each fragment
 	s.setInt("cam.depthMap", 10);
 	glActiveTexture(GL_TEXTURE0 + 11);
-	glBindTexture(GL_TEXTURE_2D, graphics.getVolumetricsFBO(0)->getAttachments()[0].id); // world position of each fragment
+	glBindTexture(GL_TEXTURE_2D, graphics.getRenderGraph().getTexture("volumetrics position")); // world position of each fragment
 	s.setInt("worldPosMap", 11);
-	s.setInt("N", 50);
+	s.setInt("N", VOLUMETRICS_STEPS);
+	s.setFloat("jitter", std::fmod((graphics.volumetricsFrame % 1024) * 0.618034f, 1.0f)); // golden ratio sequence
 	s.setFloat("time", elapsedTime);
 
 	s.setLighting(scenes[index].getPLights(), scenes[index].getDLights(), scenes[index].getSLights());
 
-	// set shadow maps (point first, dir second and spot last)
-	int nbPLights = scenes[index].getPLights().size();
-	int nbDLights = scenes[index].getDLights().size();
-	int nbSLights = scenes[index].getSLights().size();
-
-	for(int i{0}; i < nbPLights; ++i)
-	{
-		glActiveTexture(GL_TEXTURE0 + i);
-		glBindTexture(GL_TEXTURE_CUBE_MAP, graphics.getOmniDepthFBO(i)->getAttachments()[0].id);
-		s.setInt("omniDepthMap[" + std::to_string(i) + "]", i);
-		s.setMatrix("light[" + std::to_string(i) + "].lightSpaceMatrix", glm::mat4(1.0f));
-	}
-	// "you have to uniform all elements in samplerCube array. Otherwise, there will be a"
-	// "black screen, or your clear color. Also, following draw calls may cause invalid "
-	// "operation. Better to uniform all unused sampler types with some random texture index."
-	for(int i{nbPLights}; i < 10; ++i)
-	{
-		s.setInt("omniDepthMap[" + std::to_string(i) + "]", nbPLights);
-	}
-
-	for(int i{0}; i < nbDLights; ++i)
-	{
-		glm::vec3 lightPosition = scenes[index].getDLights()[i]->getPosition();
-		glm::vec3 lightTarget = lightPosition + scenes[index].getDLights()[i]->getDirection();
-		glm::mat4 lightView = glm::lookAt(lightPosition, lightTarget, glm::vec3(0.0f, 1.0f, 0.0f));
-
-		glActiveTexture(GL_TEXTURE0 + nbPLights + i);
-		glBindTexture(GL_TEXTURE_2D, graphics.getStdDepthFBO(i)->getAttachments()[0].id);
-		s.setInt("depthMap[" + std::to_string(i) + "]", nbPLights + i);
-		s.setMatrix("light[" + std::to_string(i + nbPLights) + "].lightSpaceMatrix", graphics.getOrthoProjection(scenes[index].getDLights()[i]->getOrthoDimension()) * lightView);
-	}
-
-	for(int i{0}; i < nbSLights; ++i)
-	{
-		float outerCutOff = scenes[index].getSLights()[i]->getOuterCutOff();
-		glm::vec3 lightPosition = scenes[index].getSLights()[i]->getPosition();
-		glm::vec3 lightTarget = lightPosition + scenes[index].getSLights()[i]->getDirection();
-		glm::mat4 lightView = glm::lookAt(lightPosition, lightTarget, glm::vec3(0.0f, 1.0f, 0.0f));
-		glm::mat4 spotProj = glm::perspective(
-					outerCutOff * 2.0f, 1.0f,
-					scenes[index].getActiveCamera().getNearPlane(),
-					scenes[index].getActiveCamera().getFarPlane()
-					);
-
-		glActiveTexture(GL_TEXTURE0 + nbPLights + nbDLights + i);
-		glBindTexture(GL_TEXTURE_2D, graphics.getStdDepthFBO(nbDLights + i)->getAttachments()[0].id);
-		s.setInt("depthMap[" + std::to_string(nbDLights + i) + "]", nbPLights + nbDLights + i);
-		s.setMatrix("light[" + std::to_string(i + nbPLights + nbDLights) + "].lightSpaceMatrix", spotProj * lightView);
-	}
+	// set shadow maps (point lights in the cube map array, others in the atlas)
+	setShadowUniforms(s, index, 0);
 	
-	graphics.getQuadMesh()->draw(s);
-
-    // Bilateral blur
-	graphics.getVolumetricsFBO(2)->bind();
-	glClear(GL_COLOR_BUFFER_BIT);
+	graphics.getScaledQuadMesh()->draw(s);
 
-    Shader & bilateralBlur = graphics.getBilateralBlurShader();
-    bilateralBlur.use();
-    glActiveTexture(GL_TEXTURE0);
-    glBindTexture(GL_TEXTURE_2D, graphics.getVolumetricsFBO(1)->getAttachments()[0].id);
-    bilateralBlur.setInt("image", 0);
-    bilateralBlur.setInt("kernelSize", 5);
-    bilateralBlur.setFloat("sigma", 1.5f);
-    bilateralBlur.setInt("direction", 0); // horizontal
-    graphics.getQuadMesh()->draw(bilateralBlur);
-	
-    graphics.getVolumetricsFBO(1)->bind();
+    // Temporal accumulation, history reprojected with the previous camera
+    int frame = graphics.volumetricsFrame;
+    std::unique_ptr<Framebuffer> & history = graphics.getVolumetricsHistoryFBO(frame % 2);
+    std::unique_ptr<Framebuffer> & accumulated = graphics.getVolumetricsHistoryFBO((frame + 1) % 2);
+	accumulated->bind();
 	glClear(GL_COLOR_BUFFER_BIT);
 
+    Shader & VLTemporal = graphics.getVolumetricTemporalShader();
+    VLTemporal.use();
     glActiveTexture(GL_TEXTURE0);
-    glBindTexture(GL_TEXTURE_2D, graphics.getVolumetricsFBO(2)->getAttachments()[0].id);
-    bilateralBlur.setInt("direction", 1); // vertical
-    graphics.getQuadMesh()->draw(bilateralBlur);
+    glBindTexture(GL_TEXTURE_2D, graphics.getRenderGraph().getTexture("volumetrics raymarch"));
+    VLTemporal.setInt("current", 0);
+    glActiveTexture(GL_TEXTURE1);
+    glBindTexture(GL_TEXTURE_2D, history->getAttachments()[0].id);
+    VLTemporal.setInt("history", 1);
+    glActiveTexture(GL_TEXTURE2);
+    glBindTexture(GL_TEXTURE_2D, graphics.getRenderGraph().getTexture("volumetrics position"));
+    VLTemporal.setInt("worldPosDepth", 2);
+    VLTemporal.setMatrix("inv_viewProj", inv_viewProj);
+    VLTemporal.setMatrix("prev_viewProj", cam.getProjectionMatrix() * cam.getPreviousViewMatrix());
+    VLTemporal.setInt("historyValid", (frame > 0) ? 1 : 0);
+    VLTemporal.setFloat("blendFactor", 0.1f);
+    VLTemporal.setVec2f("renderScale", graphics.getRenderScale());
+    graphics.getScaledQuadMesh()->draw(VLTemporal);
 		
-    // Upsample result to screen resolution
-	graphics.getVolumetricsFBO(3)->bind();
+    // Depth aware upsample to screen resolution
+	graphics.getRenderGraph().getFBO("volumetrics")->bind();
 	glViewport(0, 0, width, height);
 	glClear(GL_COLOR_BUFFER_BIT);
 
-	Shader & VLUpSample = graphics.getUpSamplingShader();
+	Shader & VLUpSample = graphics.getVolumetricUpSamplingShader();
     VLUpSample.use();
     glActiveTexture(GL_TEXTURE0);
-	glBindTexture(GL_TEXTURE_2D, graphics.getVolumetricsFBO(1)->getAttachments()[0].id);
-    VLUpSample.setInt("low_res", 0);
+	glBindTexture(GL_TEXTURE_2D, accumulated->getAttachments()[0].id);
+    VLUpSample.setInt("volumetrics", 0);
     glActiveTexture(GL_TEXTURE1);
-	glBindTexture(GL_TEXTURE_2D, graphics.getVolumetricsFBO(1)->getAttachments()[0].id);
-    VLUpSample.setInt("high_res", 1);
-    VLUpSample.setInt("merge_to_current_FBO", 1);
-	
-    graphics.getQuadMesh()->draw(VLUpSample);
-
-    // reset clear color
+	glBindTexture(GL_TEXTURE_2D, graphics.getRenderGraph().getTexture("volumetrics position"));
+    VLUpSample.setInt("worldPosDepth", 1);
+    glActiveTexture(GL_TEXTURE2);
+	glBindTexture(GL_TEXTURE_2D, graphics.getGBufferFBO()->getAttachments()[4].id);
+    VLUpSample.setInt("depthMap", 2);
+    VLUpSample.setFloat("near_plane", cam.getNearPlane());
+    VLUpSample.setFloat("far_plane", cam.getFarPlane());
+    graphics.getScaledQuadMesh()->draw(VLUpSample);
+    graphics.volumetricsFrame++;
+
+    // reset clear color and blending
 	glClearColor(0.0f, 0.0f, 0.0f, 0.0f);
+	glEnable(GL_BLEND);
 }
 
 void Game::motionBlurPass(int index, int width, int height)
@@ -969,105 +1254,118 @@ void Game::motionBlurPass(int index, int width, int height)
     glm::mat4 proj = cam.getProjectionMatrix();
     Shader & shader = graphics.motionBlur;
     
-    graphics.motionBlurFBO->bind();
+    graphics.getRenderGraph().getFBO("motion blur")->bind();
     glClear(GL_COLOR_BUFFER_BIT);
     shader.use();
     shader.setMatrix("curr_MVP", proj * view);
     shader.setMatrix("prev_MVP", proj * prev_view);
+    shader.setMatrix("inv_viewProj", glm::inverse(proj * view));
+    shader.setVec2f("renderScale", graphics.getRenderScale());
     glActiveTexture(GL_TEXTURE0);
-	glBindTexture(GL_TEXTURE_2D, graphics.getGBufferFBO()->getAttachments()[3].id); // frag world position
-    shader.setInt("worldPos", 0);
-    graphics.quad->draw(shader);
+	glBindTexture(GL_TEXTURE_2D, graphics.getGBufferFBO()->getAttachments()[4].id); // depth, world position rebuilt from it
+    shader.setInt("depthMap", 0);
+    graphics.getScaledQuadMesh()->draw(shader);
 }
 
-void Game::compositingPass()
+void Game::fxaaPass(int width, int height)
 {
-	{ sceneCompositing(); uiCompositing(); }
-
-	glBindFramebuffer(GL_FRAMEBUFFER, 0);
-	glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
-	Shader& s{graphics.end};
-	s.use();
+	// edges of the rendered part only, lower left corner of the targets
+	graphics.getRenderGraph().getFBO("scene fxaa")->bind();
+	glViewport(0, 0, width, height);
+	glDisable(GL_BLEND);
 
+	Shader & fxaa = graphics.getFXAAShader();
+	fxaa.use();
 	glActiveTexture(GL_TEXTURE0);
-	glBindTexture(GL_TEXTURE_2D, graphics.compositeFBO[0]->getAttachments()[0].id);
-	s.setInt("scene", 0);
-	glActiveTexture(GL_TEXTURE1);
-	glBindTexture(GL_TEXTURE_2D, graphics.compositeFBO[1]->getAttachments()[0].id);
-	s.setInt("ui", 1);
-	glActiveTexture(GL_TEXTURE2);
-	glBindTexture(GL_TEXTURE_2D, graphics.compositeFBO[1]->getAttachments()[1].id);
-	s.setInt("ui_mask", 2);
+	glBindTexture(GL_TEXTURE_2D, graphics.getNormalFBO(0)->getAttachments()[0].id);
+	fxaa.setInt("scene", 0);
+	fxaa.setVec2f("renderScale", graphics.getRenderScale());
+	graphics.getScaledQuadMesh()->draw(fxaa);
 
-	graphics.getQuadMesh()->draw(s);
+	glEnable(GL_BLEND);
 }
 
-void Game::sceneCompositing()
+void Game::taaPass(int index, int width, int height)
 {
-	graphics.compositeFBO[0]->bind();
-	glClear(GL_COLOR_BUFFER_BIT);
-
-	Shader& s{graphics.sceneCompositing};
-	s.use();
+	// current frame blended into the reprojected history, camera velocity rebuilt from depth
+	Camera & cam = scenes[index].getActiveCamera();
+	int frame = graphics.taaFrame;
+	std::unique_ptr<Framebuffer> & history = graphics.getTAAHistoryFBO(frame % 2);
+	std::unique_ptr<Framebuffer> & accumulated = graphics.getTAAHistoryFBO((frame + 1) % 2);
+	accumulated->bind();
+	glViewport(0, 0, width, height);
+	glDisable(GL_BLEND);
 
+	Shader & taa = graphics.getTAAShader();
+	taa.use();
 	glActiveTexture(GL_TEXTURE0);
 	glBindTexture(GL_TEXTURE_2D, graphics.getNormalFBO(0)->getAttachments()[0].id);
-	s.setInt("scene", 0);
-	if (graphics.bloomOn())
-	{
-		glActiveTexture(GL_TEXTURE1);
-		glBindTexture(GL_TEXTURE_2D, graphics.getBloomTexture(0));
-		s.setInt("bloom", 1);
-		s.setInt("bloomEffect", 1);
-	}
-	else
-	{
-		s.setInt("bloomEffect", 0);
-	}
-	if (graphics.volumetricLightingOn())
-	{
-		glActiveTexture(GL_TEXTURE2);
-		glBindTexture(GL_TEXTURE_2D, graphics.getVolumetricsFBO(3)->getAttachments()[0].id);
-		s.setInt("volumetrics", 2);
-		s.setInt("volumetricsOn", 1);
-	}
-	else
-	{
-		s.setInt("volumetricsOn", 0);
-	}
-	if (graphics.motionBlurFX)
-	{
-		glActiveTexture(GL_TEXTURE3);
-		glBindTexture(GL_TEXTURE_2D, graphics.motionBlurFBO->getAttachments()[0].id);
-		s.setInt("motionBlur", 3);
-		s.setInt("motionBlurOn", 1);
-		s.setInt("motionBlurStrength", graphics.motionBlurStrength);
-	}
-	else
-	{
-		s.setInt("motionBlurOn", 0);
-	}
-
-	s.setInt("tone_mapping", static_cast<int>(graphics.get_scene_tone_mapping()));
-	graphics.getQuadMesh()->draw(s);
+	taa.setInt("current", 0);
+	glActiveTexture(GL_TEXTURE1);
+	glBindTexture(GL_TEXTURE_2D, history->getAttachments()[0].id);
+	taa.setInt("history", 1);
+	glActiveTexture(GL_TEXTURE2);
+	glBindTexture(GL_TEXTURE_2D, graphics.getGBufferFBO()->getAttachments()[4].id);
+	taa.setInt("depthMap", 2);
+	taa.setMatrix("inv_viewProj", glm::inverse(cam.getProjectionMatrix() * cam.getViewMatrix()));
+	taa.setMatrix("prev_viewProj", cam.getProjectionMatrix() * cam.getPreviousViewMatrix());
+	taa.setInt("historyValid", (frame > 0) ? 1 : 0);
+	taa.setFloat("blendFactor", 0.1f);
+	taa.setVec2f("renderScale", graphics.getRenderScale());
+	graphics.getScaledQuadMesh()->draw(taa);
+	graphics.taaFrame++;
+
+	glEnable(GL_BLEND);
 }
 
-void Game::uiCompositing()
+void Game::compositingPass(const std::string & scene)
 {
-	graphics.compositeFBO[1]->bind();
-	glClear(GL_COLOR_BUFFER_BIT);
-
-	Shader& s{ graphics.uiCompositing };
+	// scene effects, tone mapping, grading and user interface in a single pass to the screen
+	glBindFramebuffer(GL_FRAMEBUFFER, 0);
+	glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+	RenderGraph & graph = graphics.getRenderGraph();
+	glm::vec2 renderScale = graphics.getRenderScale();
+	bool sharpen = (renderScale.x < 1.0f || renderScale.y < 1.0f) && graphics.getUpscaleSharpness() > 0.0f;
+
+	int effects{0};
+	effects |= (graphics.bloomOn()) ? POST_BLOOM : 0;
+	effects |= (graph.hasTarget("volumetrics")) ? POST_VOLUMETRICS : 0;
+	effects |= (graphics.motionBlurFX) ? POST_MOTION_BLUR : 0;
+	effects |= (sharpen) ? POST_SHARPEN : 0;
+	effects |= (graphics.vignetteOn()) ? POST_VIGNETTE : 0;
+	effects |= (graphics.colorGradingOn()) ? POST_COLOR_GRADING : 0;
+	Shader & s = graphics.getPostShader(effects);
 	s.use();
 
 	glActiveTexture(GL_TEXTURE0);
-	glBindTexture(GL_TEXTURE_2D, graphics.userInterfaceFBO->getAttachments()[0].id);
-	s.setInt("ui", 0);
-	
+	glBindTexture(GL_TEXTURE_2D, graph.getTexture(scene));
+	s.setInt("scene", 0);
 	glActiveTexture(GL_TEXTURE1);
-	glBindTexture(GL_TEXTURE_2D, graphics.getBloomTexture(1));
-	s.setInt("uiBloom", 1);
-	
-	s.setInt("tone_mapping", static_cast<int>(graphics.get_ui_tone_mapping()));
+	glBindTexture(GL_TEXTURE_2D, graph.getTexture("scene bloom"));
+	s.setInt("bloom", 1);
+	glActiveTexture(GL_TEXTURE2);
+	glBindTexture(GL_TEXTURE_2D, graph.getTexture("volumetrics"));
+	s.setInt("volumetrics", 2);
+	glActiveTexture(GL_TEXTURE3);
+	glBindTexture(GL_TEXTURE_2D, graph.getTexture("motion blur"));
+	s.setInt("motionBlur", 3);
+	s.setInt("motionBlurStrength", graphics.motionBlurStrength);
+	glActiveTexture(GL_TEXTURE4);
+	glBindTexture(GL_TEXTURE_2D, graph.getTexture("ui"));
+	s.setInt("ui", 4);
+	glActiveTexture(GL_TEXTURE5);
+	glBindTexture(GL_TEXTURE_2D, graph.getTexture("ui bloom"));
+	s.setInt("uiBloom", 5);
+
+	// upscale of the rendered part, sharpened only when it is smaller than the screen
+	s.setVec2f("renderScale", renderScale);
+	s.setFloat("sharpness", graphics.getUpscaleSharpness());
+
+	s.setFloat("exposure", graphics.getExposure());
+	s.setInt("scene_tone_mapping", static_cast<int>(graphics.get_scene_tone_mapping()));
+	s.setInt("ui_tone_mapping", static_cast<int>(graphics.get_ui_tone_mapping()));
+	s.setFloat("saturation", graphics.saturation);
+	s.setFloat("contrast", graphics.contrast);
+	s.setVec3f("colorFilter", graphics.colorFilter);
 	graphics.getQuadMesh()->draw(s);
 }
\ No newline at end of file
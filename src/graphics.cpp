@@ -8,238 +8,91 @@ Graphics::Graphics(int width, int height) :
 	far(100.0f),
 	shadows(true),
 	bloomEffect{true},
-	bloomSigma(4.0f),
-	bloomSize(15),
 	ssaoEffect{true},
     ssaoSampleCount{32},
     ssaoRadius{1.0f},
 	volumetricsOn{false},
+	volumetricsFrame(0),
+	oitEffect{true},
+	deferredShading{false},
+	antiAliasing(ANTI_ALIASING::MSAA),
+	taaFrame(0),
     motionBlurFX(false),
     motionBlurStrength(100),
+	renderScale(1.0f),
+	upscaleSharpness(0.5f),
+	exposure(1.0f),
+	vignette{true},
+	colorGrading{false},
+	saturation(1.0f),
+	contrast(1.0f),
+	colorFilter(1.0f),
 	outlineColor(0.0f, 0.0f, 0.0f),
-	multisample{std::make_unique<Framebuffer>(true, true, true)},
 	normal{
 		std::make_unique<Framebuffer>(true, false, true),
 		std::make_unique<Framebuffer>(true, false, true)
 	},
-	omniDepth{
-		std::make_unique<Framebuffer>(false),
-		std::make_unique<Framebuffer>(false),
-		std::make_unique<Framebuffer>(false),
-		std::make_unique<Framebuffer>(false),
-		std::make_unique<Framebuffer>(false),
-		std::make_unique<Framebuffer>(false),
-		std::make_unique<Framebuffer>(false),
-		std::make_unique<Framebuffer>(false),
-		std::make_unique<Framebuffer>(false),
-		std::make_unique<Framebuffer>(false)
-	},
-	stdDepth{
-		std::make_unique<Framebuffer>(false),
-		std::make_unique<Framebuffer>(false),
-		std::make_unique<Framebuffer>(false),
-		std::make_unique<Framebuffer>(false),
-		std::make_unique<Framebuffer>(false),
-		std::make_unique<Framebuffer>(false),
-		std::make_unique<Framebuffer>(false),
-		std::make_unique<Framebuffer>(false),
-		std::make_unique<Framebuffer>(false),
-		std::make_unique<Framebuffer>(false)
-		},
+	shadowAtlasFBO{std::make_unique<Framebuffer>(false)},
+	shadowAtlasCacheFBO{std::make_unique<Framebuffer>(false)},
+	shadowAtlas(SHADOW_ATLAS_SIZE, static_cast<int>(SHADOW_QUALITY::TINY)),
+	omniShadowResolution(0),
+	omniShadowCapacity(0),
 	GBuffer{std::make_unique<Framebuffer>(true, false, true)},
-	AOBuffer{
-		std::make_unique<Framebuffer>(true, false, true),
-		std::make_unique<Framebuffer>(true, false, true)
-	},
-	downSampling{
-		std::make_unique<Framebuffer>(true, false, true),
-		std::make_unique<Framebuffer>(true, false, true),
-		std::make_unique<Framebuffer>(true, false, true),
-		std::make_unique<Framebuffer>(true, false, true),
-		std::make_unique<Framebuffer>(true, false, true),
-		std::make_unique<Framebuffer>(true, false, true)
-		},
-	ping_pong{
-		std::make_unique<Framebuffer>(true, false, true),
-		std::make_unique<Framebuffer>(true, false, true),
-		std::make_unique<Framebuffer>(true, false, true),
-		std::make_unique<Framebuffer>(true, false, true),
-		std::make_unique<Framebuffer>(true, false, true),
-		std::make_unique<Framebuffer>(true, false, true),
-		std::make_unique<Framebuffer>(true, false, true),
-		std::make_unique<Framebuffer>(true, false, true),
-		std::make_unique<Framebuffer>(true, false, true),
-		std::make_unique<Framebuffer>(true, false, true),
-		std::make_unique<Framebuffer>(true, false, true),
-		std::make_unique<Framebuffer>(true, false, true)
-		},
-	upSampling{
-		std::make_unique<Framebuffer>(true, false, true),
-		std::make_unique<Framebuffer>(true, false, true),
-		std::make_unique<Framebuffer>(true, false, true),
-		std::make_unique<Framebuffer>(true, false, true),
-		std::make_unique<Framebuffer>(true, false, true),
-		std::make_unique<Framebuffer>(true, false, true),
-		std::make_unique<Framebuffer>(true, false, true),
-		std::make_unique<Framebuffer>(true, false, true),
-		std::make_unique<Framebuffer>(true, false, true),
-		std::make_unique<Framebuffer>(true, false, true),
-		std::make_unique<Framebuffer>(true, false, true),
-		std::make_unique<Framebuffer>(true, false, true)
-		},
-	volumetrics{
-        std::make_unique<Framebuffer>(true, false, true),
-        std::make_unique<Framebuffer>(true, false, true),
-        std::make_unique<Framebuffer>(true, false, true),
-        std::make_unique<Framebuffer>(true, false, true)
-    },
-    motionBlurFBO{std::make_unique<Framebuffer>(true, false, true)},
-    userInterfaceFBO{std::make_unique<Framebuffer>(true, false, true)},
-	compositeFBO{
-		std::make_unique<Framebuffer>(true, false, true),
-		std::make_unique<Framebuffer>(true, false, true)
-	},
-	toonOutlineRT{
-		RenderTexture(width, height, 1, GL_RGBA16F, GL_RGBA, GL_FLOAT),
-		RenderTexture(width, height, 1, GL_RGBA16F, GL_RGBA, GL_FLOAT)
-	},
+	screenWidth(width),
+	screenHeight(height),
 	omniPerspProjection(glm::perspective(glm::radians(90.0f), 1.0f, near, far)),
-	cs_gaussianBlur("shaders/compute/gaussian_blur.glsl", SHADER_TYPE::COMPUTE),
-	cs_sobel("shaders/compute/sobel.glsl", SHADER_TYPE::COMPUTE),
-	cs_nms("shaders/compute/nms.glsl", SHADER_TYPE::COMPUTE),
-	cs_double_thresholding("shaders/compute/double_thresholding.glsl", SHADER_TYPE::COMPUTE),
-	cs_hysteresis("shaders/compute/hysteresis.glsl", SHADER_TYPE::COMPUTE),
-	cs_dilate("shaders/compute/dilate.glsl", SHADER_TYPE::COMPUTE),
-	cs_outline("shaders/compute/outline.glsl", SHADER_TYPE::COMPUTE),
+	cs_toonEdges("shaders/compute/toon_edges.glsl", SHADER_TYPE::COMPUTE),
+	cs_toonOutline("shaders/compute/toon_outline.glsl", SHADER_TYPE::COMPUTE),
+	cs_bloomDownSample("shaders/compute/bloom_downsample.glsl", SHADER_TYPE::COMPUTE),
+	cs_bloomUpSample("shaders/compute/bloom_upsample.glsl", SHADER_TYPE::COMPUTE),
+	cs_skinning("shaders/compute/skinning.glsl", SHADER_TYPE::COMPUTE),
 	blinnPhong("shaders/blinn_phong/vertex.glsl", "shaders/blinn_phong/fragment.glsl", SHADER_TYPE::BLINN_PHONG),
 	pbr("shaders/PBR/vertex.glsl", "shaders/PBR/fragment.glsl", SHADER_TYPE::PBR),
 	toon("shaders/toon/vertex.glsl", "shaders/toon/fragment.glsl", SHADER_TYPE::TOON),
-	shadowMapping("shaders/shadowMapping/vertex.glsl", "shaders/shadowMapping/geometry.glsl", "shaders/shadowMapping/fragment.glsl", SHADER_TYPE::SHADOWS),
+	shadowMapping("shaders/shadowMapping/vertex.glsl", "shaders/shadowMapping/fragment.glsl", SHADER_TYPE::SHADOWS),
 	gBuffer("shaders/GBuffer/vertex.glsl", "shaders/GBuffer/fragment.glsl", SHADER_TYPE::GBUFFER),
 	ao("shaders/AO/vertex.glsl", "shaders/AO/fragment.glsl", SHADER_TYPE::AO),
 	aoBlur("shaders/AO/blur/vertex.glsl", "shaders/AO/blur/fragment.glsl", SHADER_TYPE::AO),
-	gaussianBlur("shaders/gaussianBlur/vertex.glsl", "shaders/gaussianBlur/fragment.glsl", SHADER_TYPE::BLUR),
-	tentBlur("shaders/tentBlur/vertex.glsl", "shaders/tentBlur/fragment.glsl", SHADER_TYPE::BLUR),
-	downSample("shaders/downSampling/vertex.glsl", "shaders/downSampling/fragment.glsl", SHADER_TYPE::SAMPLING),
-	upSample("shaders/upSampling/vertex.glsl", "shaders/upSampling/fragment.glsl", SHADER_TYPE::SAMPLING),
+	aoDownSample("shaders/AO/downSample/vertex.glsl", "shaders/AO/downSample/fragment.glsl", SHADER_TYPE::AO),
 	volumetricLighting("shaders/volumetrics/vertex.glsl", "shaders/volumetrics/fragment.glsl", SHADER_TYPE::VOLUMETRIC_LIGHTING),
 	VLDownSample("shaders/volumetrics/downSample/vertex.glsl", "shaders/volumetrics/downSample/fragment.glsl", SHADER_TYPE::SAMPLING),
+	VLTemporal("shaders/volumetrics/temporal/vertex.glsl", "shaders/volumetrics/temporal/fragment.glsl", SHADER_TYPE::SAMPLING),
+	VLUpSample("shaders/volumetrics/upSample/vertex.glsl", "shaders/volumetrics/upSample/fragment.glsl", SHADER_TYPE::SAMPLING),
 	bilateralBlur("shaders/bilateralBlur/vertex.glsl", "shaders/bilateralBlur/fragment.glsl", SHADER_TYPE::BLUR),
 	motionBlur("shaders/motionBlur/vertex.glsl", "shaders/motionBlur/fragment.glsl", SHADER_TYPE::BLUR),
-	sceneCompositing("shaders/compositing/scene/vertex.glsl", "shaders/compositing/scene/fragment.glsl", SHADER_TYPE::COMPOSITING),
-	uiCompositing("shaders/compositing/ui/vertex.glsl", "shaders/compositing/ui/fragment.glsl", SHADER_TYPE::COMPOSITING),
-	end("shaders/final/vertex.glsl", "shaders/final/fragment.glsl", SHADER_TYPE::FINAL)
+	oitCompositing("shaders/compositing/oit/vertex.glsl", "shaders/compositing/oit/fragment.glsl", SHADER_TYPE::COMPOSITING),
+	oitCompositingMS("shaders/compositing/oit/vertex.glsl", "shaders/compositing/oit/fragment.glsl", std::vector<std::string>{"MULTISAMPLE"}, SHADER_TYPE::COMPOSITING),
+	fxaa("shaders/antiAliasing/fxaa/vertex.glsl", "shaders/antiAliasing/fxaa/fragment.glsl", SHADER_TYPE::SAMPLING),
+	taa("shaders/antiAliasing/taa/vertex.glsl", "shaders/antiAliasing/taa/fragment.glsl", SHADER_TYPE::SAMPLING),
+	impostor("shaders/impostor/vertex.glsl", "shaders/impostor/fragment.glsl", SHADER_TYPE::IMPOSTOR),
+	impostorGBuffer("shaders/impostor/vertex.glsl", "shaders/impostor/fragment.glsl", std::vector<std::string>{"GBUFFER"}, SHADER_TYPE::IMPOSTOR),
+	deferredLighting("shaders/deferred/vertex.glsl", "shaders/deferred/fragment.glsl", SHADER_TYPE::COMPOSITING)
 {
-	// Multisample FBO
-	multisample->addAttachment(ATTACHMENT_TYPE::TEXTURE, ATTACHMENT_TARGET::COLOR, width, height);
-	multisample->addAttachment(ATTACHMENT_TYPE::TEXTURE, ATTACHMENT_TARGET::COLOR, width, height);
-	multisample->addAttachment(ATTACHMENT_TYPE::RENDER_BUFFER, ATTACHMENT_TARGET::DEPTH_STENCIL, width, height);
+	// Color FBO, multisampled for MSAA only
+	createColorFBO(width, height);
 
 	for(int i{0}; i < 2; ++i)
 		normal[i]->addAttachment(ATTACHMENT_TYPE::TEXTURE, ATTACHMENT_TARGET::COLOR, width, height);
 
-	for(int i{0}; i < 10; ++i)
-	{
-		omniDepth[i]->addAttachment(ATTACHMENT_TYPE::TEXTURE_CUBE_MAP, ATTACHMENT_TARGET::DEPTH, static_cast<int>(SHADOW_QUALITY::TINY), static_cast<int>(SHADOW_QUALITY::TINY));
-		stdDepth[i]->addAttachment(ATTACHMENT_TYPE::TEXTURE, ATTACHMENT_TARGET::DEPTH, static_cast<int>(SHADOW_QUALITY::TINY), static_cast<int>(SHADOW_QUALITY::TINY));
-	}
+	// SHADOW ATLAS (directional and spot lights), static casters cache
+	shadowAtlasFBO->addAttachment(ATTACHMENT_TYPE::TEXTURE, ATTACHMENT_TARGET::DEPTH, SHADOW_ATLAS_SIZE, SHADOW_ATLAS_SIZE);
+	shadowAtlasCacheFBO->addAttachment(ATTACHMENT_TYPE::TEXTURE, ATTACHMENT_TARGET::DEPTH, SHADOW_ATLAS_SIZE, SHADOW_ATLAS_SIZE);
+	updateOmniShadowArray(1, SHADOW_QUALITY::TINY);
 
 	// SSAO G-BUFFER FBO
-	GBuffer->addAttachment(ATTACHMENT_TYPE::TEXTURE, ATTACHMENT_TARGET::COLOR, width, height, GL_NEAREST);
-	GBuffer->addAttachment(ATTACHMENT_TYPE::TEXTURE, ATTACHMENT_TARGET::COLOR, width, height);
-	GBuffer->addAttachment(ATTACHMENT_TYPE::TEXTURE, ATTACHMENT_TARGET::COLOR, width, height);
-	GBuffer->addAttachment(ATTACHMENT_TYPE::TEXTURE, ATTACHMENT_TARGET::COLOR, width, height, GL_NEAREST);
-	GBuffer->addAttachment(ATTACHMENT_TYPE::RENDER_BUFFER, ATTACHMENT_TARGET::DEPTH, width, height);
-
-	// AMBIENT OCCLUSION
-	for(int i{0}; i < 2; ++i)
-		AOBuffer[i]->addAttachment(ATTACHMENT_TYPE::TEXTURE, ATTACHMENT_TARGET::COLOR, width, height);
-
-	std::uniform_real_distribution<float> randomFloats(0.0f, 1.0f);
-	std::default_random_engine generator;
-	for(int i{0}; i < ssaoSampleCount; ++i)
-	{
-		glm::vec3 sample(randomFloats(generator) * 2.0f - 1.0f, randomFloats(generator) * 2.0f - 1.0f, randomFloats(generator));
-		sample = glm::normalize(sample);
-		sample *= randomFloats(generator);
-
-		float scale = static_cast<float>(i) / static_cast<float>(ssaoSampleCount);
-		scale = lerp(0.1f, 1.0f, scale * scale);
-		sample *= scale;
-		aoKernel.push_back(sample);
-	}
-
-	std::vector<glm::vec3> aoNoise;
-	for(int i{0}; i < 16; ++i)
-	{
-		glm::vec3 noise(randomFloats(generator) * 2.0f - 1.0f, randomFloats(generator) * 2.0f - 1.0f, 0.0f);
-		aoNoise.push_back(noise);
-	}
-
-	glGenTextures(1, &aoNoiseTexture);
-	glBindTexture(GL_TEXTURE_2D, aoNoiseTexture);
-	glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA16F, 4, 4, 0, GL_RGB, GL_FLOAT, &aoNoise[0]);
-	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
-	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
-	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
-	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
-
-	// BLOOM FBOs and Textures
-	for(int i{1}; i <= 6; ++i)
-	{
-		int factor = std::pow(2, i);
-		int up = std::pow(2, 6-i);
-		int w = width / factor;
-		int h = height / factor;
-		downSampling[i-1]->addAttachment(
-				ATTACHMENT_TYPE::TEXTURE,
-				ATTACHMENT_TARGET::COLOR,
-				w, h);
-		ping_pong[(i-1)*2]->addAttachment(ATTACHMENT_TYPE::TEXTURE, ATTACHMENT_TARGET::COLOR, w, h);
-		ping_pong[(i-1)*2+1]->addAttachment(ATTACHMENT_TYPE::TEXTURE, ATTACHMENT_TARGET::COLOR, w, h);
-		upSampling[(i-1)*2]->addAttachment(ATTACHMENT_TYPE::TEXTURE, ATTACHMENT_TARGET::COLOR, width/up, height/up);
-		upSampling[(i-1)*2+1]->addAttachment(ATTACHMENT_TYPE::TEXTURE, ATTACHMENT_TARGET::COLOR, width/up, height/up);
-	}
-
-	for (int i{ 0 }; i < 2; ++i)
-	{
-		glGenTextures(1, &bloomTexture[i]);
-		glBindTexture(GL_TEXTURE_2D, bloomTexture[i]);
-		glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA16F, width, height, 0, GL_RGBA, GL_FLOAT, nullptr);
-		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
-		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
-		glBindTexture(GL_TEXTURE_2D, 0);
-	}
-
-	// VOLUMETRICS FBO
-    for(int i{0}; i < 4; ++i)
-    {
-        if(i < 3)
-	        volumetrics[i]->addAttachment(ATTACHMENT_TYPE::TEXTURE, ATTACHMENT_TARGET::COLOR, width/2, height/2);
-        else
-	        volumetrics[i]->addAttachment(ATTACHMENT_TYPE::TEXTURE, ATTACHMENT_TARGET::COLOR, width, height);
-    }
-
-    // MOTION BLUR FBO
-    motionBlurFBO->addAttachment(ATTACHMENT_TYPE::TEXTURE, ATTACHMENT_TARGET::COLOR, width, height);
-    
-	// UI FBO
-    userInterfaceFBO->addAttachment(ATTACHMENT_TYPE::TEXTURE, ATTACHMENT_TARGET::COLOR, width, height);
-    userInterfaceFBO->addAttachment(ATTACHMENT_TYPE::TEXTURE, ATTACHMENT_TARGET::COLOR, width, height);
-
-	// COMPOSITING
-	compositeFBO[0]->addAttachment(ATTACHMENT_TYPE::TEXTURE, ATTACHMENT_TARGET::COLOR, width, height);
-	compositeFBO[1]->addAttachment(ATTACHMENT_TYPE::TEXTURE, ATTACHMENT_TARGET::COLOR, width, height);
-	compositeFBO[1]->addAttachment(ATTACHMENT_TYPE::TEXTURE, ATTACHMENT_TARGET::COLOR, width, height);
-
-	// TOON RenderTextures
-	for (int i = 0; i < 2; ++i)
-	{
-		toonOutlineRT[i].set_wrap_method(GL_CLAMP_TO_EDGE);
-		toonOutlineRT[i].set_min_mag_filter(GL_LINEAR, GL_LINEAR);
-	}
+	GBuffer->addSizedColorTextureAttachment(GL_RG16, GL_RG, GL_UNSIGNED_SHORT, GL_NEAREST, width, height); // octahedral normal (view space)
+	GBuffer->addSizedColorTextureAttachment(GL_RGBA8, GL_RGBA, GL_UNSIGNED_BYTE, GL_NEAREST, width, height); // albedo
+	GBuffer->addSizedColorTextureAttachment(GL_RG8, GL_RG, GL_UNSIGNED_BYTE, GL_NEAREST, width, height); // metallic, roughness
+	GBuffer->addSizedColorTextureAttachment(GL_R11F_G11F_B10F, GL_RGB, GL_FLOAT, GL_NEAREST, width, height); // emission
+	GBuffer->addAttachment(ATTACHMENT_TYPE::TEXTURE, ATTACHMENT_TARGET::DEPTH, width, height); // positions are rebuilt from it
+
+	// AMBIENT OCCLUSION, targets are per frame in the render graph
+	// sample kernel, std140 vec4 array updated only when the sample count changes
+	glGenBuffers(1, &aoKernelUBO);
+	glBindBuffer(GL_UNIFORM_BUFFER, aoKernelUBO);
+	glBufferData(GL_UNIFORM_BUFFER, SSAO_MAX_KERNEL_SIZE * sizeof(glm::vec4), nullptr, GL_STATIC_DRAW);
+	glBindBuffer(GL_UNIFORM_BUFFER, 0);
+	generateAOKernel();
 
 	// quad mesh for rendering final image
 	glm::vec3 normal(0.0f, 0.0f, 1.0f);
@@ -257,6 +110,13 @@ Graphics::Graphics(int width, int height) :
 
 	quadMaterial.opacity = 1.0f;
 	quad = std::make_unique<Mesh>(vertices, indices, quadMaterial, "final image", glm::vec3(0.0f));
+	scaledQuad = std::make_unique<Mesh>(vertices, indices, quadMaterial, "scaled image", glm::vec3(0.0f));
+}
+
+Graphics::~Graphics()
+{
+	// framebuffers and meshes release their own objects
+	glDeleteBuffers(1, &aoKernelUBO);
 }
 
 void Graphics::setNearPlane(float nearPlane)
@@ -269,6 +129,16 @@ void Graphics::setFarPlane(float farPlane)
 	far = farPlane;
 }
 
+float Graphics::getNearPlane()
+{
+	return near;
+}
+
+float Graphics::getFarPlane()
+{
+	return far;
+}
+
 void Graphics::setShadows(bool s)
 {
 	shadows = s;
@@ -289,26 +159,6 @@ bool Graphics::bloomOn()
 	return bloomEffect;
 }
 
-float Graphics::getBloomSigma()
-{
-	return bloomSigma;
-}
-
-int Graphics::getBloomSize()
-{
-	return bloomSize;
-}
-
-void Graphics::setBloomSigma(float sigma)
-{
-	bloomSigma = sigma;
-}
-
-void Graphics::setBloomSize(int size)
-{
-	bloomSize = size;
-}
-
 void Graphics::setSSAOEffect(bool ao)
 {
 	ssaoEffect = ao;
@@ -326,9 +176,14 @@ int Graphics::getAOSampleCount()
 
 void Graphics::setAOSampleCount(int samples)
 {
-    if(samples > 128)
-        std::cerr << "Error : max sample set to 128 !" << std::endl;
-    ssaoSampleCount = std::min(128, samples);
+    if(samples > SSAO_MAX_KERNEL_SIZE)
+        std::cerr << "Error : max sample set to " << SSAO_MAX_KERNEL_SIZE << " !" << std::endl;
+    int count = std::min(SSAO_MAX_KERNEL_SIZE, samples);
+    if(count != ssaoSampleCount)
+    {
+        ssaoSampleCount = count;
+        generateAOKernel();
+    }
 }
 
 float Graphics::getAORadius()
@@ -351,6 +206,63 @@ bool Graphics::volumetricLightingOn()
 	return volumetricsOn;
 }
 
+void Graphics::setOIT(bool o)
+{
+	oitEffect = o;
+}
+
+bool Graphics::oitOn()
+{
+	return oitEffect;
+}
+
+void Graphics::setDeferred(bool d)
+{
+	deferredShading = d;
+}
+
+bool Graphics::deferredOn()
+{
+	// the G-buffer only carries the PBR material inputs
+	return deferredShading && m_colorShaderType == SHADER_TYPE::PBR;
+}
+
+void Graphics::setAntiAliasing(ANTI_ALIASING aa)
+{
+	if(aa == antiAliasing)
+		return;
+
+	// color targets switch between 4 samples and 1
+	bool multisampled = (antiAliasing == ANTI_ALIASING::MSAA);
+	antiAliasing = aa;
+	if(multisampled != (aa == ANTI_ALIASING::MSAA))
+		createColorFBO(screenWidth, screenHeight);
+}
+
+ANTI_ALIASING Graphics::getAntiAliasing()
+{
+	return antiAliasing;
+}
+
+glm::vec2 Graphics::getTAAJitter(int renderWidth, int renderHeight)
+{
+	// halton (2, 3) in [-0.5, 0.5] pixel, as a clip space offset of the rendered region
+	auto halton = [](int index, int base) {
+		float f{1.0f};
+		float r{0.0f};
+		while(index > 0)
+		{
+			f /= base;
+			r += f * (index % base);
+			index /= base;
+		}
+		return r;
+	};
+	int index = (taaFrame % TAA_JITTER_SAMPLES) + 1;
+	glm::vec2 offset(halton(index, 2) - 0.5f, halton(index, 3) - 0.5f);
+	return offset * 2.0f / glm::vec2(renderWidth, renderHeight);
+}
+
 void Graphics::set_scene_tone_mapping(TONE_MAPPING tone)
 {
 	scene_tone_mapping = tone;
@@ -371,20 +283,40 @@ TONE_MAPPING Graphics::get_ui_tone_mapping()
 	return ui_tone_mapping;
 }
 
-void Graphics::setStdShadowQuality(SHADOW_QUALITY quality, int index)
+void Graphics::updateShadowAtlas(const std::vector<int> & sizes)
 {
-	if(quality != SHADOW_QUALITY::OFF)
+	std::vector<glm::ivec3> previous(shadowAtlas.getCount());
+	for(int i{0}; i < static_cast<int>(previous.size()); ++i)
+		previous[i] = shadowAtlas.getRegion(i);
+
+	if(shadowAtlas.update(sizes))
 	{
-		stdDepth[index]->updateAttachment(ATTACHMENT_TYPE::TEXTURE, ATTACHMENT_TARGET::DEPTH, static_cast<int>(quality), static_cast<int>(quality));
+		// only the maps whose region moved are stale
+		stdCache.resize(sizes.size(), {false, 0, false});
+		for(int i{0}; i < static_cast<int>(sizes.size()); ++i)
+		{
+			if(i >= static_cast<int>(previous.size()) || shadowAtlas.getRegion(i) != previous[i])
+				stdCache[i] = {false, 0, false};
+		}
 	}
 }
 
-void Graphics::setOmniShadowQuality(SHADOW_QUALITY quality, int index)
+void Graphics::updateOmniShadowArray(int lightCount, SHADOW_QUALITY quality)
 {
-	if(quality != SHADOW_QUALITY::OFF)
-	{
-		omniDepth[index]->updateAttachment(ATTACHMENT_TYPE::TEXTURE_CUBE_MAP, ATTACHMENT_TARGET::DEPTH, static_cast<int>(quality), static_cast<int>(quality));
-	}
+	int resolution = static_cast<int>(quality);
+	if(quality == SHADOW_QUALITY::OFF || (resolution == omniShadowResolution && lightCount <= omniShadowCapacity))
+		return;
+
+	// cube map arrays share one resolution, storage only grows
+	omniShadowResolution = resolution;
+	while(omniShadowCapacity < lightCount)
+		omniShadowCapacity = (omniShadowCapacity == 0) ? 1 : omniShadowCapacity * 2;
+
+	omniShadowFBO = std::make_unique<Framebuffer>(false);
+	omniShadowCacheFBO = std::make_unique<Framebuffer>(false);
+	omniShadowFBO->addDepthTextureCubemapArrayAttachment(resolution, resolution, omniShadowCapacity);
+	omniShadowCacheFBO->addDepthTextureCubemapArrayAttachment(resolution, resolution, omniShadowCapacity);
+	omniCache.assign(omniShadowCapacity, {false, 0, false});
 }
 
 glm::mat4 Graphics::getOrthoProjection(float orthoDimension)
@@ -433,44 +365,82 @@ Shader & Graphics::getAOBlurShader()
 	return aoBlur;
 }
 
-Shader & Graphics::getGaussianBlurShader()
+Shader & Graphics::getAODownSamplingShader()
 {
-	return gaussianBlur;
+	return aoDownSample;
 }
 
-Shader & Graphics::getTentBlurShader()
+Shader & Graphics::getVolumetricLightingShader()
 {
-	return tentBlur;
+	return volumetricLighting;
 }
 
-Shader & Graphics::getDownSamplingShader()
+Shader & Graphics::getVolumetricDownSamplingShader()
 {
-	return downSample;
+	return VLDownSample;
 }
 
-Shader & Graphics::getUpSamplingShader()
+Shader & Graphics::getVolumetricTemporalShader()
 {
-	return upSample;
+	return VLTemporal;
 }
 
-Shader & Graphics::getVolumetricLightingShader()
+Shader & Graphics::getVolumetricUpSamplingShader()
 {
-	return volumetricLighting;
+	return VLUpSample;
 }
 
-Shader & Graphics::getVolumetricDownSamplingShader()
+Shader & Graphics::getBilateralBlurShader()
 {
-	return VLDownSample;
+	return bilateralBlur;
 }
 
-Shader & Graphics::getBilateralBlurShader()
+Shader & Graphics::getOITCompositingShader()
 {
-	return bilateralBlur;
+	return (antiAliasing == ANTI_ALIASING::MSAA) ? oitCompositingMS : oitCompositing;
 }
 
-Shader & Graphics::getFinalShader()
+Shader & Graphics::getFXAAShader()
 {
-	return end;
+	return fxaa;
+}
+
+Shader & Graphics::getTAAShader()
+{
+	return taa;
+}
+
+Shader & Graphics::getImpostorShader(bool gBuffer)
+{
+	return (gBuffer) ? impostorGBuffer : impostor;
+}
+
+Shader & Graphics::getDeferredLightingShader()
+{
+	return deferredLighting;
+}
+
+Shader & Graphics::getPostShader(int effects)
+{
+	std::unique_ptr<Shader> & variant = post[effects];
+	if(!variant)
+	{
+		std::vector<std::string> defines;
+		if(effects & POST_BLOOM)
+			defines.push_back("BLOOM");
+		if(effects & POST_VOLUMETRICS)
+			defines.push_back("VOLUMETRICS");
+		if(effects & POST_MOTION_BLUR)
+			defines.push_back("MOTION_BLUR");
+		if(effects & POST_SHARPEN)
+			defines.push_back("SHARPEN");
+		if(effects & POST_VIGNETTE)
+			defines.push_back("VIGNETTE");
+		if(effects & POST_COLOR_GRADING)
+			defines.push_back("COLOR_GRADING");
+		variant = std::make_unique<Shader>("shaders/post/vertex.glsl", "shaders/post/fragment.glsl", defines, SHADER_TYPE::FINAL);
+	}
+	return *variant;
 }
 
 std::unique_ptr<Framebuffer> & Graphics::getMultisampleFBO()
@@ -483,14 +453,49 @@ std::unique_ptr<Framebuffer> & Graphics::getNormalFBO(int index)
 	return normal[index];
 }
 
-std::unique_ptr<Framebuffer> & Graphics::getOmniDepthFBO(int index)
+std::unique_ptr<Framebuffer> & Graphics::getShadowAtlasFBO()
+{
+	return shadowAtlasFBO;
+}
+
+std::unique_ptr<Framebuffer> & Graphics::getShadowAtlasCacheFBO()
+{
+	return shadowAtlasCacheFBO;
+}
+
+std::unique_ptr<Framebuffer> & Graphics::getOmniShadowFBO()
+{
+	return omniShadowFBO;
+}
+
+std::unique_ptr<Framebuffer> & Graphics::getOmniShadowCacheFBO()
+{
+	return omniShadowCacheFBO;
+}
+
+ShadowAtlas & Graphics::getShadowAtlas()
+{
+	return shadowAtlas;
+}
+
+int Graphics::getOmniShadowResolution()
+{
+	return omniShadowResolution;
+}
+
+ShadowCache & Graphics::getOmniShadowCache(int index)
 {
-	return omniDepth[index];
+	return omniCache[index];
 }
 
-std::unique_ptr<Framebuffer> & Graphics::getStdDepthFBO(int index)
+ShadowCache & Graphics::getStdShadowCache(int index)
 {
-	return stdDepth[index];
+	return stdCache[index];
+}
+
+LightClusters & Graphics::getLightClusters()
+{
+	return lightClusters;
 }
 
 std::unique_ptr<Framebuffer> & Graphics::getGBufferFBO()
@@ -498,29 +503,44 @@ std::unique_ptr<Framebuffer> & Graphics::getGBufferFBO()
 	return GBuffer;
 }
 
-std::unique_ptr<Framebuffer> & Graphics::getAOFBO(int index)
+std::unique_ptr<Framebuffer> & Graphics::getVolumetricsHistoryFBO(int index)
 {
-	return AOBuffer[index];
+	// world position + depth, raymarch and result are per frame targets of the render graph
+	if(!volumetricsHistory[index])
+	{
+		volumetricsHistory[index] = std::make_unique<Framebuffer>(true, false, true);
+		volumetricsHistory[index]->addAttachment(ATTACHMENT_TYPE::TEXTURE, ATTACHMENT_TARGET::COLOR, screenWidth / 2, screenHeight / 2);
+		volumetricsFrame = 0;
+	}
+	return volumetricsHistory[index];
 }
 
-std::unique_ptr<Framebuffer> & Graphics::getDownSamplingFBO(int index)
+void Graphics::releaseVolumetricsHistory()
 {
-	return downSampling[index];
+	volumetricsHistory[0].reset();
+	volumetricsHistory[1].reset();
 }
 
-std::unique_ptr<Framebuffer> & Graphics::getPingPongFBO(int index)
+std::unique_ptr<Framebuffer> & Graphics::getTAAHistoryFBO(int index)
 {
-	return ping_pong[index];
+	if(!taaHistory[index])
+	{
+		taaHistory[index] = std::make_unique<Framebuffer>(true, false, true);
+		taaHistory[index]->addAttachment(ATTACHMENT_TYPE::TEXTURE, ATTACHMENT_TARGET::COLOR, screenWidth, screenHeight);
+		taaFrame = 0;
+	}
+	return taaHistory[index];
 }
 
-std::unique_ptr<Framebuffer> & Graphics::getUpSamplingFBO(int index)
+void Graphics::releaseTAAHistory()
 {
-	return upSampling[index];
+	taaHistory[0].reset();
+	taaHistory[1].reset();
 }
 
-std::unique_ptr<Framebuffer> & Graphics::getVolumetricsFBO(int index)
+RenderGraph & Graphics::getRenderGraph()
 {
-	return volumetrics[index];
+	return renderGraph;
 }
 
 std::unique_ptr<Mesh> & Graphics::getQuadMesh()
@@ -528,147 +548,123 @@ std::unique_ptr<Mesh> & Graphics::getQuadMesh()
 	return quad;
 }
 
+std::unique_ptr<Mesh> & Graphics::getScaledQuadMesh()
+{
+	return scaledQuad;
+}
+
+DynamicResolution & Graphics::getDynamicResolution()
+{
+	return dynamicResolution;
+}
+
+void Graphics::setRenderScale(glm::vec2 scale)
+{
+	if(scale == renderScale)
+		return;
+
+	// rebuilt only when the scale changes, the controller moves in steps
+	renderScale = scale;
+	glm::vec3 normal(0.0f, 0.0f, 1.0f);
+	std::vector<Vertex> vertices{{
+		Vertex(glm::vec3(-1.0f, -1.0f, 0.0f), normal, glm::vec2(0.0f, 0.0f)),
+		Vertex(glm::vec3(1.0f, -1.0f, 0.0f), normal, glm::vec2(scale.x, 0.0f)),
+		Vertex(glm::vec3(1.0f, 1.0f, 0.0f), normal, glm::vec2(scale.x, scale.y)),
+		Vertex(glm::vec3(-1.0f, 1.0f, 0.0f), normal, glm::vec2(0.0f, scale.y))
+	}};
+
+	std::vector<int> indices{{
+		0, 1, 2,
+		0, 2, 3
+	}};
+
+	scaledQuad = std::make_unique<Mesh>(vertices, indices, quadMaterial, "scaled image", glm::vec3(0.0f));
+}
+
+glm::vec2 Graphics::getRenderScale()
+{
+	return renderScale;
+}
+
+void Graphics::setUpscaleSharpness(float sharpness)
+{
+	upscaleSharpness = sharpness;
+}
+
+float Graphics::getUpscaleSharpness()
+{
+	return upscaleSharpness;
+}
+
+void Graphics::setExposure(float e)
+{
+	exposure = e;
+}
+
+float Graphics::getExposure()
+{
+	return exposure;
+}
+
+void Graphics::setVignette(bool v)
+{
+	vignette = v;
+}
+
+bool Graphics::vignetteOn()
+{
+	return vignette;
+}
+
+void Graphics::setColorGrading(bool c, float aSaturation, float aContrast, glm::vec3 aColorFilter)
+{
+	colorGrading = c;
+	saturation = aSaturation;
+	contrast = aContrast;
+	colorFilter = aColorFilter;
+}
+
+bool Graphics::colorGradingOn()
+{
+	return colorGrading;
+}
+
 void Graphics::resizeScreen(int width, int height)
 {
-	multisample = std::make_unique<Framebuffer>(true, true, true);
+	volumetricsFrame = 0;
 	normal = std::array<std::unique_ptr<Framebuffer>, 2>{
 		std::make_unique<Framebuffer>(true, false, true),
 		std::make_unique<Framebuffer>(true, false, true)
 	};
 	GBuffer = std::make_unique<Framebuffer>(true, false, true);
-	AOBuffer = std::array<std::unique_ptr<Framebuffer>, 2>{
-		std::make_unique<Framebuffer>(true, false, true),
-		std::make_unique<Framebuffer>(true, false, true)
-	};
-	downSampling = std::array<std::unique_ptr<Framebuffer>, 6>{
-		std::make_unique<Framebuffer>(true, false, true),
-		std::make_unique<Framebuffer>(true, false, true),
-		std::make_unique<Framebuffer>(true, false, true),
-		std::make_unique<Framebuffer>(true, false, true),
-		std::make_unique<Framebuffer>(true, false, true),
-		std::make_unique<Framebuffer>(true, false, true)
-	};
-	ping_pong = std::array<std::unique_ptr<Framebuffer>, 12>{
-		std::make_unique<Framebuffer>(true, false, true),
-		std::make_unique<Framebuffer>(true, false, true),
-		std::make_unique<Framebuffer>(true, false, true),
-		std::make_unique<Framebuffer>(true, false, true),
-		std::make_unique<Framebuffer>(true, false, true),
-		std::make_unique<Framebuffer>(true, false, true),
-		std::make_unique<Framebuffer>(true, false, true),
-		std::make_unique<Framebuffer>(true, false, true),
-		std::make_unique<Framebuffer>(true, false, true),
-		std::make_unique<Framebuffer>(true, false, true),
-		std::make_unique<Framebuffer>(true, false, true),
-		std::make_unique<Framebuffer>(true, false, true)
-	};
-	upSampling = std::array<std::unique_ptr<Framebuffer>, 12>{
-		std::make_unique<Framebuffer>(true, false, true),
-		std::make_unique<Framebuffer>(true, false, true),
-		std::make_unique<Framebuffer>(true, false, true),
-		std::make_unique<Framebuffer>(true, false, true),
-		std::make_unique<Framebuffer>(true, false, true),
-		std::make_unique<Framebuffer>(true, false, true),
-		std::make_unique<Framebuffer>(true, false, true),
-		std::make_unique<Framebuffer>(true, false, true),
-		std::make_unique<Framebuffer>(true, false, true),
-		std::make_unique<Framebuffer>(true, false, true),
-		std::make_unique<Framebuffer>(true, false, true),
-		std::make_unique<Framebuffer>(true, false, true)
-	};
-	volumetrics = std::array<std::unique_ptr<Framebuffer>, 4>{
-        std::make_unique<Framebuffer>(true, false, true),
-        std::make_unique<Framebuffer>(true, false, true),
-        std::make_unique<Framebuffer>(true, false, true),
-        std::make_unique<Framebuffer>(true, false, true)
-    };
-    motionBlurFBO = std::make_unique<Framebuffer>(true, false, true);
-    userInterfaceFBO = std::make_unique<Framebuffer>(true, false, true);
-	compositeFBO = std::array<std::unique_ptr<Framebuffer>, 2>{
-		std::make_unique<Framebuffer>(true, false, true),
-		std::make_unique<Framebuffer>(true, false, true)
-	};
-
-	toonOutlineRT = {
-		RenderTexture(width, height, 1, GL_RGBA16F, GL_RGBA, GL_FLOAT),
-		RenderTexture(width, height, 1, GL_RGBA16F, GL_RGBA, GL_FLOAT)
-	};
+	volumetricsHistory = std::array<std::unique_ptr<Framebuffer>, 2>{};
+	taaHistory = std::array<std::unique_ptr<Framebuffer>, 2>{};
+	taaFrame = 0;
+	renderGraph.releasePool();
+	screenWidth = width;
+	screenHeight = height;
 
-	multisample->addAttachment(ATTACHMENT_TYPE::TEXTURE, ATTACHMENT_TARGET::COLOR, width, height);
-	multisample->addAttachment(ATTACHMENT_TYPE::TEXTURE, ATTACHMENT_TARGET::COLOR, width, height);
-	multisample->addAttachment(ATTACHMENT_TYPE::RENDER_BUFFER, ATTACHMENT_TARGET::DEPTH_STENCIL, width, height);
+	createColorFBO(width, height);
 
 	for(int i{0}; i < 2; ++i)
 		normal[i]->addAttachment(ATTACHMENT_TYPE::TEXTURE, ATTACHMENT_TARGET::COLOR, width, height);
 
 	// SSAO G-BUFFER FBO
-	GBuffer->addAttachment(ATTACHMENT_TYPE::TEXTURE, ATTACHMENT_TARGET::COLOR, width, height, GL_NEAREST);
-	GBuffer->addAttachment(ATTACHMENT_TYPE::TEXTURE, ATTACHMENT_TARGET::COLOR, width, height);
-	GBuffer->addAttachment(ATTACHMENT_TYPE::TEXTURE, ATTACHMENT_TARGET::COLOR, width, height);
-	GBuffer->addAttachment(ATTACHMENT_TYPE::TEXTURE, ATTACHMENT_TARGET::COLOR, width, height);
-	GBuffer->addAttachment(ATTACHMENT_TYPE::RENDER_BUFFER, ATTACHMENT_TARGET::DEPTH, width, height);
-
-	// AMBIENT OCCLUSION BUFFER
-	for(int i{0}; i < 2; ++i)
-		AOBuffer[i]->addAttachment(ATTACHMENT_TYPE::TEXTURE, ATTACHMENT_TARGET::COLOR, width, height);
-
-	// bloom ping pong FBOs and textures
-	for(int i{1}; i <= 6; ++i)
-	{
-		int factor = std::pow(2, i);
-		int up = std::pow(2, 6-i);
-		int w = width / factor;
-		int h = height / factor;
-		downSampling[i-1]->addAttachment(
-				ATTACHMENT_TYPE::TEXTURE,
-				ATTACHMENT_TARGET::COLOR,
-				w, h);
-		ping_pong[(i-1)*2]->addAttachment(ATTACHMENT_TYPE::TEXTURE, ATTACHMENT_TARGET::COLOR, w, h);
-		ping_pong[(i-1)*2+1]->addAttachment(ATTACHMENT_TYPE::TEXTURE, ATTACHMENT_TARGET::COLOR, w, h);
-		upSampling[(i-1)*2]->addAttachment(ATTACHMENT_TYPE::TEXTURE, ATTACHMENT_TARGET::COLOR, width/up, height/up);
-		upSampling[(i-1)*2+1]->addAttachment(ATTACHMENT_TYPE::TEXTURE, ATTACHMENT_TARGET::COLOR, width/up, height/up);
-	}
-
-	for (int i{ 0 }; i < 2; ++i)
-	{
-		glDeleteTextures(1, &bloomTexture[i]);
-		glGenTextures(1, &bloomTexture[i]);
-		glBindTexture(GL_TEXTURE_2D, bloomTexture[i]);
-		glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA16F, width, height, 0, GL_RGBA, GL_FLOAT, nullptr);
-		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
-		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
-		glBindTexture(GL_TEXTURE_2D, 0);
-	}
-
-	// VOLUMETRICS FBO
-    for(int i{0}; i < 4; ++i)
-    {
-        if(i < 3)
-	        volumetrics[i]->addAttachment(ATTACHMENT_TYPE::TEXTURE, ATTACHMENT_TARGET::COLOR, width/2, height/2);
-        else
-	        volumetrics[i]->addAttachment(ATTACHMENT_TYPE::TEXTURE, ATTACHMENT_TARGET::COLOR, width, height);
-    }
-
-    // MOTION BLUR FBO
-    motionBlurFBO->addAttachment(ATTACHMENT_TYPE::TEXTURE, ATTACHMENT_TARGET::COLOR, width, height);
-
-    // UI FBO
-    userInterfaceFBO->addAttachment(ATTACHMENT_TYPE::TEXTURE, ATTACHMENT_TARGET::COLOR, width, height);
-    userInterfaceFBO->addAttachment(ATTACHMENT_TYPE::TEXTURE, ATTACHMENT_TARGET::COLOR, width, height);
-
-	// COMPOSITING
-	compositeFBO[0]->addAttachment(ATTACHMENT_TYPE::TEXTURE, ATTACHMENT_TARGET::COLOR, width, height);
-	compositeFBO[1]->addAttachment(ATTACHMENT_TYPE::TEXTURE, ATTACHMENT_TARGET::COLOR, width, height);
-	compositeFBO[1]->addAttachment(ATTACHMENT_TYPE::TEXTURE, ATTACHMENT_TARGET::COLOR, width, height);
+	GBuffer->addSizedColorTextureAttachment(GL_RG16, GL_RG, GL_UNSIGNED_SHORT, GL_NEAREST, width, height); // octahedral normal (view space)
+	GBuffer->addSizedColorTextureAttachment(GL_RGBA8, GL_RGBA, GL_UNSIGNED_BYTE, GL_NEAREST, width, height); // albedo
+	GBuffer->addSizedColorTextureAttachment(GL_RG8, GL_RG, GL_UNSIGNED_BYTE, GL_NEAREST, width, height); // metallic, roughness
+	GBuffer->addSizedColorTextureAttachment(GL_R11F_G11F_B10F, GL_RGB, GL_FLOAT, GL_NEAREST, width, height); // emission
+	GBuffer->addAttachment(ATTACHMENT_TYPE::TEXTURE, ATTACHMENT_TARGET::DEPTH, width, height); // positions are rebuilt from it
+}
 
-	// TOON RenderTextures
-	for (int i = 0; i < 2; ++i)
-	{
-		toonOutlineRT[i].set_wrap_method(GL_CLAMP_TO_EDGE);
-		toonOutlineRT[i].set_min_mag_filter(GL_LINEAR, GL_LINEAR);
-	}
+void Graphics::createColorFBO(int width, int height)
+{
+	multisample = std::make_unique<Framebuffer>(true, antiAliasing == ANTI_ALIASING::MSAA, true);
+	multisample->addAttachment(ATTACHMENT_TYPE::TEXTURE, ATTACHMENT_TARGET::COLOR, width, height);
+	multisample->addAttachment(ATTACHMENT_TYPE::TEXTURE, ATTACHMENT_TARGET::COLOR, width, height);
+	multisample->addAttachment(ATTACHMENT_TYPE::TEXTURE, ATTACHMENT_TARGET::COLOR, width, height); // OIT accumulation
+	multisample->addAttachment(ATTACHMENT_TYPE::TEXTURE, ATTACHMENT_TARGET::COLOR, width, height); // OIT revealage
+	multisample->addAttachment(ATTACHMENT_TYPE::RENDER_BUFFER, ATTACHMENT_TARGET::DEPTH_STENCIL, width, height);
 }
 
 std::vector<glm::vec3> & Graphics::getAOKernel()
@@ -676,12 +672,32 @@ std::vector<glm::vec3> & Graphics::getAOKernel()
 	return aoKernel;
 }
 
-GLuint Graphics::getAONoiseTexture()
+void Graphics::generateAOKernel()
 {
-	return aoNoiseTexture;
+	// hemisphere samples, denser close to the fragment
+	std::uniform_real_distribution<float> randomFloats(0.0f, 1.0f);
+	std::default_random_engine generator;
+	std::vector<glm::vec4> kernel;
+	aoKernel.clear();
+	for(int i{0}; i < ssaoSampleCount; ++i)
+	{
+		glm::vec3 sample(randomFloats(generator) * 2.0f - 1.0f, randomFloats(generator) * 2.0f - 1.0f, randomFloats(generator));
+		sample = glm::normalize(sample);
+		sample *= randomFloats(generator);
+
+		float scale = static_cast<float>(i) / static_cast<float>(ssaoSampleCount);
+		scale = lerp(0.1f, 1.0f, scale * scale);
+		sample *= scale;
+		aoKernel.push_back(sample);
+		kernel.emplace_back(sample, 0.0f);
+	}
+
+	glBindBuffer(GL_UNIFORM_BUFFER, aoKernelUBO);
+	glBufferSubData(GL_UNIFORM_BUFFER, 0, kernel.size() * sizeof(glm::vec4), kernel.data());
+	glBindBuffer(GL_UNIFORM_BUFFER, 0);
 }
 
-GLuint Graphics::getBloomTexture(int index)
+GLuint Graphics::getAOKernelBuffer()
 {
-	return bloomTexture[index];
+	return aoKernelUBO;
 }
@@ -4,3 +4,12 @@ float lerp(float a, float b, float k)
 {
 	return a + k * (b - a);
 }
+
+void hashCombine(std::size_t & seed, const glm::mat4 & m)
+{
+	for(int i{0}; i < 4; ++i)
+	{
+		for(int j{0}; j < 4; ++j)
+			hashCombine(seed, m[i][j]);
+	}
+}
@@ -0,0 +1,187 @@
+#include "impostor.hpp"
+
+Impostor::Impostor(Object & object, Shader & bakeShader, int aViews, int aResolution) :
+	views(std::max(2, aViews)),
+	resolution(aResolution),
+	vao(0),
+	vbo(0),
+	instanceOffset(-1),
+	instanceFrame(0)
+{
+	atlas.fill(0);
+
+	struct AABB aabb = object.getAABB();
+	glm::vec3 aabbMin(aabb.xMin, aabb.yMin, aabb.zMin);
+	glm::vec3 aabbMax(aabb.xMax, aabb.yMax, aabb.zMax);
+	center = (aabbMin + aabbMax) * 0.5f;
+	radius = std::max(glm::length(aabbMax - center), 1e-3f);
+
+	bake(object, bakeShader);
+
+	// quad corners, the instance attributes point into the ring buffer at draw time
+	float corners[] = {-1.0f, -1.0f, 1.0f, -1.0f, -1.0f, 1.0f, 1.0f, 1.0f};
+	glGenVertexArrays(1, &vao);
+	glBindVertexArray(vao);
+	glGenBuffers(1, &vbo);
+	glBindBuffer(GL_ARRAY_BUFFER, vbo);
+	glBufferData(GL_ARRAY_BUFFER, sizeof(corners), corners, GL_STATIC_DRAW);
+	glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, 2 * sizeof(float), (void*)0);
+	glEnableVertexAttribArray(0);
+	for(int i{1}; i < 6; ++i)
+	{
+		glEnableVertexAttribArray(i);
+		glVertexAttribDivisor(i, 1);
+	}
+	glBindVertexArray(0);
+	glBindBuffer(GL_ARRAY_BUFFER, 0);
+}
+
+Impostor::~Impostor()
+{
+	glDeleteTextures(atlas.size(), atlas.data());
+	glDeleteBuffers(1, &vbo);
+	glDeleteVertexArrays(1, &vao);
+}
+
+glm::vec3 Impostor::viewDirection(glm::vec2 uv)
+{
+	// octahedral grid cell to direction, y up
+	glm::vec2 f = uv * 2.0f - 1.0f;
+	glm::vec3 n(f.x, f.y, 1.0f - std::abs(f.x) - std::abs(f.y));
+	if(n.z < 0.0f)
+	{
+		float x = n.x;
+		n.x = (1.0f - std::abs(n.y)) * ((x >= 0.0f) ? 1.0f : -1.0f);
+		n.y = (1.0f - std::abs(x)) * ((n.y >= 0.0f) ? 1.0f : -1.0f);
+	}
+	return glm::normalize(glm::vec3(n.x, n.z, n.y));
+}
+
+void Impostor::bake(Object & object, Shader & bakeShader)
+{
+	GLint previousFbo{0};
+	GLint previousViewport[4];
+	glGetIntegerv(GL_DRAW_FRAMEBUFFER_BINDING, &previousFbo);
+	glGetIntegerv(GL_VIEWPORT, previousViewport);
+	GLboolean blend = glIsEnabled(GL_BLEND);
+
+	// G-buffer layout : octahedral normal, linear albedo, metallic roughness
+	int size = views * resolution;
+	GLenum internalFormats[] = {GL_RGBA16F, GL_RG16F, GL_RG8, GL_DEPTH_COMPONENT32F};
+	GLenum formats[] = {GL_RGBA, GL_RG, GL_RG, GL_DEPTH_COMPONENT};
+	glGenTextures(atlas.size(), atlas.data());
+	for(int i{0}; i < atlas.size(); ++i)
+	{
+		glBindTexture(GL_TEXTURE_2D, atlas[i]);
+		glTexImage2D(GL_TEXTURE_2D, 0, internalFormats[i], size, size, 0, formats[i], GL_FLOAT, nullptr);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+	}
+	glBindTexture(GL_TEXTURE_2D, 0);
+
+	GLuint fbo;
+	glGenFramebuffers(1, &fbo);
+	glBindFramebuffer(GL_FRAMEBUFFER, fbo);
+	glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, atlas[1], 0);
+	glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT1, GL_TEXTURE_2D, atlas[0], 0);
+	glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT2, GL_TEXTURE_2D, atlas[2], 0);
+	glFramebufferTexture2D(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_TEXTURE_2D, atlas[3], 0);
+	GLenum buffers[] = {GL_COLOR_ATTACHMENT0, GL_COLOR_ATTACHMENT1, GL_COLOR_ATTACHMENT2};
+	glDrawBuffers(3, buffers);
+	if(glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE)
+		std::cerr << "Error: impostor atlas framebuffer is not complete !" << std::endl;
+
+	// uncovered texels keep a zero albedo alpha
+	glClearColor(0.0f, 0.0f, 0.0f, 0.0f);
+	glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+	glEnable(GL_DEPTH_TEST);
+	glDisable(GL_BLEND);
+
+	bakeShader.use();
+	bakeShader.setInt("deferred", 1);
+	bakeShader.setMatrix("model", glm::mat4(1.0f));
+	bakeShader.setMatrix("proj", glm::ortho(-radius, radius, -radius, radius, radius, 3.0f * radius));
+	for(int y{0}; y < views; ++y)
+	{
+		for(int x{0}; x < views; ++x)
+		{
+			// orthographic view of the bounding sphere, depth spans it front to back
+			glm::vec3 dir = viewDirection((glm::vec2(x, y) + 0.5f) / static_cast<float>(views));
+			glm::vec3 up = (std::abs(dir.y) > 0.999f) ? glm::vec3(0.0f, 0.0f, 1.0f) : glm::vec3(0.0f, 1.0f, 0.0f);
+			bakeShader.setMatrix("view", glm::lookAt(center + dir * 2.0f * radius, center, up));
+			glViewport(x * resolution, y * resolution, resolution, resolution);
+
+			for(auto & mesh : object.getMeshes())
+			{
+				if(mesh->getMaterial().opaque == 1)
+					mesh->draw(bakeShader);
+			}
+		}
+	}
+
+	glBindFramebuffer(GL_FRAMEBUFFER, previousFbo);
+	glDeleteFramebuffers(1, &fbo);
+	glViewport(previousViewport[0], previousViewport[1], previousViewport[2], previousViewport[3]);
+	if(blend)
+		glEnable(GL_BLEND);
+}
+
+void Impostor::clear()
+{
+	instances.clear();
+}
+
+void Impostor::add(const glm::mat4 & model, float fade)
+{
+	instances.push_back({model, fade});
+}
+
+void Impostor::draw(Shader & shader)
+{
+	if(instances.empty())
+		return;
+
+	// written once per frame into the shared ring buffer, every pass draws the same range
+	RingBuffer & ring = RingBuffer::get();
+	if(instanceFrame != ring.getFrame())
+	{
+		instanceOffset = ring.push(instances.data(), instances.size() * sizeof(ImpostorInstance), sizeof(glm::vec4));
+		instanceFrame = ring.getFrame();
+	}
+	if(instanceOffset < 0)
+		return;
+
+	glBindVertexArray(vao);
+	glBindBuffer(GL_ARRAY_BUFFER, ring.getId());
+	for(int i{0}; i < 4; ++i)
+		glVertexAttribPointer(1 + i, 4, GL_FLOAT, GL_FALSE, sizeof(ImpostorInstance), (void*)(instanceOffset + i * sizeof(glm::vec4)));
+	glVertexAttribPointer(5, 1, GL_FLOAT, GL_FALSE, sizeof(ImpostorInstance), (void*)(instanceOffset + offsetof(ImpostorInstance, fade)));
+	glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+	shader.use();
+	shader.setVec3f("center", center);
+	shader.setFloat("radius", radius);
+	shader.setInt("views", views);
+	const char * samplers[] = {"albedoAtlas", "normalAtlas", "metallicRoughAtlas", "depthAtlas"};
+	for(int i{0}; i < atlas.size(); ++i)
+	{
+		shader.setInt(samplers[i], i);
+		glActiveTexture(GL_TEXTURE0 + i);
+		glBindTexture(GL_TEXTURE_2D, atlas[i]);
+	}
+
+	glDrawArraysInstanced(GL_TRIANGLE_STRIP, 0, 4, instances.size());
+	glBindVertexArray(0);
+}
+
+glm::vec3 Impostor::getCenter()
+{
+	return center;
+}
+
+float Impostor::getRadius()
+{
+	return radius;
+}
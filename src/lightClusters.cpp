@@ -0,0 +1,168 @@
+#include "lightClusters.hpp"
+
+LightClusters::LightClusters() :
+	grid(CLUSTER_X * CLUSTER_Y * CLUSTER_Z),
+	view(1.0f),
+	proj(1.0f),
+	near(0.1f),
+	far(100.0f),
+	offsets{-1, -1, -1},
+	sizes{0, 0, 0},
+	alignment(256)
+{
+	glGetIntegerv(GL_SHADER_STORAGE_BUFFER_OFFSET_ALIGNMENT, &alignment);
+}
+
+void LightClusters::update(const std::vector<GPULight> & aLights, const glm::mat4 & aView, const glm::mat4 & aProj, float aNear, float aFar)
+{
+	lights = aLights;
+	view = aView;
+	proj = aProj;
+	near = aNear;
+	far = aFar;
+
+	// count lights per cluster
+	std::fill(grid.begin(), grid.end(), glm::uvec2(0));
+	std::vector<std::pair<glm::ivec3, glm::ivec3>> ranges(lights.size());
+	std::vector<char> visible(lights.size(), 0);
+	for(int l{0}; l < lights.size(); ++l)
+	{
+		visible[l] = clusterRange(lights[l], ranges[l].first, ranges[l].second);
+		if(!visible[l])
+			continue;
+		for(int z{ranges[l].first.z}; z <= ranges[l].second.z; ++z)
+			for(int y{ranges[l].first.y}; y <= ranges[l].second.y; ++y)
+				for(int x{ranges[l].first.x}; x <= ranges[l].second.x; ++x)
+					grid[(z * CLUSTER_Y + y) * CLUSTER_X + x].y++;
+	}
+
+	// prefix sum, then fill the index list
+	GLuint total{0};
+	for(glm::uvec2 & cell : grid)
+	{
+		cell.x = total;
+		total += cell.y;
+		cell.y = 0;
+	}
+	indices.resize(std::max(total, 1u));
+	for(int l{0}; l < lights.size(); ++l)
+	{
+		if(!visible[l])
+			continue;
+		for(int z{ranges[l].first.z}; z <= ranges[l].second.z; ++z)
+			for(int y{ranges[l].first.y}; y <= ranges[l].second.y; ++y)
+				for(int x{ranges[l].first.x}; x <= ranges[l].second.x; ++x)
+				{
+					glm::uvec2 & cell = grid[(z * CLUSTER_Y + y) * CLUSTER_X + x];
+					indices[cell.x + cell.y++] = l;
+				}
+	}
+
+	// stream the three storage buffers, empty ranges can't be bound
+	RingBuffer & ring = RingBuffer::get();
+	if(lights.empty())
+		lights.emplace_back();
+	sizes[0] = lights.size() * sizeof(GPULight);
+	sizes[1] = grid.size() * sizeof(glm::uvec2);
+	sizes[2] = indices.size() * sizeof(GLuint);
+	offsets[0] = ring.push(lights.data(), sizes[0], alignment);
+	offsets[1] = ring.push(grid.data(), sizes[1], alignment);
+	offsets[2] = ring.push(indices.data(), sizes[2], alignment);
+}
+
+void LightClusters::bind(Shader & s)
+{
+	if(offsets[0] < 0 || offsets[1] < 0 || offsets[2] < 0)
+		return;
+
+	GLuint buffer = RingBuffer::get().getId();
+	for(int i{0}; i < 3; ++i)
+		glBindBufferRange(GL_SHADER_STORAGE_BUFFER, i, buffer, offsets[i], sizes[i]);
+
+	s.setVec3i("clusterGrid", glm::ivec3(CLUSTER_X, CLUSTER_Y, CLUSTER_Z));
+	s.setVec2f("clusterDepth", glm::vec2(near, far));
+}
+
+int LightClusters::getLightCount()
+{
+	return lights.size();
+}
+
+int LightClusters::getIndexCount()
+{
+	return indices.size();
+}
+
+bool LightClusters::clusterRange(const GPULight & light, glm::ivec3 & first, glm::ivec3 & last)
+{
+	first = glm::ivec3(0);
+	last = glm::ivec3(CLUSTER_X - 1, CLUSTER_Y - 1, CLUSTER_Z - 1);
+
+	// directional lights reach every cluster
+	if(light.type == 1)
+		return true;
+
+	// bounding sphere of the light range, tightened around the cone for spots
+	// narrower than a half sphere (outerCutOff holds the cosine of the half angle)
+	glm::vec3 center = light.position;
+	float radius = light.range;
+	if(light.type == 2 && light.outerCutOff > 0.0f)
+	{
+		float cosAngle = light.outerCutOff;
+		glm::vec3 axis = glm::normalize(light.direction);
+		if(cosAngle >= 0.70710678f)
+		{
+			// sphere through the apex and the rim of the cap
+			radius = light.range / (2.0f * cosAngle);
+			center += axis * radius;
+		}
+		else
+		{
+			// sphere around the rim of the cap, the apex lies inside
+			center += axis * light.range * cosAngle;
+			radius = light.range * std::sqrt(1.0f - cosAngle * cosAngle);
+		}
+	}
+
+	glm::vec3 c = glm::vec3(view * glm::vec4(center, 1.0f));
+	float zMin = -c.z - radius;
+	float zMax = -c.z + radius;
+	if(zMax < near || zMin > far)
+		return false;
+	first.z = slice(std::max(zMin, near));
+	last.z = slice(std::min(zMax, far));
+
+	// crossing the near plane : whole screen
+	if(zMin <= near)
+		return true;
+
+	// screen rectangle of the view space box around the sphere
+	glm::vec2 ndcMin(std::numeric_limits<float>::max());
+	glm::vec2 ndcMax(std::numeric_limits<float>::lowest());
+	for(int i{0}; i < 8; ++i)
+	{
+		glm::vec3 corner = c + radius * glm::vec3(
+				(i & 1) ? 1.0f : -1.0f,
+				(i & 2) ? 1.0f : -1.0f,
+				(i & 4) ? 1.0f : -1.0f);
+		glm::vec4 clip = proj * glm::vec4(corner, 1.0f);
+		glm::vec2 ndc = glm::vec2(clip) / clip.w;
+		ndcMin = glm::min(ndcMin, ndc);
+		ndcMax = glm::max(ndcMax, ndc);
+	}
+	if(ndcMax.x < -1.0f || ndcMax.y < -1.0f || ndcMin.x > 1.0f || ndcMin.y > 1.0f)
+		return false;
+
+	first.x = glm::clamp(static_cast<int>((ndcMin.x * 0.5f + 0.5f) * CLUSTER_X), 0, CLUSTER_X - 1);
+	first.y = glm::clamp(static_cast<int>((ndcMin.y * 0.5f + 0.5f) * CLUSTER_Y), 0, CLUSTER_Y - 1);
+	last.x = glm::clamp(static_cast<int>((ndcMax.x * 0.5f + 0.5f) * CLUSTER_X), 0, CLUSTER_X - 1);
+	last.y = glm::clamp(static_cast<int>((ndcMax.y * 0.5f + 0.5f) * CLUSTER_Y), 0, CLUSTER_Y - 1);
+	return true;
+}
+
+int LightClusters::slice(float depth)
+{
+	// same exponential split as clusterIndex() in the lighting shaders
+	int s = static_cast<int>(std::log(depth / near) / std::log(far / near) * CLUSTER_Z);
+	return glm::clamp(s, 0, CLUSTER_Z - 1);
+}
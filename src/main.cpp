@@ -12,6 +12,7 @@
 #include "framebuffer.hpp"
 #include "editorUI.hpp"
 #include "allocation.hpp"
+#include "ringBuffer.hpp"
 
 void characterMovements(std::unique_ptr<WindowManager> & client, std::unique_ptr<Game> & game, float delta)
 {
@@ -161,6 +162,34 @@ void editorUI(EDITOR_UI_SETTINGS & settings, std::unique_ptr<WindowManager> & cl
     ImGui::RadioButton("Toon", &settings.shader_type, 2);
     ImGui::End();
 
+    ImGui::SetNextWindowPos(ImVec2(360, 100));
+    ImGui::Begin("dynamic resolution");
+    ImGui::SetWindowSize(ImVec2(210, 140));
+    ImGui::RadioButton("ON", &settings.dynamic_resolution, 1);
+    ImGui::RadioButton("OFF", &settings.dynamic_resolution, 0);
+    ImGui::InputFloat("target ms", &settings.target_frame_time, 0.5f);
+    ImGui::Text("scale : %d%%", static_cast<int>(game->getGraphics().getDynamicResolution().getScale() * 100.0f));
+    ImGui::End();
+
+    ImGui::SetNextWindowPos(ImVec2(570, 100));
+    ImGui::Begin("post processing");
+    ImGui::SetWindowSize(ImVec2(230, 160));
+    ImGui::InputFloat("exposure", &settings.exposure, 0.1f);
+    ImGui::Checkbox("vignette", &settings.vignette);
+    ImGui::Checkbox("color grading", &settings.color_grading);
+    ImGui::InputFloat("saturation", &settings.saturation, 0.1f);
+    ImGui::InputFloat("contrast", &settings.contrast, 0.1f);
+    ImGui::End();
+
+    ImGui::SetNextWindowPos(ImVec2(800, 100));
+    ImGui::Begin("anti aliasing");
+    ImGui::SetWindowSize(ImVec2(150, 120));
+    ImGui::RadioButton("MSAA 4x", &settings.anti_aliasing, 0);
+    ImGui::RadioButton("FXAA", &settings.anti_aliasing, 1);
+    ImGui::RadioButton("TAA", &settings.anti_aliasing, 2);
+    ImGui::RadioButton("OFF", &settings.anti_aliasing, 3);
+    ImGui::End();
+
     ImGui::SetNextWindowPos(ImVec2(client->getWidth()-50, 0));
     ImGui::Begin("FPS");
     ImGui::SetWindowSize(ImVec2(50, 60));
@@ -210,6 +239,12 @@ void editorUI(EDITOR_UI_SETTINGS & settings, std::unique_ptr<WindowManager> & cl
         game->getGraphics().setVolumetricLighting(false);
     else
         game->getGraphics().setVolumetricLighting(true);
+    game->getGraphics().getDynamicResolution().setEnabled(settings.dynamic_resolution == 1);
+    game->getGraphics().getDynamicResolution().setTargetFrameTime(std::max(1.0f, settings.target_frame_time));
+    game->getGraphics().setExposure(std::max(0.0f, settings.exposure));
+    game->getGraphics().setVignette(settings.vignette);
+    game->getGraphics().setColorGrading(settings.color_grading, std::max(0.0f, settings.saturation), std::max(0.0f, settings.contrast));
+    game->getGraphics().setAntiAliasing(static_cast<ANTI_ALIASING>(settings.anti_aliasing));
     if (settings.shader_type == 0)
         game->getGraphics().setColorShader(SHADER_TYPE::BLINN_PHONG);
     else if(settings.shader_type == 1)
@@ -242,6 +277,7 @@ void render(std::unique_ptr<WindowManager> client, std::unique_ptr<Game> game)
 	while(client->isAlive())
 	{
 		currentFrame = omp_get_wtime();
+		RingBuffer::get().beginFrame();
 		delta = static_cast<float>(currentFrame - lastFrame);
 		client->checkEvents();
 		game->updateSceneActiveCameraView(game->getActiveScene(), client->getUserInputs(), client->getMouseData(), delta);
@@ -263,10 +299,14 @@ void render(std::unique_ptr<WindowManager> client, std::unique_ptr<Game> game)
         if(debug)
             editorUI(editor_settings, client, game, debugPhysics, delta);
 
+		RingBuffer::get().endFrame();
 		client->resetEvents();
 		SDL_GL_SwapWindow(client->getWindowPtr());
 		lastFrame = currentFrame;
 	}
+
+	// streaming buffer goes before the GL context
+	RingBuffer::release();
 }
 
 int main(int argc, char* argv[])
@@ -6,7 +6,11 @@ Mesh::Mesh(std::vector<Vertex> aVertices, std::vector<int> aIndices, Material m,
 	indices(aIndices),
 	material(m),
     m_center(center),
-    m_center_update(center)
+    m_center_update(center),
+	streamed(false),
+	indexOffset(0),
+	streamFrame(0),
+	skinnedVbo(0)
 {
 	// VAO
 	glGenVertexArrays(1, &vao);
@@ -40,10 +44,16 @@ Mesh::Mesh(std::vector<Vertex> aVertices, std::vector<int> aIndices, Material m,
 
 	// Unbind VAO
 	glBindVertexArray(0);
+
+	setPermutation(vertices);
+	createDepthStream(vertices, false);
 }
 
 Mesh::~Mesh()
 {
+	deleteDepthStream();
+	glDeleteBuffers(1, &skinnedVbo);
+
 	glBindVertexArray(vao);
 	glBindBuffer(GL_ARRAY_BUFFER, 0);
 	glDeleteBuffers(1, &vbo);
@@ -93,9 +103,143 @@ void Mesh::setCenterUpdate(glm::vec3 center)
     m_center_update = center;
 }
 
-void Mesh::bindVAO() const
+void Mesh::bindVAO(bool depthOnly) const
 {
-	glBindVertexArray(vao);
+	glBindVertexArray((depthOnly) ? depthVao : vao);
+}
+
+void Mesh::setInstanceBuffer(GLuint buffer, long offset)
+{
+	// per instance model matrix (attributes 7 to 10) read from buffer at offset, in both vertex arrays,
+	// buffer 0 disables them
+	glBindBuffer(GL_ARRAY_BUFFER, buffer);
+	for(GLuint array : {vao, depthVao})
+	{
+		glBindVertexArray(array);
+		for(int i{0}; i < 4; ++i)
+		{
+			if(buffer == 0)
+			{
+				glDisableVertexAttribArray(7 + i);
+				continue;
+			}
+			glEnableVertexAttribArray(7 + i);
+			glVertexAttribPointer(7 + i, 4, GL_FLOAT, GL_FALSE, sizeof(glm::mat4), (void*)(offset + i * sizeof(glm::vec4)));
+			glVertexAttribDivisor(7 + i, 1);
+		}
+	}
+	glBindVertexArray(0);
+	glBindBuffer(GL_ARRAY_BUFFER, 0);
+}
+
+void Mesh::setPermutation(const std::vector<Vertex> & aVertices)
+{
+	// shader variant of this material, decided once instead of branching per fragment
+	material.permutation = 0;
+	for(int i{0}; i < material.textures.size(); ++i)
+	{
+		if(material.textures[i].type == TEXTURE_TYPE::DIFFUSE)
+			material.permutation |= MATERIAL_DIFFUSE_MAP | MATERIAL_ALPHA_TEST;
+		else if(material.textures[i].type == TEXTURE_TYPE::SPECULAR)
+			material.permutation |= MATERIAL_SPECULAR_MAP;
+		else if(material.textures[i].type == TEXTURE_TYPE::NORMAL)
+			material.permutation |= MATERIAL_NORMAL_MAP;
+		else if(material.textures[i].type == TEXTURE_TYPE::METALLIC_ROUGHNESS)
+			material.permutation |= MATERIAL_METALLIC_ROUGH_MAP;
+		else if(material.textures[i].type == TEXTURE_TYPE::EMISSIVE)
+			material.permutation |= MATERIAL_EMISSION_MAP;
+	}
+	for(int i{0}; i < aVertices.size(); ++i)
+	{
+		if(aVertices[i].weights != glm::vec4(0.0f))
+		{
+			material.permutation |= MATERIAL_SKINNED;
+			break;
+		}
+	}
+}
+
+void Mesh::createDepthStream(const std::vector<Vertex> & aVertices, bool dynamicDraw)
+{
+	// tightly packed positions, depth passes don't need the full vertex
+	std::vector<glm::vec3> positions(aVertices.size());
+	bool skinned{false};
+	for(int i{0}; i < aVertices.size(); ++i)
+	{
+		positions[i] = aVertices[i].position;
+		skinned = skinned || aVertices[i].weights != glm::vec4(0.0f);
+	}
+
+	bool alphaTested{false};
+	for(int i{0}; i < material.textures.size(); ++i)
+		alphaTested = alphaTested || material.textures[i].type == TEXTURE_TYPE::DIFFUSE;
+
+	glGenVertexArrays(1, &depthVao);
+	glBindVertexArray(depthVao);
+
+	glGenBuffers(1, &depthVbo);
+	glBindBuffer(GL_ARRAY_BUFFER, depthVbo);
+	glBufferData(GL_ARRAY_BUFFER, positions.size() * sizeof(glm::vec3), positions.data(), (dynamicDraw) ? GL_DYNAMIC_DRAW : GL_STATIC_DRAW);
+	glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(glm::vec3), (void*)0);
+	glEnableVertexAttribArray(0);
+
+	// texture coordinates (alpha test) and bones still come from the full vertex buffer
+	glBindBuffer(GL_ARRAY_BUFFER, vbo);
+	if(alphaTested)
+	{
+		glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*)(offsetof(Vertex, texCoords)));
+		glEnableVertexAttribArray(2);
+	}
+	if(skinned)
+	{
+		glVertexAttribIPointer(5, 4, GL_INT, sizeof(Vertex), (void*)(offsetof(Vertex, bonesID)));
+		glVertexAttribPointer(6, 4, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*)(offsetof(Vertex, weights)));
+		glEnableVertexAttribArray(5);
+		glEnableVertexAttribArray(6);
+	}
+
+	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, ebo);
+
+	glBindVertexArray(0);
+}
+
+void Mesh::deleteDepthStream()
+{
+	glBindBuffer(GL_ARRAY_BUFFER, 0);
+	glDeleteBuffers(1, &depthVbo);
+	glDeleteVertexArrays(1, &depthVao);
+}
+
+void Mesh::skin(Shader & cs)
+{
+	// bone matrices are set on cs by the caller
+	if(streamed || (!skinnedVbo && !(material.permutation & MATERIAL_SKINNED)))
+		return;
+
+	// first call : both vertex arrays read the skinned buffer from now on, drawn like static geometry
+	if(!skinnedVbo)
+	{
+		glGenBuffers(1, &skinnedVbo);
+		glBindBuffer(GL_ARRAY_BUFFER, skinnedVbo);
+		glBufferData(GL_ARRAY_BUFFER, vertices.size() * sizeof(Vertex), nullptr, GL_DYNAMIC_COPY);
+
+		glBindVertexArray(vao);
+		glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*)0);
+		glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*)(offsetof(Vertex, normal)));
+		glVertexAttribPointer(3, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*)(offsetof(Vertex, tangent)));
+		glVertexAttribPointer(4, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*)(offsetof(Vertex, biTangent)));
+		glBindVertexArray(depthVao);
+		glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*)0);
+		glBindVertexArray(0);
+		glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+		material.permutation &= ~MATERIAL_SKINNED;
+	}
+
+	cs.setInt("vertexCount", vertices.size());
+	glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 0, vbo);
+	glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 1, skinnedVbo);
+	cs.dispatch((vertices.size() + 63) / 64, 1, 1, GL_VERTEX_ATTRIB_ARRAY_BARRIER_BIT);
 }
 
 void Mesh::shaderProcessing(Shader & s, struct IBL_DATA * iblData)
@@ -116,6 +260,17 @@ void Mesh::shaderProcessing(Shader & s, struct IBL_DATA * iblData)
 	{
 		processShadows(s);
 	}
+	else if (s.getType() == SHADER_TYPE::GBUFFER)
+	{
+		processPBR(s, nullptr); // material inputs of the deferred path
+	}
+
+	// geometry fading out to its impostor
+	if(material.permutation & MATERIAL_DITHER_FADE)
+	{
+		s.setVec3f("fadeCenter", material.fadeCenter);
+		s.setVec2f("fadeRange", material.fadeRange);
+	}
 }
 
 void Mesh::processBlinnPhong(Shader& s)
@@ -127,11 +282,6 @@ void Mesh::processBlinnPhong(Shader& s)
 	s.setVec3f("material.color_ambient", material.color_ambient);
 	s.setFloat("material.shininess", material.shininess);
 	s.setFloat("material.opacity", material.opacity);
-	s.setInt("material.hasNormal", 0);
-	s.setInt("material.hasDiffuse", 0);
-	s.setInt("material.hasSpecular", 0);
-	s.setInt("material.hasEmission", 0);
-	s.setInt("material.nbTextures", material.textures.size());
 
 	for (int i{ 0 }; i < material.textures.size(); ++i)
 	{
@@ -140,28 +290,24 @@ void Mesh::processBlinnPhong(Shader& s)
 			glActiveTexture(GL_TEXTURE0 + i);
 			glBindTexture(GL_TEXTURE_2D, material.textures[i].id);
 			s.setInt("material.diffuse", i);
-			s.setInt("material.hasDiffuse", 1);
 		}
 		else if (material.textures[i].type == TEXTURE_TYPE::SPECULAR)
 		{
 			glActiveTexture(GL_TEXTURE0 + i);
 			glBindTexture(GL_TEXTURE_2D, material.textures[i].id);
 			s.setInt("material.specular", i);
-			s.setInt("material.hasSpecular", 1);
 		}
 		else if (material.textures[i].type == TEXTURE_TYPE::NORMAL)
 		{
 			glActiveTexture(GL_TEXTURE0 + i);
 			glBindTexture(GL_TEXTURE_2D, material.textures[i].id);
 			s.setInt("material.normal", i);
-			s.setInt("material.hasNormal", 1);
 		}
 		else if (material.textures[i].type == TEXTURE_TYPE::EMISSIVE)
 		{
 			glActiveTexture(GL_TEXTURE0 + i);
 			glBindTexture(GL_TEXTURE_2D, material.textures[i].id);
 			s.setInt("material.emissionMap", i);
-			s.setInt("material.hasEmission", 1);
 		}
 	}
 }
@@ -175,11 +321,6 @@ void Mesh::processPBR(Shader& s, struct IBL_DATA* iblData)
 	s.setFloat("material.roughness", material.roughness);
 	s.setFloat("material.ao", 1.0f);
 	s.setFloat("material.opacity", material.opacity);
-	s.setInt("material.hasNormal", 0);
-	s.setInt("material.hasAlbedo", 0);
-	s.setInt("material.hasMetallicRough", 0);
-	s.setInt("material.hasEmission", 0);
-	s.setInt("material.nbTextures", material.textures.size());
 
 	for (int i{ 0 }; i < material.textures.size(); ++i)
 	{
@@ -188,28 +329,24 @@ void Mesh::processPBR(Shader& s, struct IBL_DATA* iblData)
 			glActiveTexture(GL_TEXTURE0 + i);
 			glBindTexture(GL_TEXTURE_2D, material.textures[i].id);
 			s.setInt("material.albedoMap", i);
-			s.setInt("material.hasAlbedo", 1);
 		}
 		else if (material.textures[i].type == TEXTURE_TYPE::NORMAL)
 		{
 			glActiveTexture(GL_TEXTURE0 + i);
 			glBindTexture(GL_TEXTURE_2D, material.textures[i].id);
 			s.setInt("material.normalMap", i);
-			s.setInt("material.hasNormal", 1);
 		}
 		else if (material.textures[i].type == TEXTURE_TYPE::METALLIC_ROUGHNESS)
 		{
 			glActiveTexture(GL_TEXTURE0 + i);
 			glBindTexture(GL_TEXTURE_2D, material.textures[i].id);
 			s.setInt("material.metallicRoughMap", i);
-			s.setInt("material.hasMetallicRough", 1);
 		}
 		else if (material.textures[i].type == TEXTURE_TYPE::EMISSIVE)
 		{
 			glActiveTexture(GL_TEXTURE0 + i);
 			glBindTexture(GL_TEXTURE_2D, material.textures[i].id);
 			s.setInt("material.emissionMap", i);
-			s.setInt("material.hasEmission", 1);
 		}
 	}
 
@@ -238,11 +375,6 @@ void Mesh::processToon(Shader& s)
 	s.setVec3f("material.color_ambient", material.color_ambient);
 	s.setFloat("material.shininess", material.shininess);
 	s.setFloat("material.opacity", material.opacity);
-	s.setInt("material.hasNormal", 0);
-	s.setInt("material.hasDiffuse", 0);
-	s.setInt("material.hasSpecular", 0);
-	s.setInt("material.hasEmission", 0);
-	s.setInt("material.nbTextures", material.textures.size());
 
 	for (int i{ 0 }; i < material.textures.size(); ++i)
 	{
@@ -251,35 +383,30 @@ void Mesh::processToon(Shader& s)
 			glActiveTexture(GL_TEXTURE0 + i);
 			glBindTexture(GL_TEXTURE_2D, material.textures[i].id);
 			s.setInt("material.diffuse", i);
-			s.setInt("material.hasDiffuse", 1);
 		}
 		else if (material.textures[i].type == TEXTURE_TYPE::SPECULAR)
 		{
 			glActiveTexture(GL_TEXTURE0 + i);
 			glBindTexture(GL_TEXTURE_2D, material.textures[i].id);
 			s.setInt("material.specular", i);
-			s.setInt("material.hasSpecular", 1);
 		}
 		else if (material.textures[i].type == TEXTURE_TYPE::NORMAL)
 		{
 			glActiveTexture(GL_TEXTURE0 + i);
 			glBindTexture(GL_TEXTURE_2D, material.textures[i].id);
 			s.setInt("material.normal", i);
-			s.setInt("material.hasNormal", 1);
 		}
 		else if (material.textures[i].type == TEXTURE_TYPE::EMISSIVE)
 		{
 			glActiveTexture(GL_TEXTURE0 + i);
 			glBindTexture(GL_TEXTURE_2D, material.textures[i].id);
 			s.setInt("material.emissionMap", i);
-			s.setInt("material.hasEmission", 1);
 		}
 	}
 }
 
 void Mesh::processShadows(Shader& s)
 {
-	s.setInt("hasDiffuse", 0);
 	for (int i{ 0 }; i < material.textures.size(); ++i)
 	{
 		if (material.textures[i].type == TEXTURE_TYPE::DIFFUSE)
@@ -287,19 +414,33 @@ void Mesh::processShadows(Shader& s)
 			glActiveTexture(GL_TEXTURE0 + i);
 			glBindTexture(GL_TEXTURE_2D, material.textures[i].id);
 			s.setInt("diffuse", i);
-			s.setInt("hasDiffuse", 1);
 		}
 	}
 }
 
 void Mesh::draw(Shader& s, struct IBL_DATA * iblData, bool instancing, int amount, DRAWING_MODE mode)
 {
-	// bind vao
-	glBindVertexArray(vao);
+	// streamed vertices not updated this frame : written again, older ring regions get overwritten
+	if(streamed && streamFrame != RingBuffer::get().getFrame())
+		stream();
+	if(indexOffset < 0)
+		return;
+
+	// bind vao, depth only passes fetch positions only
+	glBindVertexArray((s.getType() == SHADER_TYPE::SHADOWS) ? depthVao : vao);
+
+	// material permutation of the shader, depth only passes only care about alpha test and skinning
+	SHADER_TYPE type = s.getType();
+	int permutation{0};
+	if(type == SHADER_TYPE::SHADOWS)
+		permutation = material.permutation & (MATERIAL_ALPHA_TEST | MATERIAL_SKINNED | MATERIAL_CROWD);
+	else if(type == SHADER_TYPE::BLINN_PHONG || type == SHADER_TYPE::PBR || type == SHADER_TYPE::TOON || type == SHADER_TYPE::GBUFFER)
+		permutation = material.permutation;
+	Shader & program = s.getVariant(permutation);
 
 	// use shader and sets its uniforms
-	s.use();
-	shaderProcessing(s, iblData);
+	program.use();
+	shaderProcessing(program, iblData);
 
 	// draw solid or wireframe
 	if(mode == DRAWING_MODE::SOLID)
@@ -315,13 +456,13 @@ void Mesh::draw(Shader& s, struct IBL_DATA * iblData, bool instancing, int amoun
 	// draw
 	if(instancing)
 	{
-		s.setInt("instancing", 1);
-		glDrawElementsInstanced(GL_TRIANGLES, indices.size(), GL_UNSIGNED_INT, 0, amount);
+		program.setInt("instancing", 1);
+		glDrawElementsInstanced(GL_TRIANGLES, indices.size(), GL_UNSIGNED_INT, (void*)(indexOffset), amount);
 	}
 	else
 	{
-		s.setInt("instancing", 0);
-		glDrawElements(GL_TRIANGLES, indices.size(), GL_UNSIGNED_INT, 0);
+		program.setInt("instancing", 0);
+		glDrawElements(GL_TRIANGLES, indices.size(), GL_UNSIGNED_INT, (void*)(indexOffset));
 	}
 
 	// unbind vao
@@ -334,6 +475,12 @@ void Mesh::draw(Shader& s, struct IBL_DATA * iblData, bool instancing, int amoun
 
 void Mesh::recreate(std::vector<Vertex> aVertices, std::vector<int> aIndices, bool dynamicDraw)
 {
+	deleteDepthStream();
+	glDeleteBuffers(1, &skinnedVbo);
+	skinnedVbo = 0;
+	streamed = false;
+	indexOffset = 0;
+
 	glBindVertexArray(vao);
 	glBindBuffer(GL_ARRAY_BUFFER, 0);
 	glDeleteBuffers(1, &vbo);
@@ -380,6 +527,9 @@ void Mesh::recreate(std::vector<Vertex> aVertices, std::vector<int> aIndices, bo
 
 	// Unbind VAO
 	glBindVertexArray(0);
+
+	setPermutation(aVertices);
+	createDepthStream(aVertices, dynamicDraw);
 }
 
 void Mesh::updateVBO(std::vector<Vertex> aVertices, std::vector<int> aIndices)
@@ -389,11 +539,50 @@ void Mesh::updateVBO(std::vector<Vertex> aVertices, std::vector<int> aIndices)
 	indices.clear();
 	indices = aIndices;
 
-	glBindBuffer(GL_ARRAY_BUFFER, vbo);
-	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, ebo);
+	streamed = true;
+	stream();
+}
+
+void Mesh::stream()
+{
+	// vertices, indices and depth positions written into the ring buffer, arrays pointed at this frame's copy
+	RingBuffer & ring = RingBuffer::get();
+	streamFrame = ring.getFrame();
 
-	glBufferSubData(GL_ARRAY_BUFFER, 0, vertices.size() * sizeof(Vertex), vertices.data());
-	glBufferSubData(GL_ELEMENT_ARRAY_BUFFER, 0, indices.size() * sizeof(int), indices.data());
+	std::vector<glm::vec3> positions(vertices.size());
+	for(int i{0}; i < vertices.size(); ++i)
+		positions[i] = vertices[i].position;
+
+	long vertexOffset = ring.push(vertices.data(), vertices.size() * sizeof(Vertex), sizeof(Vertex));
+	long positionOffset = ring.push(positions.data(), positions.size() * sizeof(glm::vec3), sizeof(glm::vec3));
+	indexOffset = ring.push(indices.data(), indices.size() * sizeof(int), sizeof(int));
+	if(vertexOffset < 0 || positionOffset < 0 || indexOffset < 0)
+	{
+		indexOffset = -1;
+		return;
+	}
+
+	glBindVertexArray(vao);
+	glBindBuffer(GL_ARRAY_BUFFER, ring.getId());
+	glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*)(vertexOffset));
+	glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*)(vertexOffset + offsetof(Vertex, normal)));
+	glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*)(vertexOffset + offsetof(Vertex, texCoords)));
+	glVertexAttribPointer(3, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*)(vertexOffset + offsetof(Vertex, tangent)));
+	glVertexAttribPointer(4, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*)(vertexOffset + offsetof(Vertex, biTangent)));
+	glVertexAttribIPointer(5, 4, GL_INT, sizeof(Vertex), (void*)(vertexOffset + offsetof(Vertex, bonesID)));
+	glVertexAttribPointer(6, 4, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*)(vertexOffset + offsetof(Vertex, weights)));
+	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, ring.getId());
+
+	// depth stream, attributes left disabled by createDepthStream stay disabled
+	glBindVertexArray(depthVao);
+	glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(glm::vec3), (void*)(positionOffset));
+	glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*)(vertexOffset + offsetof(Vertex, texCoords)));
+	glVertexAttribIPointer(5, 4, GL_INT, sizeof(Vertex), (void*)(vertexOffset + offsetof(Vertex, bonesID)));
+	glVertexAttribPointer(6, 4, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*)(vertexOffset + offsetof(Vertex, weights)));
+	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, ring.getId());
+
+	glBindVertexArray(0);
+	glBindBuffer(GL_ARRAY_BUFFER, 0);
 }
 
 bool Mesh::getVertex(glm::vec3 pos, glm::vec3 normal, glm::vec3 lastPos, Vertex & out)
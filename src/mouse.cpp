@@ -12,11 +12,10 @@ Mouse::Mouse(int pos[2], int size[2], std::string img_normal, std::string img_ho
     float posYRatio{ 1.0f - (pos[1] / static_cast<float>(m_screen[1])) };
     m_pos[1] = posYRatio * m_screen[1];
 
+    // the quad is streamed through the ring buffer when drawn
     glGenVertexArrays(1, &m_vao);
-    glGenBuffers(1, &m_vbo);
-
     glBindVertexArray(m_vao);
-    glBindBuffer(GL_ARRAY_BUFFER, m_vbo);
+    glBindBuffer(GL_ARRAY_BUFFER, RingBuffer::get().getId());
 
     float data[24] = {
         m_pos[0], m_pos[1], 0.0f, 1.0f,
@@ -27,7 +26,7 @@ Mouse::Mouse(int pos[2], int size[2], std::string img_normal, std::string img_ho
         m_pos[0] + m_size[0], m_pos[1], 1.0f, 1.0f
     };
 
-    glBufferData(GL_ARRAY_BUFFER, sizeof(data), data, GL_DYNAMIC_DRAW);
+    std::copy(data, data + 24, m_quad);
     glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, 4 * sizeof(float), (void*)(0));
     glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, 4 * sizeof(float), (void*)(2 * sizeof(float)));
     glEnableVertexAttribArray(0);
@@ -41,10 +40,6 @@ Mouse::Mouse(int pos[2], int size[2], std::string img_normal, std::string img_ho
 
 Mouse::~Mouse()
 {
-    glBindVertexArray(m_vao);
-    glBindBuffer(GL_ARRAY_BUFFER, 0);
-    glDeleteBuffers(1, &m_vbo);
-    glBindVertexArray(0);
     glDeleteVertexArrays(1, &m_vao);
     for (auto& img : m_img)
         glDeleteTextures(1, &img.id);
@@ -63,8 +58,7 @@ void Mouse::update_position()
         m_pos[0] + m_size[0], m_pos[1] - m_size[1], 1.0f, 0.0f,
         m_pos[0] + m_size[0], m_pos[1], 1.0f, 1.0f
     };
-    glBindBuffer(GL_ARRAY_BUFFER, m_vbo);
-    glBufferSubData(GL_ARRAY_BUFFER, 0, 24 * sizeof(float), data);
+    std::copy(data, data + 24, m_quad);
 }
 
 void Mouse::set_bloom_strength(float strength)
@@ -84,6 +78,11 @@ void Mouse::use_hover()
 
 void Mouse::draw()
 {
+    const long stride{4 * sizeof(float)};
+    long offset = RingBuffer::get().push(m_quad, sizeof(m_quad), stride);
+    if (offset < 0)
+        return;
+
     glBindVertexArray(m_vao);
     m_shader.use();
     m_shader.setMatrix("proj", m_projection);
@@ -91,7 +90,7 @@ void Mouse::draw()
     glBindTexture(GL_TEXTURE_2D, m_img[m_img_index].id);
     m_shader.setInt("image", 0);
     m_shader.setFloat("bloom_strength", m_bloom_strength);
-    glDrawArrays(GL_TRIANGLES, 0, 6);
+    glDrawArrays(GL_TRIANGLES, offset / stride, 6);
     glBindVertexArray(0);
 }
 
@@ -20,11 +20,19 @@ glm::mat3 assimpMat3_to_glmMat3(aiMatrix3x3 & m)
 	return matrix;
 }
 
-Object::Object(glm::mat4 aModel) : model(aModel), instancing(false) {}
+Object::Object(glm::mat4 aModel) : instanceVBO(0), model(aModel), instancing(false), dynamic(false), version(0), batchable(true), occluder(false), impostorDistance(0.0f), sphereValid(false), sphereVersion(0) {}
 
 Object::Object(const std::string & path, glm::mat4 aModel) :
+	instanceVBO(0),
 	model(aModel),
-	instancing(false)
+	instancing(false),
+	dynamic(false),
+	version(0),
+	batchable(true),
+	occluder(false),
+	impostorDistance(0.0f),
+	sphereValid(false),
+	sphereVersion(0)
 {
 	load(path);
 }
@@ -57,6 +65,11 @@ std::string Object::getName()
 	return name;
 }
 
+std::string & Object::getPath()
+{
+	return fullPath;
+}
+
 glm::mat4 Object::getModel()
 {
 	return model;
@@ -64,6 +77,8 @@ glm::mat4 Object::getModel()
 
 void Object::setModel(glm::mat4 & matrix)
 {
+	if(matrix != model)
+		version++;
 	model = matrix;
     for(auto m : meshes)
     {
@@ -72,11 +87,144 @@ void Object::setModel(glm::mat4 & matrix)
     }
 }
 
+void Object::setDynamic(bool d)
+{
+	dynamic = d;
+}
+
+bool Object::isDynamic()
+{
+	return dynamic;
+}
+
+void Object::setBatchable(bool b)
+{
+	batchable = b;
+}
+
+bool Object::isBatchable()
+{
+	return batchable && !instancing;
+}
+
+void Object::setOccluder(bool o, const std::string & proxyPath)
+{
+	occluder = o;
+	occluderPositions.clear();
+	occluderIndices.clear();
+	if(!occluder)
+		return;
+
+	if(!proxyPath.empty())
+	{
+		// simplified occluder mesh, only positions and triangles are kept
+		Assimp::Importer importer;
+		const aiScene* scene = importer.ReadFile(proxyPath, aiProcess_Triangulate | aiProcess_JoinIdenticalVertices);
+		if(scene && !(scene->mFlags & AI_SCENE_FLAGS_INCOMPLETE))
+		{
+			for(int m{0}; m < scene->mNumMeshes; ++m)
+			{
+				aiMesh* mesh = scene->mMeshes[m];
+				int offset = occluderPositions.size();
+				for(int i{0}; i < mesh->mNumVertices; ++i)
+					occluderPositions.emplace_back(mesh->mVertices[i].x, mesh->mVertices[i].y, mesh->mVertices[i].z);
+				for(int i{0}; i < mesh->mNumFaces; ++i)
+				{
+					if(mesh->mFaces[i].mNumIndices != 3)
+						continue;
+					for(int j{0}; j < 3; ++j)
+						occluderIndices.push_back(offset + mesh->mFaces[i].mIndices[j]);
+				}
+			}
+			return;
+		}
+		std::cerr << "Error while loading occluder proxy " << proxyPath << " : " << importer.GetErrorString() << std::endl;
+	}
+
+	for(auto & mesh : meshes)
+	{
+		int offset = occluderPositions.size();
+		for(const Vertex & v : mesh->getVertices())
+			occluderPositions.push_back(v.position);
+		for(int i : mesh->getIndices())
+			occluderIndices.push_back(offset + i);
+	}
+}
+
+bool Object::isOccluder()
+{
+	return occluder;
+}
+
+void Object::setImpostorDistance(float d)
+{
+	impostorDistance = d;
+}
+
+float Object::getImpostorDistance()
+{
+	return impostorDistance;
+}
+
+std::vector<glm::vec3> & Object::getOccluderPositions()
+{
+	return occluderPositions;
+}
+
+std::vector<int> & Object::getOccluderIndices()
+{
+	return occluderIndices;
+}
+
+unsigned int Object::getVersion()
+{
+	return version;
+}
+
 struct AABB Object::getAABB()
 {
 	return aabb;
 }
 
+struct BoundingSphere Object::getBoundingSphere()
+{
+	// queried per light and per cube face, only recomputed once the object moved
+	if(sphereValid && sphereVersion == version)
+		return worldSphere;
+
+	glm::vec3 aabbMin(aabb.xMin, aabb.yMin, aabb.zMin);
+	glm::vec3 aabbMax(aabb.xMax, aabb.yMax, aabb.zMax);
+	glm::vec3 localCenter = (aabbMin + aabbMax) * 0.5f;
+	float localRadius = glm::length(aabbMax - localCenter);
+
+	// instanced objects are placed by their instance matrices only
+	int count = (instancing) ? instanceModel.size() : 1;
+	auto instanceSphere = [&](int i) -> BoundingSphere {
+		const glm::mat4 & m = (instancing) ? instanceModel[i] : model;
+		float scale = glm::max(glm::length(glm::vec3(m[0])), glm::max(glm::length(glm::vec3(m[1])), glm::length(glm::vec3(m[2]))));
+		return BoundingSphere{glm::vec3(m * glm::vec4(localCenter, 1.0f)), localRadius * scale};
+	};
+
+	glm::vec3 boundsMin(std::numeric_limits<float>::max());
+	glm::vec3 boundsMax(std::numeric_limits<float>::lowest());
+	for(int i{0}; i < count; ++i)
+	{
+		BoundingSphere s = instanceSphere(i);
+		boundsMin = glm::min(boundsMin, s.center - s.radius);
+		boundsMax = glm::max(boundsMax, s.center + s.radius);
+	}
+
+	worldSphere = BoundingSphere{(boundsMin + boundsMax) * 0.5f, 0.0f};
+	for(int i{0}; i < count; ++i)
+	{
+		BoundingSphere s = instanceSphere(i);
+		worldSphere.radius = glm::max(worldSphere.radius, glm::length(s.center - worldSphere.center) + s.radius);
+	}
+	sphereVersion = version;
+	sphereValid = true;
+	return worldSphere;
+}
+
 void Object::setCollisionShape(std::string & collisionFilePath, glm::mat4 & aModel)
 {
 	collisionShape = std::make_shared<Object>(collisionFilePath, aModel);
@@ -92,6 +240,11 @@ std::vector<glm::mat4> & Object::getInstanceModel()
 	return instanceModel;
 }
 
+GLuint Object::getInstanceVBO()
+{
+	return instanceVBO;
+}
+
 std::vector<std::shared_ptr<Mesh>> & Object::getMeshes()
 {
     return meshes;
@@ -100,8 +253,7 @@ std::vector<std::shared_ptr<Mesh>> & Object::getMeshes()
 void Object::draw(Shader& shader, struct IBL_DATA * iblData, DRAWING_MODE mode)
 {
 	shader.use();
-	shader.setInt("animated", 0);
-	shader.setMatrix("model", model);
+	shader.setDrawMatrix("model", model);
 
 	int meshCount = meshes.size();
 
@@ -117,14 +269,16 @@ void Object::setInstancing(const std::vector<glm::mat4> & models)
 {
 	instancing = true;
 	instanceModel = models;
+	version++;
 
 	glGenBuffers(1, &instanceVBO);
 	glBindBuffer(GL_ARRAY_BUFFER, instanceVBO);
 	glBufferData(GL_ARRAY_BUFFER, models.size() * sizeof(glm::mat4), models.data(), GL_STATIC_DRAW);
 
-	for(int i{0}; i < meshes.size(); ++i)
+	// per instance matrices in both the full and the depth only vertex arrays
+	for(int i{0}; i < meshes.size() * 2; ++i)
 	{
-		meshes[i]->bindVAO();
+		meshes[i / 2]->bindVAO(i % 2 == 1);
 
 		std::size_t vec4Size = sizeof(glm::vec4);
 		glEnableVertexAttribArray(7);
@@ -147,9 +301,9 @@ void Object::setInstancing(const std::vector<glm::mat4> & models)
 
 void Object::resetInstancing()
 {
-	for(int i{0}; i < meshes.size(); ++i)
+	for(int i{0}; i < meshes.size() * 2; ++i)
 	{
-		meshes[i]->bindVAO();
+		meshes[i / 2]->bindVAO(i % 2 == 1);
 
 		glDisableVertexAttribArray(7);
 		glDisableVertexAttribArray(8);
@@ -163,6 +317,7 @@ void Object::resetInstancing()
 	glDeleteBuffers(1, &instanceVBO);
 	instanceModel.clear();
 	instancing = false;
+	version++;
 }
 
 bool Object::getInstancing()
@@ -216,6 +371,7 @@ void Object::load(const std::string & path)
 
 void Object::computeAABB()
 {
+	sphereValid = false;
 	bool first{true};
 	for(int i{0}; i < meshes.size(); ++i)
 	{
@@ -349,6 +505,7 @@ std::shared_ptr<Mesh> Object::getMesh(aiMesh* mesh, const aiScene* scene)
 	aiColor3D color_ambient{0.0f, 0.0f, 0.0f};
 	aiColor3D color_emissive{0.0f, 0.0f, 0.0f};
 	int opaque{1};
+	int orderIndependent{0};
     float opacity{1.0f};
 	float shininess{1.0f};
 	float roughness{0.5f};
@@ -406,6 +563,9 @@ std::shared_ptr<Mesh> Object::getMesh(aiMesh* mesh, const aiScene* scene)
 				emission_intensity = atof(attr->value());
 				attr = attr->next_attribute();
 				opaque = atoi(attr->value());
+				attr = attr->next_attribute();
+				if(attr)
+					orderIndependent = atoi(attr->value());
 			}
 		}
 	}
@@ -417,6 +577,7 @@ std::shared_ptr<Mesh> Object::getMesh(aiMesh* mesh, const aiScene* scene)
     material.color_ambient = glm::vec3(color_ambient.r, color_ambient.g, color_ambient.b);
     material.color_emissive = glm::vec3(color_emissive.r, color_emissive.g, color_emissive.b);
 	material.opaque = opaque;
+	material.orderIndependent = orderIndependent;
     material.opacity = opacity;
     material.shininess = shininess;
 	material.roughness = roughness;
@@ -0,0 +1,227 @@
+#include "occlusion.hpp"
+
+#define OCCLUSION_BAND_HEIGHT 8
+
+OcclusionBuffer::OcclusionBuffer(int aWidth, int aHeight) :
+	width(aWidth),
+	height(aHeight),
+	viewProj(1.0f)
+{
+	int w{width};
+	int h{height};
+	while(true)
+	{
+		levelSize.emplace_back(w, h);
+		pyramid.emplace_back(w * h, 1.0f);
+		if(w == 1 && h == 1)
+			break;
+		w = std::max(1, (w + 1) / 2);
+		h = std::max(1, (h + 1) / 2);
+	}
+}
+
+void OcclusionBuffer::clear(const glm::mat4 & aViewProj)
+{
+	viewProj = aViewProj;
+	triangles.clear();
+	for(auto & level : pyramid)
+		std::fill(level.begin(), level.end(), 1.0f);
+}
+
+void OcclusionBuffer::addOccluder(const std::vector<glm::vec3> & positions, const std::vector<int> & indices, const glm::mat4 & model)
+{
+	glm::mat4 mvp = viewProj * model;
+	for(std::size_t i{0}; i + 2 < indices.size(); i += 3)
+	{
+		ScreenTriangle t;
+		t.depth = 0.0f;
+		bool clipped{false};
+		for(int j{0}; j < 3; ++j)
+		{
+			glm::vec4 clip = mvp * glm::vec4(positions[indices[i + j]], 1.0f);
+
+			// crossing the near plane : dropped, an occluder may only hide less
+			if(clip.w <= 1e-4f)
+			{
+				clipped = true;
+				break;
+			}
+			glm::vec3 ndc = glm::vec3(clip) / clip.w;
+			t.v[j] = glm::vec2((ndc.x * 0.5f + 0.5f) * width, (ndc.y * 0.5f + 0.5f) * height);
+			t.depth = std::max(t.depth, ndc.z * 0.5f + 0.5f);
+		}
+		if(clipped || t.depth > 1.0f)
+			continue;
+
+		// counter clockwise winding, both faces occlude
+		glm::vec2 e1 = t.v[1] - t.v[0];
+		glm::vec2 e2 = t.v[2] - t.v[0];
+		float area = e1.x * e2.y - e1.y * e2.x;
+		if(area == 0.0f)
+			continue;
+		if(area < 0.0f)
+			std::swap(t.v[1], t.v[2]);
+
+		float minX = std::min({t.v[0].x, t.v[1].x, t.v[2].x});
+		float maxX = std::max({t.v[0].x, t.v[1].x, t.v[2].x});
+		t.minY = std::max(0, static_cast<int>(std::floor(std::min({t.v[0].y, t.v[1].y, t.v[2].y}))));
+		t.maxY = std::min(height - 1, static_cast<int>(std::ceil(std::max({t.v[0].y, t.v[1].y, t.v[2].y}))));
+		if(maxX < 0.0f || minX > width || t.minY > t.maxY)
+			continue;
+
+		triangles.push_back(t);
+	}
+}
+
+void OcclusionBuffer::rasterize()
+{
+	int bands = (height + OCCLUSION_BAND_HEIGHT - 1) / OCCLUSION_BAND_HEIGHT;
+
+	#pragma omp parallel for
+	for(int b = 0; b < bands; ++b)
+		rasterizeBand(b * OCCLUSION_BAND_HEIGHT, std::min(height, (b + 1) * OCCLUSION_BAND_HEIGHT));
+
+	buildPyramid();
+}
+
+void OcclusionBuffer::rasterizeBand(int y0, int y1)
+{
+	std::vector<float> & depth = pyramid[0];
+	for(const ScreenTriangle & t : triangles)
+	{
+		if(t.maxY < y0 || t.minY >= y1)
+			continue;
+
+		// edge functions : e(x, y) = a * x + b * y + c, positive inside
+		float a[3], b[3], c[3];
+		for(int e{0}; e < 3; ++e)
+		{
+			const glm::vec2 & p0 = t.v[e];
+			const glm::vec2 & p1 = t.v[(e + 1) % 3];
+			a[e] = p0.y - p1.y;
+			b[e] = p1.x - p0.x;
+			c[e] = p0.x * p1.y - p0.y * p1.x;
+		}
+
+		int minX = std::max(0, static_cast<int>(std::floor(std::min({t.v[0].x, t.v[1].x, t.v[2].x}))));
+		int maxX = std::min(width - 1, static_cast<int>(std::ceil(std::max({t.v[0].x, t.v[1].x, t.v[2].x}))));
+		int startY = std::max(y0, t.minY);
+		int endY = std::min(y1 - 1, t.maxY);
+		for(int y = startY; y <= endY; ++y)
+		{
+			float py = y + 0.5f;
+			float * row = depth.data() + y * width;
+			float r0 = b[0] * py + c[0];
+			float r1 = b[1] * py + c[1];
+			float r2 = b[2] * py + c[2];
+
+			#pragma omp simd
+			for(int x = minX; x <= maxX; ++x)
+			{
+				float px = x + 0.5f;
+				bool inside = (a[0] * px + r0 >= 0.0f) && (a[1] * px + r1 >= 0.0f) && (a[2] * px + r2 >= 0.0f);
+				row[x] = (inside) ? std::min(row[x], t.depth) : row[x];
+			}
+		}
+	}
+}
+
+void OcclusionBuffer::buildPyramid()
+{
+	for(std::size_t l{1}; l < pyramid.size(); ++l)
+	{
+		const std::vector<float> & src = pyramid[l - 1];
+		std::vector<float> & dst = pyramid[l];
+		glm::ivec2 srcSize = levelSize[l - 1];
+		glm::ivec2 dstSize = levelSize[l];
+		for(int y{0}; y < dstSize.y; ++y)
+		{
+			for(int x{0}; x < dstSize.x; ++x)
+			{
+				int sx = std::min(2 * x + 1, srcSize.x - 1);
+				int sy = std::min(2 * y + 1, srcSize.y - 1);
+				dst[y * dstSize.x + x] = std::max(
+						std::max(src[2 * y * srcSize.x + 2 * x], src[2 * y * srcSize.x + sx]),
+						std::max(src[sy * srcSize.x + 2 * x], src[sy * srcSize.x + sx]));
+			}
+		}
+	}
+}
+
+bool OcclusionBuffer::isVisible(const BoundingSphere & sphere)
+{
+	if(triangles.empty())
+		return true;
+
+	// screen rectangle and nearest depth of the box around the sphere
+	glm::vec2 rectMin(std::numeric_limits<float>::max());
+	glm::vec2 rectMax(std::numeric_limits<float>::lowest());
+	float nearest{1.0f};
+	for(int i{0}; i < 8; ++i)
+	{
+		glm::vec3 corner = sphere.center + sphere.radius * glm::vec3(
+				(i & 1) ? 1.0f : -1.0f,
+				(i & 2) ? 1.0f : -1.0f,
+				(i & 4) ? 1.0f : -1.0f);
+		glm::vec4 clip = viewProj * glm::vec4(corner, 1.0f);
+		if(clip.w <= 1e-4f)
+			return true;
+		glm::vec3 ndc = glm::vec3(clip) / clip.w;
+		glm::vec2 screen((ndc.x * 0.5f + 0.5f) * width, (ndc.y * 0.5f + 0.5f) * height);
+		rectMin = glm::min(rectMin, screen);
+		rectMax = glm::max(rectMax, screen);
+		nearest = std::min(nearest, ndc.z * 0.5f + 0.5f);
+	}
+	if(nearest <= 0.0f)
+		return true;
+
+	int x0 = std::max(0, static_cast<int>(std::floor(rectMin.x)));
+	int y0 = std::max(0, static_cast<int>(std::floor(rectMin.y)));
+	int x1 = std::min(width - 1, static_cast<int>(std::floor(rectMax.x)));
+	int y1 = std::min(height - 1, static_cast<int>(std::floor(rectMax.y)));
+	if(x0 > x1 || y0 > y1)
+		return true; // off screen, left to frustum culling
+
+	// coarsest level where the rectangle spans a few texels
+	int level{0};
+	while(level + 1 < static_cast<int>(pyramid.size()) && std::max(x1 - x0, y1 - y0) > 4)
+	{
+		x0 /= 2;
+		y0 /= 2;
+		x1 /= 2;
+		y1 /= 2;
+		level++;
+	}
+
+	const std::vector<float> & depth = pyramid[level];
+	int levelWidth = levelSize[level].x;
+	for(int y{y0}; y <= y1; ++y)
+	{
+		for(int x{x0}; x <= x1; ++x)
+		{
+			if(nearest <= depth[y * levelWidth + x])
+				return true;
+		}
+	}
+	return false;
+}
+
+bool OcclusionBuffer::empty()
+{
+	return triangles.empty();
+}
+
+int OcclusionBuffer::getWidth()
+{
+	return width;
+}
+
+int OcclusionBuffer::getHeight()
+{
+	return height;
+}
+
+const std::vector<float> & OcclusionBuffer::getDepth(int level)
+{
+	return pyramid[level];
+}
@@ -11,6 +11,8 @@ ParticleEmitter::ParticleEmitter(glm::vec3 pos, int emitRate, float aMaxLifetime
 	speed(aSpeed),
 	mt(rd()),
 	distribution(-0.5f, 0.5f),
+	particles_first(-1),
+	particles_frame(0),
 	emitter_shader("shaders/particles/emitter/vertex.glsl", "shaders/particles/emitter/geometry.glsl", "shaders/particles/emitter/fragment.glsl"),
 	particles_shader("shaders/particles/vertex.glsl", "shaders/particles/geometry.glsl", "shaders/particles/fragment.glsl")
 {
@@ -32,9 +34,8 @@ ParticleEmitter::ParticleEmitter(glm::vec3 pos, int emitRate, float aMaxLifetime
 	glGenVertexArrays(1, &particles_vao);
 	glBindVertexArray(particles_vao);
 
-	glGenBuffers(1, &particles_vbo);
-	glBindBuffer(GL_ARRAY_BUFFER, particles_vbo);
-	glBufferData(GL_ARRAY_BUFFER, MAX_PARTICLES * sizeof(Particle), nullptr, GL_DYNAMIC_DRAW);
+	// particles are streamed every frame, draws start at particles_first
+	glBindBuffer(GL_ARRAY_BUFFER, RingBuffer::get().getId());
 
 	glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(Particle), (void*)0);
 	glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, sizeof(Particle), (void*)(offsetof(Particle, velocity)));
@@ -69,6 +70,7 @@ ParticleEmitter::~ParticleEmitter()
 	glDeleteBuffers(1, &emitter_vbo);
 	glBindVertexArray(0);
 	glDeleteVertexArrays(1, &emitter_vao);
+	glDeleteVertexArrays(1, &particles_vao);
 }
 
 glm::vec3 ParticleEmitter::getPosition()
@@ -115,7 +117,7 @@ void ParticleEmitter::drawEmitter(glm::mat4 view, glm::mat4 proj)
 	glPolygonMode(GL_FRONT_AND_BACK, GL_FILL);
 }
 
-void ParticleEmitter::drawParticles(glm::mat4 view, glm::mat4 proj, glm::vec3 camRight, glm::vec3 camUp)
+void ParticleEmitter::drawParticles(glm::mat4 view, glm::mat4 proj, glm::vec3 camRight, glm::vec3 camUp, bool orderIndependent)
 {
 	particles_shader.use();
 	particles_shader.setMatrix("model", glm::mat4(1.0f));
@@ -126,18 +128,25 @@ void ParticleEmitter::drawParticles(glm::mat4 view, glm::mat4 proj, glm::vec3 ca
 	particles_shader.setFloat("maxLifetime", maxLifetime);
 	particles_shader.setFloat("numImagesX", 8.0f);
 	particles_shader.setFloat("numImagesY", 6.0f);
+	particles_shader.setInt("oitPass", (orderIndependent) ? 1 : 0);
 
 	glActiveTexture(GL_TEXTURE0);
 	glBindTexture(GL_TEXTURE_2D, fireAtlas);
 	particles_shader.setInt("particle", 0);
 
+	// not emitted this frame : stream again, older ring regions get overwritten
+	if(particles_frame != RingBuffer::get().getFrame())
+		streamParticles();
+	if(particles_first < 0)
+		return;
+
 	glBindVertexArray(particles_vao);
-	glDrawArrays(GL_POINTS, 0, particles.size());
+	glDrawArrays(GL_POINTS, particles_first, particles.size());
 
 	glBindVertexArray(0);
 }
 
-void ParticleEmitter::emit(glm::vec3 camPos, float delta)
+void ParticleEmitter::emit(glm::vec3 camPos, float delta, bool sort)
 {
 	static float accum{0.0f};
 	accum += delta;
@@ -174,22 +183,33 @@ void ParticleEmitter::emit(glm::vec3 camPos, float delta)
 		particles.push_back(p);
 	}
 
-	// sort particles from the furthest to the nearest
-	std::function sortParticles = [&camPos] (Particle & a, Particle & b) -> bool
-	{
-		glm::vec3 v1 = a.position - camPos;
-		glm::vec3 v2 = b.position - camPos;
-		float d1 = sqrt(v1.x * v1.x + v1.y * v1.y + v1.z * v1.z);
-		float d2 = sqrt(v2.x * v2.x + v2.y * v2.y + v2.z * v2.z);
-		return d1 < d2;
-	};
-	std::sort(particles.begin(), particles.end(), sortParticles);
-	std::reverse(particles.begin(), particles.end());
-
-	// update VBO
-	if(particles.size() >= 3)
+	// sort particles from the furthest to the nearest, not needed when blended order independently
+	if(sort)
 	{
-		glBindBuffer(GL_ARRAY_BUFFER, particles_vbo);
-		glBufferSubData(GL_ARRAY_BUFFER, 0, particles.size() * sizeof(Particle), particles.data());
+		std::function sortParticles = [&camPos] (Particle & a, Particle & b) -> bool
+		{
+			glm::vec3 v1 = a.position - camPos;
+			glm::vec3 v2 = b.position - camPos;
+			float d1 = sqrt(v1.x * v1.x + v1.y * v1.y + v1.z * v1.z);
+			float d2 = sqrt(v2.x * v2.x + v2.y * v2.y + v2.z * v2.z);
+			return d1 < d2;
+		};
+		std::sort(particles.begin(), particles.end(), sortParticles);
+		std::reverse(particles.begin(), particles.end());
 	}
+
+	streamParticles();
+}
+
+void ParticleEmitter::streamParticles()
+{
+	RingBuffer & ring = RingBuffer::get();
+	particles_frame = ring.getFrame();
+	particles_first = -1;
+	if(particles.empty())
+		return;
+
+	long offset = ring.push(particles.data(), particles.size() * sizeof(Particle), sizeof(Particle));
+	if(offset >= 0)
+		particles_first = offset / sizeof(Particle);
 }
@@ -0,0 +1,243 @@
+#include "renderGraph.hpp"
+
+RenderTargetDesc::RenderTargetDesc(int aWidth, int aHeight, GLint aInternalFormat, GLenum aFormat, GLenum aType, GLenum aFilter, int aAttachments, int aLevels) :
+	width(std::max(1, aWidth)),
+	height(std::max(1, aHeight)),
+	internalFormat(aInternalFormat),
+	format(aFormat),
+	type(aType),
+	filter(aFilter),
+	attachments(aAttachments),
+	levels(aLevels)
+{}
+
+bool RenderTargetDesc::operator==(const RenderTargetDesc & d) const
+{
+	return width == d.width && height == d.height && internalFormat == d.internalFormat && format == d.format &&
+		type == d.type && filter == d.filter && attachments == d.attachments && levels == d.levels;
+}
+
+RenderGraph::RenderGraph() :
+	frame(0)
+{}
+
+void RenderGraph::reset()
+{
+	// declarations are rebuilt every frame, the pool is kept
+	resources.clear();
+	lookup.clear();
+	passes.clear();
+	outputs.clear();
+	frame++;
+}
+
+void RenderGraph::createTarget(const std::string & name, const RenderTargetDesc & desc)
+{
+	if(lookup.count(name))
+	{
+		std::cerr << "Error: render target " << name << " declared twice." << std::endl;
+		return;
+	}
+	lookup[name] = resources.size();
+	resources.push_back({name, desc, false, -1, -1, -1, {}});
+}
+
+void RenderGraph::importTarget(const std::string & name, const std::vector<GLuint> & textures)
+{
+	// owned elsewhere (persistent or history), tracked for dependencies and texture lookups
+	if(lookup.count(name))
+		return;
+	lookup[name] = resources.size();
+	resources.push_back({name, RenderTargetDesc(1, 1), true, -1, -1, -1, textures});
+}
+
+void RenderGraph::addPass(const std::string & name, const std::vector<std::string> & reads, const std::vector<std::string> & writes, std::function<void()> execute)
+{
+	passes.push_back({name, findAll(reads), findAll(writes), execute, false});
+}
+
+void RenderGraph::markOutput(const std::string & name)
+{
+	int r = find(name);
+	if(r != -1)
+		outputs.push_back(r);
+}
+
+void RenderGraph::compile()
+{
+	// culling : walking backwards, a pass is kept when something needed is written by it
+	std::vector<bool> needed(resources.size(), false);
+	for(int o : outputs)
+		needed[o] = true;
+	for(int p = passes.size() - 1; p >= 0; --p)
+	{
+		Pass & pass = passes[p];
+		pass.culled = std::none_of(pass.writes.begin(), pass.writes.end(), [&needed](int w){ return needed[w]; });
+		if(!pass.culled)
+		{
+			for(int r : pass.reads)
+				needed[r] = true;
+		}
+	}
+
+	// lifetimes
+	for(int p{0}; p < passes.size(); ++p)
+	{
+		if(passes[p].culled)
+			continue;
+		for(const std::vector<int> & list : {passes[p].reads, passes[p].writes})
+		{
+			for(int r : list)
+			{
+				Resource & res = resources[r];
+				res.first = (res.first == -1) ? p : std::min(res.first, p);
+				res.last = std::max(res.last, p);
+			}
+		}
+	}
+	for(int o : outputs)
+		resources[o].last = passes.size();
+
+	// aliasing : targets taken in order of first use, a pooled target is shared once its previous user is dead
+	std::vector<int> order;
+	for(int r{0}; r < resources.size(); ++r)
+	{
+		if(!resources[r].imported && resources[r].first != -1)
+			order.push_back(r);
+	}
+	std::stable_sort(order.begin(), order.end(), [this](int a, int b){ return resources[a].first < resources[b].first; });
+
+	for(PooledTarget & target : pool)
+		target.busyUntil = -1;
+
+	for(int r : order)
+	{
+		Resource & res = resources[r];
+		for(int t{0}; t < pool.size() && res.physical == -1; ++t)
+		{
+			if(pool[t].desc == res.desc && pool[t].busyUntil < res.first)
+				res.physical = t;
+		}
+		if(res.physical == -1)
+		{
+			// lazy allocation, only for the passes that run
+			PooledTarget target{res.desc, std::make_unique<Framebuffer>(true, false, true), frame, -1};
+			for(int a{0}; a < res.desc.attachments; ++a)
+			{
+				target.fbo->addSizedColorTextureAttachment(res.desc.internalFormat, res.desc.format, res.desc.type, res.desc.filter, res.desc.width, res.desc.height);
+				if(res.desc.levels > 1)
+					allocateLevels(target.fbo->getAttachments()[a].id, res.desc);
+			}
+			res.physical = pool.size();
+			pool.push_back(std::move(target));
+		}
+		pool[res.physical].busyUntil = res.last;
+		pool[res.physical].lastFrame = frame;
+	}
+	glBindFramebuffer(GL_FRAMEBUFFER, 0);
+
+	// memory of disabled effects is given back after a few frames
+	for(int t = pool.size() - 1; t >= 0; --t)
+	{
+		if(frame - pool[t].lastFrame > RENDER_GRAPH_KEEP_FRAMES)
+		{
+			pool.erase(pool.begin() + t);
+			for(Resource & res : resources)
+			{
+				if(res.physical > t)
+					res.physical--;
+			}
+		}
+	}
+}
+
+void RenderGraph::execute()
+{
+	for(Pass & pass : passes)
+	{
+		if(!pass.culled)
+			pass.execute();
+	}
+}
+
+bool RenderGraph::hasTarget(const std::string & name)
+{
+	return lookup.count(name) != 0;
+}
+
+std::unique_ptr<Framebuffer> & RenderGraph::getFBO(const std::string & name)
+{
+	int r = find(name);
+	if(r == -1 || resources[r].physical == -1)
+	{
+		std::cerr << "Error: render target " << name << " has no memory, imported or culled." << std::endl;
+		return none;
+	}
+	return pool[resources[r].physical].fbo;
+}
+
+GLuint RenderGraph::getTexture(const std::string & name, int attachment)
+{
+	// 0 for targets not declared this frame (effect disabled)
+	auto it = lookup.find(name);
+	if(it == lookup.end())
+		return 0;
+	int r = it->second;
+	if(resources[r].imported)
+		return (attachment < resources[r].textures.size()) ? resources[r].textures[attachment] : 0;
+	if(resources[r].physical == -1)
+		return 0;
+	return pool[resources[r].physical].fbo->getAttachments()[attachment].id;
+}
+
+void RenderGraph::releasePool()
+{
+	// screen resized, targets are created again at the new size when first needed
+	pool.clear();
+	for(Resource & res : resources)
+		res.physical = -1;
+}
+
+int RenderGraph::getPooledTargetCount()
+{
+	return pool.size();
+}
+
+int RenderGraph::getActivePassCount()
+{
+	return std::count_if(passes.begin(), passes.end(), [](const Pass & p){ return !p.culled; });
+}
+
+void RenderGraph::allocateLevels(GLuint texture, const RenderTargetDesc & desc)
+{
+	// levels below the attached one, sampled with textureLod
+	glBindTexture(GL_TEXTURE_2D, texture);
+	for(int l{1}; l < desc.levels; ++l)
+		glTexImage2D(GL_TEXTURE_2D, l, desc.internalFormat, std::max(1, desc.width >> l), std::max(1, desc.height >> l), 0, desc.format, desc.type, nullptr);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, desc.levels - 1);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, (desc.filter == GL_NEAREST) ? GL_NEAREST_MIPMAP_NEAREST : GL_LINEAR_MIPMAP_NEAREST);
+	glBindTexture(GL_TEXTURE_2D, 0);
+}
+
+int RenderGraph::find(const std::string & name)
+{
+	auto it = lookup.find(name);
+	if(it == lookup.end())
+	{
+		std::cerr << "Error: unknown render target " << name << "." << std::endl;
+		return -1;
+	}
+	return it->second;
+}
+
+std::vector<int> RenderGraph::findAll(const std::vector<std::string> & names)
+{
+	std::vector<int> indices;
+	for(const std::string & name : names)
+	{
+		int r = find(name);
+		if(r != -1)
+			indices.push_back(r);
+	}
+	return indices;
+}
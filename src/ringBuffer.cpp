@@ -0,0 +1,105 @@
+#include "ringBuffer.hpp"
+
+std::unique_ptr<RingBuffer> RingBuffer::instance;
+
+RingBuffer::RingBuffer(long aFrameSize) :
+	buffer(0),
+	mapped(nullptr),
+	frameSize(aFrameSize),
+	region(0),
+	used(0),
+	frame(0)
+{
+	fences.fill(nullptr);
+
+	GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+	GLsizeiptr size = RING_BUFFER_FRAMES * frameSize;
+	glGenBuffers(1, &buffer);
+	glBindBuffer(GL_ARRAY_BUFFER, buffer);
+	glBufferStorage(GL_ARRAY_BUFFER, size, nullptr, flags);
+	mapped = static_cast<char*>(glMapBufferRange(GL_ARRAY_BUFFER, 0, size, flags));
+	glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+	if(!mapped)
+		std::cerr << "Error: cannot map streaming ring buffer !" << std::endl;
+}
+
+RingBuffer::~RingBuffer()
+{
+	for(GLsync fence : fences)
+	{
+		if(fence)
+			glDeleteSync(fence);
+	}
+	glBindBuffer(GL_ARRAY_BUFFER, buffer);
+	glUnmapBuffer(GL_ARRAY_BUFFER);
+	glBindBuffer(GL_ARRAY_BUFFER, 0);
+	glDeleteBuffers(1, &buffer);
+}
+
+RingBuffer & RingBuffer::get()
+{
+	// created on first use, a GL context must be current
+	if(!instance)
+		instance = std::make_unique<RingBuffer>();
+	return *instance;
+}
+
+void RingBuffer::release()
+{
+	instance.reset();
+}
+
+void RingBuffer::beginFrame()
+{
+	// wait until the GPU is done with the region written RING_BUFFER_FRAMES frames ago
+	region = (region + 1) % RING_BUFFER_FRAMES;
+	used = 0;
+	frame++;
+	if(fences[region])
+	{
+		while(glClientWaitSync(fences[region], GL_SYNC_FLUSH_COMMANDS_BIT, 1000000) == GL_TIMEOUT_EXPIRED);
+		glDeleteSync(fences[region]);
+		fences[region] = nullptr;
+	}
+}
+
+void RingBuffer::endFrame()
+{
+	if(fences[region])
+		glDeleteSync(fences[region]);
+	fences[region] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+}
+
+RingAllocation RingBuffer::allocate(long size, long alignment)
+{
+	// the absolute offset is a multiple of alignment, a vertex stride lets draws start at offset / stride
+	long start = region * frameSize;
+	long offset = ((start + used + alignment - 1) / alignment) * alignment;
+	if(!mapped || offset + size > start + frameSize)
+	{
+		std::cerr << "Error: streaming ring buffer full for this frame !" << std::endl;
+		return {nullptr, -1};
+	}
+
+	used = offset + size - start;
+	return {mapped + offset, offset};
+}
+
+long RingBuffer::push(const void * data, long size, long alignment)
+{
+	RingAllocation a = allocate(size, alignment);
+	if(a.data)
+		std::memcpy(a.data, data, size);
+	return a.offset;
+}
+
+GLuint RingBuffer::getId()
+{
+	return buffer;
+}
+
+unsigned long RingBuffer::getFrame()
+{
+	return frame;
+}
@@ -27,12 +27,22 @@ void Scene::addObject(std::string filePath, glm::mat4 aModel, std::string collis
 	objects.push_back(obj);
 
     std::vector<std::shared_ptr<Mesh>> & meshes{obj->getMeshes()};
-    for(auto mesh : meshes)
+    for(int m{0}; m < meshes.size(); ++m)
     {
+        std::shared_ptr<Mesh> & mesh = meshes[m];
         if(mesh->getMaterial().opaque == 1)
-            opaqueMesh.push_back(std::make_pair(mesh, objects.size()-1));
+        {
+            // objects loaded from the same file share geometry and materials
+            int batch{-1};
+            if(instanceModel.empty())
+            {
+                batch = batchIds.emplace(std::make_pair(filePath, m), batchIds.size()).first->second;
+                batchModels.resize(batchIds.size());
+            }
+            opaqueMesh.push_back({mesh, static_cast<int>(objects.size()-1), batch});
+        }
         else
-            transparentMesh.push_back(std::make_pair(mesh, objects.size()-1));
+            transparentMesh.push_back({mesh.get(), static_cast<int>(objects.size()-1), 0});
     }
 }
 
@@ -79,6 +89,11 @@ void Scene::setIBL(std::string texture, bool flip, int clientWidth, int clientHe
 	ibl = std::make_unique<IBL>(texture, flip, clientWidth, clientHeight);
 }
 
+std::unique_ptr<IBL> & Scene::getIBL()
+{
+	return ibl;
+}
+
 void Scene::addParticlesEmitter(glm::vec3 pos, int emitRate, float maxLifetime, ParticleEmitter::DIRECTION direction_type, float speed, glm::vec3 direction_vector)
 {
 	particlesEmitter.push_back(std::make_unique<ParticleEmitter>(pos, emitRate, maxLifetime, direction_type, speed, direction_vector));
@@ -94,6 +109,11 @@ void Scene::addVehicle(std::shared_ptr<Vehicle> vehicle)
 	vehicles.push_back(vehicle);
 }
 
+void Scene::addCrowd(std::shared_ptr<Crowd> crowd)
+{
+	crowds.push_back(crowd);
+}
+
 std::vector<std::unique_ptr<Lightning>> & Scene::getLightnings()
 {
 	return lightning;
@@ -189,6 +209,14 @@ void Scene::draw(Shader & shader, Graphics& graphics, DRAW_TYPE drawType, float
     {
 	    for(int i{0}; i < objects.size(); ++i)
 	    {
+		    if(isOccluded(i))
+			    continue;
+		    if(isImpostor(i))
+		    {
+			    for(auto & mesh : objects[i]->getMeshes())
+				    drawSplit(i, *mesh, shader, (ibl) ? &iblData : nullptr, mode);
+			    continue;
+		    }
 		    if(ibl)
 			    objects[i]->draw(shader, &iblData, mode);
 		    else
@@ -199,34 +227,31 @@ void Scene::draw(Shader & shader, Graphics& graphics, DRAW_TYPE drawType, float
     else if(drawType == DRAW_TYPE::DRAW_OPAQUE)
     {
         shader.use();
-        shader.setInt("animated", 0);
-        for(auto mesh : opaqueMesh)
-        {
-			std::shared_ptr<Object>& obj = objects[mesh.second];
-            shader.setMatrix("model", obj->getModel());
-            if(shader.getType() == SHADER_TYPE::SHADOWS && mesh.first->getMaterial().color_emissive != glm::vec3(0.0f))
-            {
-                continue;
-            }
-            mesh.first->draw(shader, &iblData, obj->getInstancing(), obj->getInstanceModel().size(), mode);
-        }
+        drawOpaqueBatched(shader, &iblData, mode);
     }
     else
     {
         shader.use();
-        shader.setInt("animated", 0);
         
-        Scene::sortCamPos = cam.getPosition();
-        qsort(transparentMesh.data(), transparentMesh.size(), sizeof(std::pair<std::shared_ptr<Mesh>, std::shared_ptr<Object>>), sortTransparentMesh);
-        for(auto mesh : transparentMesh)
+        // order independent materials are blended later, unsorted, when OIT is on
+        bool oit = graphics.oitOn();
+        sortTransparentMeshes(cam, oit);
+        for(const TransparentDraw & draw : transparentMesh)
         {
-			std::shared_ptr<Object>& obj = objects[mesh.second];
-            shader.setMatrix("model", obj->getModel());
-            if(shader.getType() == SHADER_TYPE::SHADOWS && mesh.first->getMaterial().color_emissive != glm::vec3(0.0f))
+            if((oit && draw.mesh->getMaterial().orderIndependent) || isOccluded(draw.object))
+                continue;
+			std::shared_ptr<Object>& obj = objects[draw.object];
+            shader.setDrawMatrix("model", obj->getModel());
+            if(shader.getType() == SHADER_TYPE::SHADOWS && draw.mesh->getMaterial().color_emissive != glm::vec3(0.0f))
+            {
+                continue;
+            }
+            if(isImpostor(draw.object))
             {
+                drawSplit(draw.object, *draw.mesh, shader, &iblData, mode);
                 continue;
             }
-            mesh.first->draw(shader, &iblData, obj->getInstancing(), obj->getInstanceModel().size(), mode);
+            draw.mesh->draw(shader, &iblData, obj->getInstancing(), obj->getInstanceModel().size(), mode);
         }
     }
 	
@@ -238,12 +263,21 @@ void Scene::draw(Shader & shader, Graphics& graphics, DRAW_TYPE drawType, float
 			character->draw(shader, nullptr, mode);
 	}
 
+	// crowds are opaque, one instanced draw per mesh
+	if(drawType != DRAW_TYPE::DRAW_TRANSPARENT)
+	{
+		for(auto & crowd : crowds)
+			crowd->draw(shader, (ibl) ? &iblData : nullptr, mode);
+		drawImpostors(shader, graphics);
+	}
+
 	for(int i{0}; i < particlesEmitter.size(); ++i)
 	{
-		particlesEmitter[i]->emit(cam.getPosition(), delta);
+		particlesEmitter[i]->emit(cam.getPosition(), delta, !graphics.oitOn());
 		if(debug)
 			particlesEmitter[i]->drawEmitter(cam.getViewMatrix(), cam.getProjectionMatrix());
-		particlesEmitter[i]->drawParticles(cam.getViewMatrix(), cam.getProjectionMatrix(), cam.getRight(), cam.getUp());
+		if(!graphics.oitOn())
+			particlesEmitter[i]->drawParticles(cam.getViewMatrix(), cam.getProjectionMatrix(), cam.getRight(), cam.getUp());
 	}
 
 	for(int i{0}; i < lightning.size(); ++i)
@@ -257,6 +291,256 @@ void Scene::draw(Shader & shader, Graphics& graphics, DRAW_TYPE drawType, float
 	}
 }
 
+void Scene::drawOrderIndependent(Shader & shader, DRAWING_MODE mode)
+{
+	Camera& cam = cameras[activeCamera];
+
+	struct IBL_DATA iblData;
+	shader.use();
+	if(shader.getType() == SHADER_TYPE::PBR)
+	{
+		shader.setInt("IBL", (ibl) ? 1 : 0);
+		if(ibl)
+			iblData = ibl->get_IBL_data();
+	}
+
+	// weighted blended transparency, any order
+	shader.setInt("oitPass", 1);
+	for(const TransparentDraw & draw : transparentMesh)
+	{
+		if(!draw.mesh->getMaterial().orderIndependent || isOccluded(draw.object))
+			continue;
+		std::shared_ptr<Object>& obj = objects[draw.object];
+		shader.setDrawMatrix("model", obj->getModel());
+		draw.mesh->draw(shader, &iblData, obj->getInstancing(), obj->getInstanceModel().size(), mode);
+	}
+	shader.setInt("oitPass", 0);
+
+	for(int i{0}; i < particlesEmitter.size(); ++i)
+		particlesEmitter[i]->drawParticles(cam.getViewMatrix(), cam.getProjectionMatrix(), cam.getRight(), cam.getUp(), true);
+}
+
+void Scene::cullOccluded()
+{
+	Camera& cam = cameras[activeCamera];
+	occlusion.clear(cam.getProjectionMatrix() * cam.getViewMatrix());
+	occluded.assign(objects.size(), 0);
+
+	// rasterize occluders
+	for(auto & obj : objects)
+	{
+		if(!obj->isOccluder())
+			continue;
+		if(obj->getInstancing())
+		{
+			for(auto & instance : obj->getInstanceModel())
+				occlusion.addOccluder(obj->getOccluderPositions(), obj->getOccluderIndices(), instance);
+		}
+		else
+			occlusion.addOccluder(obj->getOccluderPositions(), obj->getOccluderIndices(), obj->getModel());
+	}
+	if(occlusion.empty())
+		return;
+	occlusion.rasterize();
+
+	// test everything else against the depth pyramid
+	for(int i{0}; i < objects.size(); ++i)
+	{
+		if(!objects[i]->isOccluder())
+			occluded[i] = !occlusion.isVisible(objects[i]->getBoundingSphere());
+	}
+}
+
+bool Scene::isOccluded(int objectIndex)
+{
+	return objectIndex < occluded.size() && occluded[objectIndex];
+}
+
+void Scene::updateImpostors(Graphics & graphics)
+{
+	// once per frame : instances past their object's impostor distance move to its quads,
+	// those in the cross-fade band are drawn both ways with complementary dithering
+	glm::vec3 eye = cameras[activeCamera].getPosition();
+	impostorSplit.resize(objects.size());
+	for(auto & impostor : impostors)
+		impostor.second->clear();
+
+	for(int i{0}; i < objects.size(); ++i)
+	{
+		std::shared_ptr<Object> & obj = objects[i];
+		ImpostorSplit & split = impostorSplit[i];
+		split.active = false;
+		split.near.clear();
+		split.offset = -1;
+		float start = obj->getImpostorDistance();
+		if(start <= 0.0f)
+			continue;
+
+		// baked the first time the file is seen
+		std::shared_ptr<Impostor> & impostor = impostors[obj->getPath()];
+		if(!impostor)
+			impostor = std::make_shared<Impostor>(*obj, graphics.getGBufferShader());
+
+		std::vector<glm::mat4> transforms;
+		if(obj->getInstancing())
+			transforms = obj->getInstanceModel();
+		else
+			transforms.push_back(obj->getModel());
+
+		float end = start * (1.0f + IMPOSTOR_FADE_RANGE);
+		bool fading{false};
+		std::vector<std::pair<glm::mat4, float>> far;
+		for(auto & m : transforms)
+		{
+			float d = glm::distance(glm::vec3(m * glm::vec4(impostor->getCenter(), 1.0f)), eye);
+			if(d < end)
+				split.near.push_back(m);
+			if(d > start)
+				far.emplace_back(m, std::min((d - start) / (end - start), 1.0f));
+			fading = fading || (d > start && d < end);
+		}
+		split.active = split.near.size() < transforms.size();
+		if(split.active && !split.near.empty())
+		{
+			split.offset = RingBuffer::get().push(split.near.data(), split.near.size() * sizeof(glm::mat4), sizeof(glm::vec4));
+			if(split.offset < 0)
+			{
+				// ring buffer full this frame : whole geometry and no impostor for this object
+				split.active = false;
+				fading = false;
+				far.clear();
+			}
+		}
+		for(auto & f : far)
+			impostor->add(f.first, f.second);
+
+		for(auto & mesh : obj->getMeshes())
+		{
+			Material & material = mesh->getMaterial();
+			material.fadeCenter = impostor->getCenter();
+			material.fadeRange = glm::vec2(start, end);
+			if(fading && material.opaque == 1)
+				material.permutation |= MATERIAL_DITHER_FADE;
+			else
+				material.permutation &= ~MATERIAL_DITHER_FADE;
+		}
+	}
+}
+
+bool Scene::isImpostor(int objectIndex)
+{
+	return objectIndex < impostorSplit.size() && impostorSplit[objectIndex].active;
+}
+
+void Scene::drawSplit(int objectIndex, Mesh & mesh, Shader & shader, struct IBL_DATA * iblData, DRAWING_MODE mode)
+{
+	// geometry of the instances closer than the impostor distance only
+	ImpostorSplit & split = impostorSplit[objectIndex];
+	std::shared_ptr<Object> & obj = objects[objectIndex];
+	if(split.near.empty())
+		return;
+
+	mesh.setInstanceBuffer(RingBuffer::get().getId(), split.offset);
+	mesh.draw(shader, iblData, true, split.near.size(), mode);
+	mesh.setInstanceBuffer((obj->getInstancing()) ? obj->getInstanceVBO() : 0, 0);
+}
+
+void Scene::drawImpostors(Shader & shader, Graphics & graphics)
+{
+	// no impostors in shadow maps, casters keep their geometry
+	SHADER_TYPE type = shader.getType();
+	if(impostors.empty() || (type != SHADER_TYPE::BLINN_PHONG && type != SHADER_TYPE::PBR && type != SHADER_TYPE::TOON && type != SHADER_TYPE::GBUFFER))
+		return;
+
+	Camera & cam = cameras[activeCamera];
+	Shader & s = graphics.getImpostorShader(type == SHADER_TYPE::GBUFFER);
+	s.use();
+	s.setMatrix("view", cam.getViewMatrix());
+	s.setMatrix("proj", cam.getProjectionMatrix());
+	if(type != SHADER_TYPE::GBUFFER)
+	{
+		if(dLights.empty())
+		{
+			s.setVec3f("lightDirection", glm::vec3(0.0f, -1.0f, 0.0f));
+			s.setVec3f("lightColor", glm::vec3(0.0f));
+			s.setVec3f("ambient", glm::vec3(0.3f));
+		}
+		else
+		{
+			s.setVec3f("lightDirection", glm::normalize(dLights[0]->getDirection()));
+			s.setVec3f("lightColor", dLights[0]->getDiffuseStrength());
+			s.setVec3f("ambient", dLights[0]->getAmbientStrength());
+		}
+	}
+
+	for(auto & impostor : impostors)
+		impostor.second->draw(s);
+}
+
+ShadowCasters Scene::getShadowCasters(const std::function<bool(const BoundingSphere &)> & test)
+{
+	ShadowCasters all;
+	for(int i{0}; i < objects.size(); ++i)
+	{
+		if(objects[i]->isDynamic())
+			all.dynamicObjects.push_back(i);
+		else
+			all.staticObjects.push_back(i);
+	}
+	all.character = character && character->sceneID == ID;
+	for(int i{0}; i < crowds.size(); ++i)
+		all.crowds.push_back(i);
+	return getShadowCasters(all, test);
+}
+
+ShadowCasters Scene::getShadowCasters(const ShadowCasters & candidates, const std::function<bool(const BoundingSphere &)> & test)
+{
+	ShadowCasters casters;
+	casters.staticKey = 0;
+	for(int i : candidates.staticObjects)
+	{
+		if(test(objects[i]->getBoundingSphere()))
+		{
+			casters.staticObjects.push_back(i);
+			hashCombine(casters.staticKey, i);
+			hashCombine(casters.staticKey, objects[i]->getVersion());
+		}
+	}
+	for(int i : candidates.dynamicObjects)
+	{
+		if(test(objects[i]->getBoundingSphere()))
+			casters.dynamicObjects.push_back(i);
+	}
+	casters.character = candidates.character && test(character->get()->getBoundingSphere());
+	for(int i : candidates.crowds)
+	{
+		if(crowds[i]->getInstanceCount() > 0 && test(crowds[i]->getBoundingSphere()))
+			casters.crowds.push_back(i);
+	}
+	return casters;
+}
+
+void Scene::drawShadowCasters(Shader & shader, const ShadowCasters & casters, CASTER_TYPE type, DRAWING_MODE mode)
+{
+	if(type != CASTER_TYPE::DYNAMIC)
+	{
+		for(int i : casters.staticObjects)
+			objects[i]->draw(shader, nullptr, mode);
+	}
+
+	if(type != CASTER_TYPE::STATIC)
+	{
+		for(int i : casters.dynamicObjects)
+			objects[i]->draw(shader, nullptr, mode);
+
+		if(casters.character)
+			character->draw(shader, nullptr, mode);
+
+		for(int i : casters.crowds)
+			crowds[i]->draw(shader, nullptr, mode);
+	}
+}
+
 std::vector<std::shared_ptr<PointLight>> & Scene::getPLights()
 {
 	return pLights;
@@ -287,6 +571,11 @@ std::vector<std::shared_ptr<Vehicle>> & Scene::getVehicles()
 	return vehicles;
 }
 
+std::vector<std::shared_ptr<Crowd>> & Scene::getCrowds()
+{
+	return crowds;
+}
+
 void Scene::addAudioFile(std::string file)
 {
 	audio.load_sound(file);
@@ -312,16 +601,88 @@ Source& Scene::getSoundSource(int index)
 	return sound_source[index];
 }
 
-int Scene::sortTransparentMesh(const void * a, const void * b)
+void Scene::drawOpaqueBatched(Shader & shader, struct IBL_DATA * iblData, DRAWING_MODE mode)
 {
-    std::pair<std::shared_ptr<Mesh>, std::shared_ptr<Object>> meshA{*static_cast<const std::pair<std::shared_ptr<Mesh>, std::shared_ptr<Object>>*>(a)};
-    std::pair<std::shared_ptr<Mesh>, std::shared_ptr<Object>> meshB{*static_cast<const std::pair<std::shared_ptr<Mesh>, std::shared_ptr<Object>>*>(b)};
-    float distanceA = glm::length(meshA.first->getCenter() - Scene::sortCamPos);
-    float distanceB = glm::length(meshB.first->getCenter() - Scene::sortCamPos);
-    if(distanceA < distanceB)
-        return 1;
-    else if(distanceA > distanceB)
-        return -1;
-    else
-        return 0;
+	auto drawSingle = [&](const OpaqueDraw & draw) {
+		if(isImpostor(draw.object))
+		{
+			drawSplit(draw.object, *draw.mesh, shader, iblData, mode);
+			return;
+		}
+		std::shared_ptr<Object>& obj = objects[draw.object];
+		shader.setDrawMatrix("model", obj->getModel());
+		draw.mesh->draw(shader, iblData, obj->getInstancing(), obj->getInstanceModel().size(), mode);
+	};
+	auto isBatched = [&](const OpaqueDraw & draw) -> bool {
+		return draw.batch >= 0 && !isOccluded(draw.object) && !isImpostor(draw.object) && objects[draw.object]->isBatchable();
+	};
+
+	// gather the visible members of each batch
+	for(auto & models : batchModels)
+		models.clear();
+	batchFirst.assign(batchModels.size(), -1);
+	for(int i{0}; i < opaqueMesh.size(); ++i)
+	{
+		const OpaqueDraw & draw = opaqueMesh[i];
+		if(!isBatched(draw))
+			continue;
+		if(batchFirst[draw.batch] < 0)
+			batchFirst[draw.batch] = i;
+		batchModels[draw.batch].push_back(objects[draw.object]->getModel());
+	}
+
+	for(int i{0}; i < opaqueMesh.size(); ++i)
+	{
+		const OpaqueDraw & draw = opaqueMesh[i];
+		if(isOccluded(draw.object))
+			continue;
+		if(!isBatched(draw) || batchModels[draw.batch].size() < 2)
+		{
+			drawSingle(draw);
+			continue;
+		}
+
+		// the first member draws the whole batch, one instanced call
+		if(batchFirst[draw.batch] != i)
+			continue;
+		const std::vector<glm::mat4> & models = batchModels[draw.batch];
+		long offset = RingBuffer::get().push(models.data(), models.size() * sizeof(glm::mat4), sizeof(glm::vec4));
+		if(offset >= 0)
+		{
+			draw.mesh->setInstanceBuffer(RingBuffer::get().getId(), offset);
+			draw.mesh->draw(shader, iblData, true, batchModels[draw.batch].size(), mode);
+		}
+		else
+		{
+			// ring buffer full this frame
+			for(int j{i}; j < opaqueMesh.size(); ++j)
+			{
+				if(opaqueMesh[j].batch == draw.batch && isBatched(opaqueMesh[j]))
+					drawSingle(opaqueMesh[j]);
+			}
+		}
+	}
+}
+
+void Scene::sortTransparentMeshes(Camera & cam, bool skipOrderIndependent)
+{
+	// key on the view space depth of the world space mesh center
+	glm::mat4 view = cam.getViewMatrix();
+	float near = cam.getNearPlane();
+	float far = cam.getFarPlane();
+	for(TransparentDraw & draw : transparentMesh)
+	{
+		if(skipOrderIndependent && draw.mesh->getMaterial().orderIndependent)
+		{
+			draw.key = 0;
+			continue;
+		}
+		glm::vec4 center = view * objects[draw.object]->getModel() * glm::vec4(draw.mesh->getCenter(), 1.0f);
+		float depth = glm::clamp((-center.z - near) / (far - near), 0.0f, 1.0f);
+		draw.key = static_cast<std::uint16_t>((1.0f - depth) * 65535.0f);
+	}
+
+	radixSort16(transparentMesh, transparentScratch, [](const TransparentDraw & draw) {
+		return draw.key;
+	});
 }
@@ -2,8 +2,13 @@
 #include "stb_image.h"
 
 Shader::Shader(const std::string & vertex_shader_file, const std::string & fragment_shader_file, SHADER_TYPE t) :
-	type(t)
+	type(t),
+	variants(std::make_shared<Variants>()),
+	drawStamp(0)
 {
+	variants->vertex = vertex_shader_file;
+	variants->fragment = fragment_shader_file;
+
 	int vShader_codeLength;
 	int fShader_codeLength;
 
@@ -49,7 +54,8 @@ Shader::Shader(const std::string & vertex_shader_file, const std::string & fragm
 }
 
 Shader::Shader(const std::string & vertex_shader_file, const std::string & geometry_shader_file, const std::string & fragment_shader_file, SHADER_TYPE t) :
-	type(t)
+	type(t),
+	drawStamp(0)
 {
 	int vShader_codeLength;
 	int gShader_codeLength;
@@ -110,7 +116,8 @@ Shader::Shader(const std::string & vertex_shader_file, const std::string & geome
 }
 
 Shader::Shader(const std::string & compute_shader_file, SHADER_TYPE t) :
-	type(t)
+	type(t),
+	drawStamp(0)
 {
 	int cShader_codeLength;
 	char* cShaderCode;
@@ -137,6 +144,78 @@ Shader::Shader(const std::string & compute_shader_file, SHADER_TYPE t) :
 	c_shader_stream.close();
 }
 
+Shader::Shader(const std::string & vertex_shader_file, const std::string & fragment_shader_file, const std::vector<std::string> & defines, SHADER_TYPE t) :
+	type(t),
+	drawStamp(0)
+{
+	// variant of the same sources, one #define per enabled feature
+	std::ifstream v_shader_stream(vertex_shader_file, std::ifstream::binary);
+	std::ifstream f_shader_stream(fragment_shader_file, std::ifstream::binary);
+
+	if(!v_shader_stream)
+		std::cerr << "Error while trying to read the vertex shader file !" << std::endl;
+	if(!f_shader_stream)
+		std::cerr << "Error while trying to read the fragment shader file !" << std::endl;
+
+	std::string vShaderCode{std::istreambuf_iterator<char>(v_shader_stream), std::istreambuf_iterator<char>()};
+	std::string fShaderCode{std::istreambuf_iterator<char>(f_shader_stream), std::istreambuf_iterator<char>()};
+	vShaderCode = addDefines(vShaderCode, defines);
+	fShaderCode = addDefines(fShaderCode, defines);
+
+	compile(vShaderCode.c_str(), fShaderCode.c_str());
+}
+
+std::string Shader::addDefines(const std::string & code, const std::vector<std::string> & defines)
+{
+	// #version has to stay the first statement
+	std::string header;
+	for(const std::string & define : defines)
+		header += "#define " + define + "\n";
+	std::size_t line{0};
+	std::size_t version = code.find("#version");
+	if(version != std::string::npos)
+	{
+		std::size_t end = code.find('\n', version);
+		line = (end == std::string::npos) ? code.size() : end + 1;
+	}
+	return code.substr(0, line) + header + code.substr(line);
+}
+
+std::string Shader::addIncludes(const std::string & code)
+{
+	// #include "file" pulls a snippet from shaders/include, one level deep
+	std::string result;
+	std::istringstream stream(code);
+	std::string line;
+	while(std::getline(stream, line))
+	{
+		std::size_t directive = line.find("#include");
+		if(directive != std::string::npos && line.find_first_not_of(" \t") == directive)
+		{
+			std::size_t first = line.find('"', directive);
+			std::size_t last = line.find('"', first + 1);
+			if(first != std::string::npos && last != std::string::npos)
+			{
+				std::string file = "shaders/include/" + line.substr(first + 1, last - first - 1);
+				std::ifstream snippet(file, std::ifstream::binary);
+				if(!snippet)
+					std::cerr << "Error while trying to read the shader include " << file << " !" << std::endl;
+				result += std::string(std::istreambuf_iterator<char>(snippet), std::istreambuf_iterator<char>()) + "\n";
+				continue;
+			}
+		}
+		result += line + "\n";
+	}
+	return result;
+}
+
+void Shader::setSource(GLuint shader, const char * code)
+{
+	std::string source = addIncludes(code);
+	const char * text = source.c_str();
+	glShaderSource(shader, 1, &text, nullptr);
+}
+
 Shader::~Shader()
 {
 	glDeleteShader(id);
@@ -149,10 +228,10 @@ void Shader::compile(const char * vertex_shader_code, const char * fragment_shad
 	fragment_shader = glCreateShader(GL_FRAGMENT_SHADER);
 	shader_program = glCreateProgram();
 
-	glShaderSource(vertex_shader, 1, &vertex_shader_code, nullptr);	
+	setSource(vertex_shader, vertex_shader_code);	
 	glCompileShader(vertex_shader);
 	
-	glShaderSource(fragment_shader, 1, &fragment_shader_code, nullptr);	
+	setSource(fragment_shader, fragment_shader_code);	
 	glCompileShader(fragment_shader);
 
 	// Check for errors
@@ -213,13 +292,13 @@ void Shader::compile(const char * vertex_shader_code, const char * geometry_shad
 	fragment_shader = glCreateShader(GL_FRAGMENT_SHADER);
 	shader_program = glCreateProgram();
 
-	glShaderSource(vertex_shader, 1, &vertex_shader_code, nullptr);	
+	setSource(vertex_shader, vertex_shader_code);	
 	glCompileShader(vertex_shader);
 	
-	glShaderSource(geometry_shader, 1, &geometry_shader_code, nullptr);	
+	setSource(geometry_shader, geometry_shader_code);	
 	glCompileShader(geometry_shader);
 	
-	glShaderSource(fragment_shader, 1, &fragment_shader_code, nullptr);	
+	setSource(fragment_shader, fragment_shader_code);	
 	glCompileShader(fragment_shader);
 
 	// Check for errors
@@ -291,7 +370,7 @@ void Shader::compile(const char * compute_shader_code)
 	compute_shader = glCreateShader(GL_COMPUTE_SHADER);
 	shader_program = glCreateProgram();
 
-	glShaderSource(compute_shader, 1, &compute_shader_code, nullptr);	
+	setSource(compute_shader, compute_shader_code);	
 	glCompileShader(compute_shader);
 	
 	// Check for errors
@@ -335,38 +414,83 @@ SHADER_TYPE Shader::getType() { return type; }
 
 void Shader::setInt(const std::string & name, int v) const
 {
-	glUniform1i(glGetUniformLocation(id, name.c_str()), v);
+	forEachProgram(name, [&](GLuint program, GLint location){ glProgramUniform1i(program, location, v); });
 }
 
 void Shader::setFloat(const std::string & name, float v) const
 {
-	glUniform1f(glGetUniformLocation(id, name.c_str()), v);
+	forEachProgram(name, [&](GLuint program, GLint location){ glProgramUniform1f(program, location, v); });
 }
 
 void Shader::setBool(const std::string& name, bool v) const
 {
-	glUniform1i(glGetUniformLocation(id, name.c_str()), v);
+	forEachProgram(name, [&](GLuint program, GLint location){ glProgramUniform1i(program, location, v); });
 }
 
 
 void Shader::setVec2f(const std::string & name, glm::vec2 v) const
 {
-	glUniform2f(glGetUniformLocation(id, name.c_str()), v.x, v.y);
+	forEachProgram(name, [&](GLuint program, GLint location){ glProgramUniform2f(program, location, v.x, v.y); });
 }
 
 void Shader::setVec3f(const std::string & name, glm::vec3 v) const
 {
-	glUniform3f(glGetUniformLocation(id, name.c_str()), v.x, v.y, v.z);
+	forEachProgram(name, [&](GLuint program, GLint location){ glProgramUniform3f(program, location, v.x, v.y, v.z); });
+}
+
+void Shader::setVec3i(const std::string & name, glm::ivec3 v) const
+{
+	forEachProgram(name, [&](GLuint program, GLint location){ glProgramUniform3i(program, location, v.x, v.y, v.z); });
 }
 
 void Shader::setVec4f(const std::string & name, glm::vec4 v) const
 {
-	glUniform4f(glGetUniformLocation(id, name.c_str()), v.x, v.y, v.z, v.w);
+	forEachProgram(name, [&](GLuint program, GLint location){ glProgramUniform4f(program, location, v.x, v.y, v.z, v.w); });
 }
 
 void Shader::setMatrix(const std::string & name, glm::mat4 m) const
 {
-	glUniformMatrix4fv(glGetUniformLocation(id, name.c_str()), 1, GL_FALSE, glm::value_ptr(m));
+	forEachProgram(name, [&](GLuint program, GLint location){ glProgramUniformMatrix4fv(program, location, 1, GL_FALSE, glm::value_ptr(m)); });
+
+	// keeps a pending draw matrix of the same name from overwriting it later
+	if(variants)
+	{
+		for(auto & matrix : variants->drawMatrices)
+		{
+			if(matrix.first == name)
+				matrix.second = m;
+		}
+	}
+}
+
+void Shader::setDrawMatrix(const std::string & name, glm::mat4 m) const
+{
+	if(!variants)
+	{
+		setMatrix(name, m);
+		return;
+	}
+
+	variants->drawStamp++;
+	for(auto & matrix : variants->drawMatrices)
+	{
+		if(matrix.first == name)
+		{
+			matrix.second = m;
+			return;
+		}
+	}
+	variants->drawMatrices.emplace_back(name, m);
+}
+
+GLint Shader::getLocation(const std::string & name) const
+{
+	auto it = locations.find(name);
+	if(it != locations.end())
+		return it->second;
+	GLint location = glGetUniformLocation(id, name.c_str());
+	locations.emplace(name, location);
+	return location;
 }
 
 void Shader::setLighting(std::vector<std::shared_ptr<PointLight>> & pLights, std::vector<std::shared_ptr<DirectionalLight>> & dLights, std::vector<std::shared_ptr<SpotLight>> & sLights)
@@ -465,6 +589,147 @@ void Shader::use() const
 	glUseProgram(id);
 }
 
+Shader & Shader::getVariant(int permutation)
+{
+	// compiled the first time a material needs it, 0 included so that per draw
+	// uniforms set on the returned program never fan out to the other permutations
+	if(!variants)
+		return *this;
+
+	std::unique_ptr<Shader> & variant = variants->programs[permutation];
+	if(!variant)
+	{
+		const char * names[] = {"DIFFUSE_MAP", "SPECULAR_MAP", "NORMAL_MAP", "METALLIC_ROUGH_MAP", "EMISSION_MAP", "ALPHA_TEST", "SKINNED", "CROWD", "DITHER_FADE"};
+		std::vector<std::string> defines;
+		for(int bit{0}; bit < 9; ++bit)
+		{
+			if(permutation & (1 << bit))
+				defines.push_back(names[bit]);
+		}
+		variant = std::make_unique<Shader>(variants->vertex, variants->fragment, defines, type);
+		variant->variants.reset();
+
+		// uniforms set before this variant existed (lights, settings, samplers) are not set again every frame
+		copyUniforms(id, variant->id);
+	}
+
+	if(variant->drawStamp != variants->drawStamp)
+	{
+		for(auto & matrix : variants->drawMatrices)
+			glProgramUniformMatrix4fv(variant->id, variant->getLocation(matrix.first), 1, GL_FALSE, glm::value_ptr(matrix.second));
+		variant->drawStamp = variants->drawStamp;
+	}
+	return *variant;
+}
+
+void Shader::copyUniforms(GLuint from, GLuint to)
+{
+	GLint count{0};
+	glGetProgramiv(to, GL_ACTIVE_UNIFORMS, &count);
+	for(GLint u{0}; u < count; ++u)
+	{
+		GLchar buffer[256];
+		GLint size;
+		GLenum type;
+		glGetActiveUniform(to, u, sizeof(buffer), nullptr, &size, &type, buffer);
+
+		// arrays are reported once as "name[0]"
+		std::string name(buffer);
+		std::size_t bracket = name.rfind("[0]");
+		if(size > 1 && bracket != std::string::npos)
+			name = name.substr(0, bracket);
+
+		for(GLint e{0}; e < size; ++e)
+		{
+			std::string element = (size > 1) ? name + "[" + std::to_string(e) + "]" : name;
+			GLint src = glGetUniformLocation(from, element.c_str());
+			GLint dst = glGetUniformLocation(to, element.c_str());
+			if(src < 0 || dst < 0)
+				continue;
+
+			// values read through a buffer large enough for the widest type (mat4)
+			switch(type)
+			{
+				case GL_FLOAT:
+				case GL_FLOAT_VEC2:
+				case GL_FLOAT_VEC3:
+				case GL_FLOAT_VEC4:
+				case GL_FLOAT_MAT2:
+				case GL_FLOAT_MAT3:
+				case GL_FLOAT_MAT4:
+				{
+					GLfloat v[16];
+					glGetUniformfv(from, src, v);
+					if(type == GL_FLOAT)
+						glProgramUniform1fv(to, dst, 1, v);
+					else if(type == GL_FLOAT_VEC2)
+						glProgramUniform2fv(to, dst, 1, v);
+					else if(type == GL_FLOAT_VEC3)
+						glProgramUniform3fv(to, dst, 1, v);
+					else if(type == GL_FLOAT_VEC4)
+						glProgramUniform4fv(to, dst, 1, v);
+					else if(type == GL_FLOAT_MAT2)
+						glProgramUniformMatrix2fv(to, dst, 1, GL_FALSE, v);
+					else if(type == GL_FLOAT_MAT3)
+						glProgramUniformMatrix3fv(to, dst, 1, GL_FALSE, v);
+					else
+						glProgramUniformMatrix4fv(to, dst, 1, GL_FALSE, v);
+					break;
+				}
+				case GL_UNSIGNED_INT:
+				case GL_UNSIGNED_INT_VEC2:
+				case GL_UNSIGNED_INT_VEC3:
+				case GL_UNSIGNED_INT_VEC4:
+				{
+					GLuint v[4];
+					glGetUniformuiv(from, src, v);
+					if(type == GL_UNSIGNED_INT)
+						glProgramUniform1uiv(to, dst, 1, v);
+					else if(type == GL_UNSIGNED_INT_VEC2)
+						glProgramUniform2uiv(to, dst, 1, v);
+					else if(type == GL_UNSIGNED_INT_VEC3)
+						glProgramUniform3uiv(to, dst, 1, v);
+					else
+						glProgramUniform4uiv(to, dst, 1, v);
+					break;
+				}
+				case GL_INT_VEC2:
+				case GL_BOOL_VEC2:
+				{
+					GLint v[2];
+					glGetUniformiv(from, src, v);
+					glProgramUniform2iv(to, dst, 1, v);
+					break;
+				}
+				case GL_INT_VEC3:
+				case GL_BOOL_VEC3:
+				{
+					GLint v[3];
+					glGetUniformiv(from, src, v);
+					glProgramUniform3iv(to, dst, 1, v);
+					break;
+				}
+				case GL_INT_VEC4:
+				case GL_BOOL_VEC4:
+				{
+					GLint v[4];
+					glGetUniformiv(from, src, v);
+					glProgramUniform4iv(to, dst, 1, v);
+					break;
+				}
+				default:
+				{
+					// int, bool and samplers
+					GLint v;
+					glGetUniformiv(from, src, &v);
+					glProgramUniform1i(to, dst, v);
+					break;
+				}
+			}
+		}
+	}
+}
+
 void Shader::dispatch(int blocks_x, int blocks_y, int blocks_z, GLbitfield barriers)
 {
     glDispatchCompute(blocks_x, blocks_y, blocks_z);
@@ -769,6 +1034,15 @@ float PointLight::getKq()
 	return kq;
 }
 
+float PointLight::getRange()
+{
+	// distance at which the attenuated light drops under 5/256 of its brightest channel
+	float lightMax = glm::max(diffuseStrength.r, glm::max(diffuseStrength.g, diffuseStrength.b));
+	if(kq == 0.0f)
+		return (kl == 0.0f) ? std::numeric_limits<float>::max() : (256.0f / 5.0f * lightMax - kc) / kl;
+	return (-kl + std::sqrt(kl * kl - 4.0f * kq * (kc - (256.0f / 5.0f) * lightMax))) / (2.0f * kq);
+}
+
 DirectionalLight::DirectionalLight(SHADOW_QUALITY quality, glm::vec3 pos, glm::vec3 amb, glm::vec3 diff, glm::vec3 spec, glm::vec3 dir, float orthoDim) :
 	Light(quality, pos, amb, diff, spec),
 	orthoDimension(orthoDim),
@@ -957,6 +1231,13 @@ float SpotLight::getOuterCutOff()
 	return outerCutOff;
 }
 
+float SpotLight::getRange()
+{
+	// inverse square falloff, distance at which the light drops under 5/256 of its brightest channel
+	float lightMax = glm::max(diffuseStrength.r, glm::max(diffuseStrength.g, diffuseStrength.b));
+	return std::sqrt(256.0f / 5.0f * lightMax);
+}
+
 glm::vec3 Light::getPosition()
 {
 	return model * glm::vec4(position, 1.0f);
@@ -0,0 +1,152 @@
+#include "shadowAtlas.hpp"
+
+ShadowAtlas::ShadowAtlas(int atlasSize, int aMinSize) :
+	size(atlasSize),
+	minSize(aMinSize)
+{}
+
+bool ShadowAtlas::update(const std::vector<int> & sizes)
+{
+	if(sizes == requested)
+		return false;
+
+	bool sameLights = sizes.size() == requested.size() && regions.size() == sizes.size();
+	std::vector<int> previous(requested);
+	requested = sizes;
+	if(sameLights && reallocate(previous))
+		return true;
+
+	// halve the biggest maps until everything fits
+	std::vector<int> granted(sizes);
+	for(auto & s : granted)
+		s = std::min(s, size);
+	while(!pack(granted))
+	{
+		auto biggest = std::max_element(granted.begin(), granted.end());
+		if(*biggest <= minSize)
+		{
+			std::cerr << "Error: shadow atlas is full, some lights will not cast shadows !" << std::endl;
+			break;
+		}
+		*biggest /= 2;
+	}
+	return true;
+}
+
+bool ShadowAtlas::reallocate(const std::vector<int> & previous)
+{
+	// unchanged lights keep their region (and so their cached map), the others are freed first
+	std::vector<glm::ivec3> kept(regions);
+	for(int i{0}; i < static_cast<int>(requested.size()); ++i)
+	{
+		if(requested[i] != previous[i])
+			regions[i] = glm::ivec3(0);
+	}
+
+	for(int i{0}; i < static_cast<int>(requested.size()); ++i)
+	{
+		if(requested[i] == previous[i] || requested[i] <= 0)
+			continue;
+
+		// maps are powers of two, aligned positions are enough to find a hole
+		bool found{false};
+		for(int s = std::min(requested[i], size); !found && s >= minSize; s /= 2)
+		{
+			for(int y{0}; !found && y + s <= size; y += s)
+			{
+				for(int x{0}; !found && x + s <= size; x += s)
+				{
+					found = isFree(glm::ivec3(x, y, s), i);
+					if(found)
+						regions[i] = glm::ivec3(x, y, s);
+				}
+			}
+		}
+		if(!found)
+		{
+			regions = kept;
+			return false;
+		}
+	}
+	return true;
+}
+
+bool ShadowAtlas::isFree(glm::ivec3 region, int index)
+{
+	for(int i{0}; i < static_cast<int>(regions.size()); ++i)
+	{
+		const glm::ivec3 & r = regions[i];
+		if(i == index || r.z == 0)
+			continue;
+		if(region.x < r.x + r.z && r.x < region.x + region.z && region.y < r.y + r.z && r.y < region.y + region.z)
+			return false;
+	}
+	return true;
+}
+
+bool ShadowAtlas::pack(const std::vector<int> & sizes)
+{
+	struct Shelf
+	{
+		int y;
+		int height;
+		int x;
+	};
+
+	// biggest first, each map goes on the first shelf with enough room
+	std::vector<int> order(sizes.size());
+	std::iota(order.begin(), order.end(), 0);
+	std::stable_sort(order.begin(), order.end(), [&sizes](int a, int b) {
+		return sizes[a] > sizes[b];
+	});
+
+	bool fits{true};
+	std::vector<Shelf> shelves;
+	int top{0};
+	regions.assign(sizes.size(), glm::ivec3(0));
+	for(int i : order)
+	{
+		int s = sizes[i];
+		bool placed{false};
+		for(auto & shelf : shelves)
+		{
+			if(s <= shelf.height && shelf.x + s <= size)
+			{
+				regions[i] = glm::ivec3(shelf.x, shelf.y, s);
+				shelf.x += s;
+				placed = true;
+				break;
+			}
+		}
+		if(!placed && top + s <= size)
+		{
+			shelves.push_back({top, s, s});
+			regions[i] = glm::ivec3(0, top, s);
+			top += s;
+			placed = true;
+		}
+		fits = fits && placed;
+	}
+	return fits;
+}
+
+glm::ivec3 ShadowAtlas::getRegion(int index)
+{
+	return regions[index];
+}
+
+glm::vec4 ShadowAtlas::getUVRegion(int index)
+{
+	glm::vec3 r = glm::vec3(regions[index]) / static_cast<float>(size);
+	return glm::vec4(r.x, r.y, r.z, r.z);
+}
+
+int ShadowAtlas::getSize()
+{
+	return size;
+}
+
+int ShadowAtlas::getCount()
+{
+	return regions.size();
+}
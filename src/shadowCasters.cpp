@@ -0,0 +1,16 @@
+#include "shadowCasters.hpp"
+
+bool hasDynamicCasters(const ShadowCasters & casters)
+{
+	return !casters.dynamicObjects.empty() || casters.character || !casters.crowds.empty();
+}
+
+bool hasDynamicCasters(const std::vector<std::pair<glm::mat4, ShadowCasters>> & faces)
+{
+	for(auto & face : faces)
+	{
+		if(hasDynamicCasters(face.second))
+			return true;
+	}
+	return false;
+}
@@ -16,11 +16,10 @@ void Text::init()
         std::exit(-1);
     }
 
+    // glyph quads are streamed through the ring buffer
     glGenVertexArrays(1, &vao);
-    glGenBuffers(1, &vbo);
     glBindVertexArray(vao);
-    glBindBuffer(GL_ARRAY_BUFFER, vbo);
-    glBufferData(GL_ARRAY_BUFFER, 24 * sizeof(float), nullptr, GL_DYNAMIC_DRAW);
+    glBindBuffer(GL_ARRAY_BUFFER, RingBuffer::get().getId());
     glVertexAttribPointer(0, 4, GL_FLOAT, GL_FALSE, 4 * sizeof(float), 0);
     glEnableVertexAttribArray(0);
     glBindBuffer(GL_ARRAY_BUFFER, 0);
@@ -35,10 +34,6 @@ void Text::resize_screen(int width, int height)
 Text::~Text()
 {
     FT_Done_FreeType(ft);
-    glBindVertexArray(vao);
-    glBindBuffer(GL_ARRAY_BUFFER, 0);
-    glDeleteBuffers(1, &vbo);
-    glBindVertexArray(0);
     glDeleteVertexArrays(1, &vao);
 }
 
@@ -105,6 +100,17 @@ void Text::print(std::string txt, float x, float y, float scale, glm::vec3 color
     shader.setMatrix("proj", projection);
     glBindVertexArray(vao);
 
+    // quads of the whole string written at once, 6 vertices of 4 floats per glyph
+    const long stride{4 * sizeof(float)};
+    RingAllocation quads = RingBuffer::get().allocate(txt.size() * 6 * stride, stride);
+    if (!quads.data)
+    {
+        glBindVertexArray(0);
+        return;
+    }
+    float * out = static_cast<float*>(quads.data);
+    long first = quads.offset / stride;
+
     // iterate through all characters
     std::string::const_iterator c;
     for (c = txt.begin(); c != txt.end(); ++c)
@@ -116,7 +122,7 @@ void Text::print(std::string txt, float x, float y, float scale, glm::vec3 color
         float w = glyph.size.x * scale;
         float h = glyph.size.y * scale;
 
-        // update VBO
+        // write quad
         float vertices[24] = {
             xpos, ypos + h, 0.0f, 0.0f,
             xpos, ypos, 0.0f, 1.0f,
@@ -125,8 +131,8 @@ void Text::print(std::string txt, float x, float y, float scale, glm::vec3 color
             xpos + w, ypos, 1.0f, 1.0f,
             xpos + w, ypos + h, 1.0f, 0.0f
         };
-        glBindBuffer(GL_ARRAY_BUFFER, vbo);
-        glBufferSubData(GL_ARRAY_BUFFER, 0, sizeof(vertices), vertices);
+        std::copy(vertices, vertices + 24, out);
+        out += 24;
 
         // bind texture
         glActiveTexture(GL_TEXTURE0);
@@ -134,7 +140,8 @@ void Text::print(std::string txt, float x, float y, float scale, glm::vec3 color
         shader.setInt("text", 0);
 
         // render quad
-        glDrawArrays(GL_TRIANGLES, 0, 6);
+        glDrawArrays(GL_TRIANGLES, first, 6);
+        first += 6;
 
         // advance cursors for next glyph
         x += (glyph.advance >> 6) * scale;
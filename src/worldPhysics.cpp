@@ -250,6 +250,7 @@ void WorldPhysics::addRigidBody(std::shared_ptr<Object> object, glm::mat4 positi
 	dynamicsWorld->addRigidBody(body);
 	rigidBodies.push_back(body);
 	worldRigidBody.push_back(object);
+	object->setDynamic(mass != 0.0f);
 }
 
 void WorldPhysics::addSoftBody(std::shared_ptr<Object> object, btScalar mass)
@@ -322,6 +323,8 @@ void WorldPhysics::addSoftBody(std::shared_ptr<Object> object, btScalar mass)
 	// add soft body to dynamics world
 	dynamicsWorld->addSoftBody(softBody);
 	worldSoftBody.push_back(object);
+	object->setDynamic(true);
+	object->setBatchable(false); // own deformed geometry
 	
 	// recreate mesh
 	btSoftBody::tNodeArray nodes = softBody->m_nodes;
@@ -793,7 +796,20 @@ float WorldPhysics::getDistance(btVector3 from, btVector3 to)
 
 btDebugDraw::btDebugDraw() :
 	shader("shaders/axis/vertex.glsl", "shaders/axis/fragment.glsl")
-{}
+{
+	// lines and points are streamed through the ring buffer
+	glGenVertexArrays(1, &vao);
+	glBindVertexArray(vao);
+	glBindBuffer(GL_ARRAY_BUFFER, RingBuffer::get().getId());
+	glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 3 * sizeof(float), (void*)(0));
+	glEnableVertexAttribArray(0);
+	glBindVertexArray(0);
+}
+
+btDebugDraw::~btDebugDraw()
+{
+	glDeleteVertexArrays(1, &vao);
+}
 
 void btDebugDraw::drawLine(const btVector3 & from, const btVector3 & to, const btVector3 & color)
 {
@@ -807,35 +823,10 @@ void btDebugDraw::drawLine(const btVector3 & from, const btVector3 & to, const b
 		to.getZ()
 	};
 
-	GLuint vao;
-	GLuint vbo;
-	glGenVertexArrays(1, &vao);
-	glGenBuffers(1, &vbo);
-
-	glBindVertexArray(vao);
-	glBindBuffer(GL_ARRAY_BUFFER, vbo);
-
-	glBufferData(GL_ARRAY_BUFFER, 6 * sizeof(float), line, GL_STATIC_DRAW);
-	glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 3 * sizeof(float), (void*)(0));
-	glEnableVertexAttribArray(0);
-
-	// draw
 	glPolygonMode(GL_FRONT_AND_BACK, GL_LINE);
 	glLineWidth(3.0f);
-
-	shader.use();
-	shader.setVec3f("color", glm::vec3(color.getX(), color.getY(), color.getZ()));
-	shader.setMatrix("model", glm::mat4(1.0f));
-	shader.setMatrix("view", view);
-	shader.setMatrix("proj", projection);
-
-	glDrawArrays(GL_LINE_STRIP, 0, 2);
+	streamDraw(line, 2, GL_LINE_STRIP, color);
 	glPolygonMode(GL_FRONT_AND_BACK, GL_FILL);
-
-	// cleaning
-	glDeleteBuffers(1, &vbo);
-	glBindVertexArray(0);
-	glDeleteVertexArrays(1, &vao);
 }
 
 void btDebugDraw::drawContactPoint(const btVector3 & PointOnB, const btVector3 & normalOnB, btScalar distance, int lifeTime, const btVector3 & color)
@@ -851,57 +842,23 @@ void btDebugDraw::drawContactPoint(const btVector3 & PointOnB, const btVector3 &
 		PointOnB.getZ() + normalOnB.getZ()
 	};
 
-	GLuint vao;
-	GLuint vbo;
-	glGenVertexArrays(1, &vao);
-	glGenBuffers(1, &vbo);
-
-	glBindVertexArray(vao);
-	glBindBuffer(GL_ARRAY_BUFFER, vbo);
-
-	glBufferData(GL_ARRAY_BUFFER, 6 * sizeof(float), normal, GL_STATIC_DRAW);
-	glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 3 * sizeof(float), (void*)(0));
-	glEnableVertexAttribArray(0);
-
-	// draw
 	glPolygonMode(GL_FRONT_AND_BACK, GL_LINE);
 	glLineWidth(3.0f);
-
-	shader.use();
-	shader.setVec3f("color", glm::vec3(color.getX(), color.getY(), color.getZ()));
-	shader.setMatrix("model", glm::mat4(1.0f));
-	shader.setMatrix("view", view);
-	shader.setMatrix("proj", projection);
-
-	glDrawArrays(GL_LINE_STRIP, 0, 2);
-	glPolygonMode(GL_FRONT_AND_BACK, GL_FILL);
-
-	// cleaning
-	glDeleteBuffers(1, &vbo);
-	glBindVertexArray(0);
-	glDeleteVertexArrays(1, &vao);
+	streamDraw(normal, 2, GL_LINE_STRIP, color);
 
 	// Contact point
-	float point[3] =
-	{
-		PointOnB.getX(),
-		PointOnB.getY(),
-		PointOnB.getZ()
-	};
-
-	glGenVertexArrays(1, &vao);
-	glGenBuffers(1, &vbo);
-
-	glBindVertexArray(vao);
-	glBindBuffer(GL_ARRAY_BUFFER, vbo);
-
-	glBufferData(GL_ARRAY_BUFFER, 3 * sizeof(float), point, GL_STATIC_DRAW);
-	glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 3 * sizeof(float), (void*)(0));
-	glEnableVertexAttribArray(0);
-
-	// draw
 	glPolygonMode(GL_FRONT_AND_BACK, GL_POINT);
 	glPointSize(5.0f);
+	streamDraw(normal, 1, GL_POINTS, color);
+	glPolygonMode(GL_FRONT_AND_BACK, GL_FILL);
+}
+
+void btDebugDraw::streamDraw(const float * points, int count, GLenum primitive, const btVector3 & color)
+{
+	const long stride{3 * sizeof(float)};
+	long offset = RingBuffer::get().push(points, count * stride, stride);
+	if(offset < 0)
+		return;
 
 	shader.use();
 	shader.setVec3f("color", glm::vec3(color.getX(), color.getY(), color.getZ()));
@@ -909,13 +866,9 @@ void btDebugDraw::drawContactPoint(const btVector3 & PointOnB, const btVector3 &
 	shader.setMatrix("view", view);
 	shader.setMatrix("proj", projection);
 
-	glDrawArrays(GL_POINTS, 0, 1);
-	glPolygonMode(GL_FRONT_AND_BACK, GL_FILL);
-
-	// cleaning
-	glDeleteBuffers(1, &vbo);
+	glBindVertexArray(vao);
+	glDrawArrays(primitive, offset / stride, count);
 	glBindVertexArray(0);
-	glDeleteVertexArrays(1, &vao);
 }
 
 void btDebugDraw::reportErrorWarning(const char * warningString)
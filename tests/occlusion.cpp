@@ -0,0 +1,43 @@
+#include <iostream>
+#include <glm/gtc/matrix_transform.hpp>
+#include "occlusion.hpp"
+
+// camera at the origin looking down -z, a 2x2 quad occluder 5 units ahead
+static int check(bool condition, const char * what)
+{
+	if(!condition)
+		std::cerr << "Error: " << what << " !" << std::endl;
+	return (condition) ? 0 : 1;
+}
+
+int main()
+{
+	glm::mat4 projection = glm::perspective(glm::radians(60.0f), 2.0f, 0.1f, 100.0f);
+	glm::mat4 view = glm::lookAt(glm::vec3(0.0f), glm::vec3(0.0f, 0.0f, -1.0f), glm::vec3(0.0f, 1.0f, 0.0f));
+
+	std::vector<glm::vec3> positions{
+		glm::vec3(-1.0f, -1.0f, 0.0f),
+		glm::vec3(1.0f, -1.0f, 0.0f),
+		glm::vec3(1.0f, 1.0f, 0.0f),
+		glm::vec3(-1.0f, 1.0f, 0.0f)};
+	std::vector<int> indices{0, 1, 2, 0, 2, 3};
+	glm::mat4 model = glm::translate(glm::mat4(1.0f), glm::vec3(0.0f, 0.0f, -5.0f));
+
+	OcclusionBuffer occlusion;
+	int failures{0};
+
+	occlusion.clear(projection * view);
+	occlusion.rasterize();
+	failures += check(occlusion.isVisible({glm::vec3(0.0f, 0.0f, -20.0f), 1.0f}), "nothing is hidden without occluders");
+
+	occlusion.clear(projection * view);
+	occlusion.addOccluder(positions, indices, model);
+	occlusion.rasterize();
+	failures += check(!occlusion.empty(), "the quad should be kept");
+	failures += check(!occlusion.isVisible({glm::vec3(0.0f, 0.0f, -20.0f), 1.0f}), "a sphere behind the quad should be hidden");
+	failures += check(occlusion.isVisible({glm::vec3(0.0f, 0.0f, -2.0f), 0.5f}), "a sphere in front of the quad should be visible");
+	failures += check(occlusion.isVisible({glm::vec3(6.0f, 0.0f, -20.0f), 0.5f}), "a sphere beside the quad should be visible");
+	failures += check(occlusion.isVisible({glm::vec3(0.8f, 0.0f, -5.5f), 1.0f}), "a sphere crossing the quad edge should be visible");
+
+	return (failures == 0) ? 0 : 1;
+}
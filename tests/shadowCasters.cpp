@@ -0,0 +1,32 @@
+#include <iostream>
+#include "shadowCasters.hpp"
+
+// cachedShadowMap stores hasDynamicCasters(faces) in ShadowCache::dynamicDrawn
+// and only runs the dynamic pass on the faces where it holds
+static int check(bool condition, const char * what)
+{
+	if(!condition)
+		std::cerr << "Error: " << what << " !" << std::endl;
+	return (condition) ? 0 : 1;
+}
+
+int main()
+{
+	ShadowCasters none{{}, {}, false, {}, 0};
+	ShadowCasters staticOnly{{0, 1}, {}, false, {}, 0};
+	ShadowCasters crowdOnly{{0}, {}, false, {0}, 0};
+	ShadowCasters characterOnly{{}, {}, true, {}, 0};
+	int failures{0};
+
+	failures += check(!hasDynamicCasters(none), "an empty face has no dynamic casters");
+	failures += check(!hasDynamicCasters(staticOnly), "static objects are not dynamic casters");
+	failures += check(hasDynamicCasters(crowdOnly), "a crowd is a dynamic caster");
+	failures += check(hasDynamicCasters(characterOnly), "the character is a dynamic caster");
+
+	std::vector<std::pair<glm::mat4, ShadowCasters>> faces{{glm::mat4(1.0f), staticOnly}, {glm::mat4(1.0f), crowdOnly}};
+	failures += check(hasDynamicCasters(faces), "a crowd only face sets dynamicDrawn");
+	faces.pop_back();
+	failures += check(!hasDynamicCasters(faces), "static faces leave dynamicDrawn unset");
+
+	return (failures == 0) ? 0 : 1;
+}